@@ -0,0 +1,141 @@
+/*
+  Box Tone Zone (BTZ) - AdaaShaper.h
+*/
+#pragma once
+
+#include "SimdVec.h"
+#include <cmath>
+
+// Antiderivative anti-aliasing for the core's rational tanh approximation,
+//   f(x)  = x (27 + x^2) / (27 + 9 x^2)  =  x/9 + (8/3) x / (x^2 + 3)
+//   F1(x) = x^2/18 + (4/3) ln(x^2 + 3)
+//   F2(x) = x^3/54 + (4/3) [x ln(x^2 + 3) - 2x + 2 sqrt(3) atan(x / sqrt(3))]
+// Four independent lanes per instance (e.g. L/R of two bands). First order adds
+// half a sample of delay, second order one sample; alignDry() delays the dry side
+// of a blend by the same amount.
+struct AdaaTanh4 {
+    enum Order { off = 0, first = 1, second = 2 };
+
+    float prev1[4] = {}, prev2[4] = {};
+    float dryPrev[4] = {};
+    // Second order: F2(x[n-1]) and the first difference over (x[n-1], x[n-2]),
+    // so each sample evaluates F2 once. Only valid after a second-order call.
+    double prevF2[4] = {}, prevDiff[4] = {};
+    bool cached = false;
+
+    void reset() {
+        for (int i = 0; i < 4; ++i)
+            prev1[i] = prev2[i] = dryPrev[i] = 0.0f;
+        cached = false;
+    }
+
+    // Call once per sample whether or not the shaper runs, so the path delay only
+    // depends on the order.
+    Vec4 alignDry(Vec4 dry, int order) {
+        const Vec4 dry1 = Vec4::load(dryPrev);
+        dry.store(dryPrev);
+        if (order == first)
+            return (dry + dry1) * Vec4::broadcast(0.5f);
+        return order == second ? dry1 : dry;
+    }
+
+    static Vec4 shape(Vec4 x) {
+        const Vec4 x2 = x * x;
+        return x * (Vec4::broadcast(27.0f) + x2) / (Vec4::broadcast(27.0f) + Vec4::broadcast(9.0f) * x2);
+    }
+
+    // Keeps the history current while a stage is bypassed, so re-enabling it is seamless.
+    void skip(Vec4 x) {
+        float in[4];
+        x.store(in);
+        push(in);
+    }
+
+    Vec4 process(Vec4 x, int order) {
+        float in[4];
+        x.store(in);
+
+        Vec4 y;
+        if (order == first) {
+            // (F1(x) - F1(x0)) / (x - x0) rewritten without the difference quotient:
+            //   s/18 + (4/3) q log1p(z)/z,  s = x + x0, q = s / (x0^2 + 3), z = (x - x0) q
+            // which stays well conditioned as x -> x0 (log1p(z)/z -> 1).
+            const Vec4 x0 = Vec4::load(prev1);
+            const Vec4 s = x + x0;
+            const Vec4 q = s / (x0 * x0 + Vec4::broadcast(3.0f));
+            float z[4], ratio[4];
+            ((x - x0) * q).store(z);
+            for (int i = 0; i < 4; ++i)
+                ratio[i] = std::abs(z[i]) < 1.0e-4f ? 1.0f - z[i] * (0.5f - z[i] * (1.0f / 3.0f))
+                                                     : std::log1p(z[i]) / z[i];
+            y = s * Vec4::broadcast(1.0f / 18.0f) + Vec4::broadcast(4.0f / 3.0f) * q * Vec4::load(ratio);
+        } else if (order == second) {
+            if (! cached)
+                fillCache();
+            float out[4];
+            for (int i = 0; i < 4; ++i)
+                out[i] = (float) secondOrder(i, in[i]);
+            y = Vec4::load(out);
+        } else {
+            y = shape(x);
+        }
+
+        push(in);
+        cached = order == second;
+        return y;
+    }
+
+private:
+    void push(const float* in) {
+        cached = false;
+        for (int i = 0; i < 4; ++i) {
+            prev2[i] = prev1[i];
+            prev1[i] = in[i];
+        }
+    }
+
+    static double f(double x) { return x * (27.0 + x * x) / (27.0 + 9.0 * x * x); }
+    static double F1(double x) { return x * x / 18.0 + (4.0 / 3.0) * std::log(x * x + 3.0); }
+    static double F2(double x) {
+        constexpr double sqrt3 = 1.7320508075688772;
+        return x * x * x / 54.0
+             + (4.0 / 3.0) * (x * std::log(x * x + 3.0) - 2.0 * x + 2.0 * sqrt3 * std::atan(x / sqrt3));
+    }
+
+    // (F2(a) - F2(b)) / (a - b) from precomputed F2 values, falling back to F1 at
+    // the midpoint when a ~ b.
+    static double firstDifference(double a, double b, double F2a, double F2b) {
+        const double d = a - b;
+        return std::abs(d) < 1.0e-5 ? F1(0.5 * (a + b)) : (F2a - F2b) / d;
+    }
+
+    // After skip() or a lower order the cache is rebuilt from the history once.
+    void fillCache() {
+        for (int i = 0; i < 4; ++i) {
+            prevF2[i] = F2(prev1[i]);
+            prevDiff[i] = firstDifference(prev1[i], prev2[i], prevF2[i], F2(prev2[i]));
+        }
+    }
+
+    double secondOrder(int lane, double x0) {
+        constexpr double eps = 1.0e-5;
+        const double x1 = prev1[lane], x2 = prev2[lane];
+        const double F2x0 = F2(x0);
+        const double diff = firstDifference(x0, x1, F2x0, prevF2[lane]);
+        const double previousDiff = prevDiff[lane];
+        const double F2x1 = prevF2[lane];
+        prevF2[lane] = F2x0;
+        prevDiff[lane] = diff;
+
+        const double d = x0 - x2;
+        if (std::abs(d) >= eps)
+            return 2.0 / d * (diff - previousDiff);
+
+        // x[n] ~ x[n-2]: expand around their mean.
+        const double mean = 0.5 * (x0 + x2);
+        const double delta = mean - x1;
+        if (std::abs(delta) < eps)
+            return f(0.5 * (mean + x1));
+        return 2.0 / delta * (F1(mean) + (F2x1 - F2(mean)) / delta);
+    }
+};
@@ -0,0 +1,193 @@
+/*
+  Box Tone Zone (BTZ) - AnalysisWorker.cpp
+*/
+#include "AnalysisWorker.h"
+
+namespace {
+// One Hann window per size, shared by every instance.
+template <int size>
+const float* hannWindow() {
+    static const std::vector<float> table = [] {
+        std::vector<float> t((size_t) size);
+        juce::dsp::WindowingFunction<float>::fillWindowingTables(t.data(), (size_t) size,
+                                                                juce::dsp::WindowingFunction<float>::hann, false);
+        return t;
+    }();
+    return table.data();
+}
+}
+
+AdaptiveBias AdaptiveBias::fromFeatures(const AnalysisFeatures& f, float amount) {
+    AdaptiveBias bias;
+    if (! f.valid || amount <= 0.0f)
+        return bias;
+
+    // Squashed material (low crest) gets more punch, already-spiky material less.
+    bias.punch = juce::jlimit(-1.0f, 1.0f, (12.0f - f.crestDb) / 8.0f) * 0.15f * amount;
+
+    // Fill in thin low end, back off when the lows already dominate or the source is dark.
+    const float lowNeed = juce::jlimit(-1.0f, 1.0f, (0.35f - f.lowEnergy) / 0.35f);
+    const float darkness = juce::jlimit(0.0f, 1.0f, (800.0f - f.centroidHz) / 600.0f);
+    bias.boom = juce::jlimit(-0.12f, 0.12f, (lowNeed * 0.12f - darkness * 0.04f)) * amount;
+
+    // Busy patterns glue harder, sparse hits stay open.
+    bias.glue = juce::jlimit(-1.0f, 1.0f, (f.onsetRate - 4.0f) / 4.0f) * 0.10f * amount;
+    return bias;
+}
+
+AnalysisWorker::AnalysisWorker() : juce::Thread("BTZ Analysis") {}
+
+AnalysisWorker::~AnalysisWorker() {
+    release();
+}
+
+void AnalysisWorker::prepare(double sampleRate) {
+    release();
+
+    // Instances that are never prepared (plugin scans, state-only loads) skip all of this.
+    if (fft == nullptr) {
+        fft = std::make_unique<juce::dsp::FFT>(10);
+        fifoData.assign((size_t) fifoSize, 0.0f);
+        frame.assign((size_t) frameSize, 0.0f);
+        fftData.assign((size_t) (2 * frameSize), 0.0f);
+        prevMagnitude.assign((size_t) (frameSize / 2 + 1), 0.0f);
+        window = hannWindow<frameSize>();
+    }
+
+    decimation = juce::jmax(1, juce::roundToInt(sampleRate / 12000.0));
+    analysisRate = sampleRate / decimation;
+    decimCount = 0;
+    decimSum = 0.0f;
+    scratchCount = 0;
+    fifo.reset();
+
+    frameFill = 0;
+    fluxMean = 0.0f;
+    onsetAccumulator = 0.0f;
+    hopsSinceOnset = 0;
+    std::fill(prevMagnitude.begin(), prevMagnitude.end(), 0.0f);
+    smoothed = {};
+
+    startThread(juce::Thread::Priority::low);
+}
+
+void AnalysisWorker::release() {
+    stopThread(1000);
+}
+
+void AnalysisWorker::push(const float* left, const float* right, int numSamples) noexcept {
+    const float norm = 0.5f / (float) decimation;
+    for (int i = 0; i < numSamples; ++i) {
+        decimSum += left[i] + right[i];
+        if (++decimCount == decimation) {
+            scratch[scratchCount++] = decimSum * norm;
+            decimSum = 0.0f;
+            decimCount = 0;
+            if (scratchCount == scratchSize)
+                flushScratch();
+        }
+    }
+    flushScratch();
+}
+
+void AnalysisWorker::flushScratch() noexcept {
+    if (scratchCount == 0)
+        return;
+
+    // If the worker is behind, drop this chunk rather than wait for space.
+    if (fifo.getFreeSpace() >= scratchCount) {
+        int start1, size1, start2, size2;
+        fifo.prepareToWrite(scratchCount, start1, size1, start2, size2);
+        std::copy(scratch, scratch + size1, fifoData.data() + start1);
+        std::copy(scratch + size1, scratch + size1 + size2, fifoData.data() + start2);
+        fifo.finishedWrite(size1 + size2);
+    }
+    scratchCount = 0;
+}
+
+void AnalysisWorker::run() {
+    while (! threadShouldExit()) {
+        int ready = fifo.getNumReady();
+        while (ready > 0 && ! threadShouldExit()) {
+            const int take = juce::jmin(ready, frameSize - frameFill);
+            int start1, size1, start2, size2;
+            fifo.prepareToRead(take, start1, size1, start2, size2);
+            std::copy(fifoData.data() + start1, fifoData.data() + start1 + size1, frame.data() + frameFill);
+            std::copy(fifoData.data() + start2, fifoData.data() + start2 + size2, frame.data() + frameFill + size1);
+            fifo.finishedRead(size1 + size2);
+            frameFill += size1 + size2;
+            ready -= size1 + size2;
+
+            if (frameFill == frameSize) {
+                analyseFrame();
+                std::copy(frame.begin() + hopSize, frame.end(), frame.begin());
+                frameFill = frameSize - hopSize;
+            }
+        }
+        wait(10);
+    }
+}
+
+void AnalysisWorker::analyseFrame() {
+    float peak = 0.0f;
+    double sumSq = 0.0;
+    for (float x : frame) {
+        peak = juce::jmax(peak, std::abs(x));
+        sumSq += (double) x * x;
+    }
+    const float rms = (float) std::sqrt(sumSq / frameSize);
+    const float hopSeconds = (float) (hopSize / analysisRate);
+
+    // Hold the last features through silence so the bias doesn't swing on tails.
+    if (rms < 1.0e-3f) {
+        std::fill(prevMagnitude.begin(), prevMagnitude.end(), 0.0f);
+        onsetAccumulator *= std::exp(-hopSeconds / 2.0f);
+        return;
+    }
+
+    for (int i = 0; i < frameSize; ++i)
+        fftData[(size_t) i] = frame[(size_t) i] * window[(size_t) i];
+    std::fill(fftData.begin() + frameSize, fftData.end(), 0.0f);
+    fft->performFrequencyOnlyForwardTransform(fftData.data(), true);
+
+    const int numBins = frameSize / 2 + 1;
+    const float binHz = (float) (analysisRate / frameSize);
+    const int lowBins = juce::jmax(1, (int) (150.0f / binHz));
+    double magSum = 0.0, weighted = 0.0, energy = 0.0, lowEnergy = 0.0, flux = 0.0;
+    for (int b = 1; b < numBins; ++b) {
+        const float mag = fftData[(size_t) b];
+        magSum += mag;
+        weighted += (double) mag * b * binHz;
+        energy += (double) mag * mag;
+        if (b <= lowBins)
+            lowEnergy += (double) mag * mag;
+        flux += juce::jmax(0.0f, mag - prevMagnitude[(size_t) b]);
+        prevMagnitude[(size_t) b] = mag;
+    }
+
+    const float normFlux = (float) (flux / (magSum + 1.0e-9));
+    const bool onset = normFlux > fluxMean * 1.5f + 0.05f && hopsSinceOnset * hopSeconds > 0.05f;
+    fluxMean += 0.1f * (normFlux - fluxMean);
+    hopsSinceOnset = onset ? 0 : hopsSinceOnset + 1;
+
+    // Exponential 2 s window: accumulator ~ rate * tau.
+    constexpr float rateWindowSeconds = 2.0f;
+    onsetAccumulator = onsetAccumulator * std::exp(-hopSeconds / rateWindowSeconds) + (onset ? 1.0f : 0.0f);
+
+    AnalysisFeatures f;
+    f.crestDb = juce::Decibels::gainToDecibels(peak / rms, 0.0f);
+    f.centroidHz = (float) (weighted / (magSum + 1.0e-9));
+    f.lowEnergy = (float) (lowEnergy / (energy + 1.0e-12));
+    f.onsetRate = onsetAccumulator / rateWindowSeconds;
+
+    // ~200 ms smoothing on the published values.
+    const float a = smoothed.valid ? 1.0f - std::exp(-hopSeconds / 0.2f) : 1.0f;
+    smoothed.crestDb += a * (f.crestDb - smoothed.crestDb);
+    smoothed.centroidHz += a * (f.centroidHz - smoothed.centroidHz);
+    smoothed.lowEnergy += a * (f.lowEnergy - smoothed.lowEnergy);
+    smoothed.onsetRate = f.onsetRate;
+    smoothed.valid = true;
+
+    results.getWriteSlot() = smoothed;
+    results.publish();
+}
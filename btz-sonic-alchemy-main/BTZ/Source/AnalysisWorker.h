@@ -0,0 +1,79 @@
+/*
+  Box Tone Zone (BTZ) - AnalysisWorker.h
+*/
+#pragma once
+
+#include "TripleBuffer.h"
+#include <JuceHeader.h>
+#include <memory>
+#include <vector>
+
+struct AnalysisFeatures {
+    float crestDb = 12.0f;       // peak / RMS over the analysis frame
+    float centroidHz = 1500.0f;  // magnitude-weighted spectral centroid
+    float lowEnergy = 0.35f;     // share of energy below 150 Hz, 0..1
+    float onsetRate = 4.0f;      // detected onsets per second (~2 s window)
+    bool valid = false;
+};
+
+// Offsets added to the macro targets, already scaled by the Adaptive amount.
+struct AdaptiveBias {
+    float punch = 0.0f, boom = 0.0f, glue = 0.0f;
+
+    static AdaptiveBias fromFeatures(const AnalysisFeatures& f, float amount);
+};
+
+// Program analysis off the audio thread. The audio thread only averages the
+// input down to ~12 kHz and copies it into a lock-free FIFO (dropping samples if
+// the worker falls behind); the worker polls the FIFO, analyses overlapping
+// frames and publishes smoothed features through a triple buffer.
+class AnalysisWorker : private juce::Thread {
+public:
+    AnalysisWorker();
+    ~AnalysisWorker() override;
+
+    // Message thread. (Re)starts the worker for the given host rate.
+    void prepare(double sampleRate);
+    void release();
+
+    // Audio thread: never blocks or allocates.
+    void push(const float* left, const float* right, int numSamples) noexcept;
+    const AnalysisFeatures& getFeatures() noexcept { return results.read(); }
+
+    size_t getMemoryBytes() const noexcept {
+        return (fifoData.size() + frame.size() + fftData.size() + prevMagnitude.size()) * sizeof(float);
+    }
+
+private:
+    static constexpr int frameSize = 1024;
+    static constexpr int hopSize = 512;
+    static constexpr int fifoSize = 16384;
+    static constexpr int scratchSize = 256;
+
+    void run() override;
+    void flushScratch() noexcept;
+    void analyseFrame();
+
+    juce::AbstractFifo fifo { fifoSize };
+    std::vector<float> fifoData;
+
+    // Audio-thread decimator state.
+    float scratch[scratchSize] {};
+    int scratchCount = 0;
+    int decimation = 4, decimCount = 0;
+    float decimSum = 0.0f;
+
+    // Worker state.
+    double analysisRate = 12000.0;
+    std::unique_ptr<juce::dsp::FFT> fft;   // built on first prepare()
+    std::vector<float> frame, fftData, prevMagnitude;
+    const float* window = nullptr;         // shared Hann table
+    int frameFill = 0;
+    float fluxMean = 0.0f, onsetAccumulator = 0.0f;
+    int hopsSinceOnset = 0;
+    AnalysisFeatures smoothed;
+
+    TripleBuffer<AnalysisFeatures> results;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AnalysisWorker)
+};
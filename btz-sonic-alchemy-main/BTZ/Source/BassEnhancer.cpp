@@ -0,0 +1,137 @@
+/*
+  Box Tone Zone (BTZ) - BassEnhancer.cpp
+*/
+#include "BassEnhancer.h"
+
+namespace {
+constexpr float shelfHz = 90.0f, detectHz = 150.0f;
+constexpr float minHz = 30.0f, maxHz = 160.0f;
+constexpr float subLevel = 0.6f;
+constexpr float maxBoostDb = 4.0f, maxCutDb = 3.0f;
+constexpr float kneeDb = -18.0f, slope = 0.5f;   // shelf dB lost per dB of band level above the knee
+constexpr float butterworthQ = 0.70710678f;
+
+// Phase lag in radians of one 2-pole low-pass section at hz.
+static double sectionLag(double hz) {
+    const double r = hz / (double) detectHz;
+    return std::atan2(r / (double) butterworthQ, 1.0 - r * r);
+}
+}
+
+void BassEnhancer::prepare(double sampleRate) {
+    rate = juce::jmax(1.0, sampleRate);
+    filters.setLane(0, shelfHz, rate, butterworthQ, SvfLanes::lowPass);
+    filters.setLane(1, shelfHz, rate, butterworthQ, SvfLanes::lowPass);
+    filters.setLane(2, detectHz, rate, butterworthQ, SvfLanes::lowPass);
+    filters.setLane(3, detectHz, rate, butterworthQ, SvfLanes::lowPass);
+
+    const auto coeff = [this](float ms) { return 1.0f - std::exp(-1.0f / ((float) rate * ms * 0.001f)); };
+    envAttack = coeff(2.0f);
+    envRelease = coeff(80.0f);
+    voicedCoeff = coeff(5.0f);
+    shelfCoeff = coeff(10.0f);
+    amountCoeff = coeff(20.0f);
+    reset();
+}
+
+void BassEnhancer::reset() {
+    filters.reset();
+    clock = 0;
+    decimCount = 0;
+    band2Prev = bandPrevDecimated = 0.0f;
+    armed = false;
+    lastCrossing = -1.0e9;
+    fundamentalHz = 60.0f;
+    subPhase = subIncrement = 0.0;
+    voiced = voicedTarget = 0.0f;
+    voicedCountdown = 0;
+    env = 0.0f;
+    shelfGain = shelfTarget = 1.0f;
+    amount = 0.0f;
+}
+
+void BassEnhancer::lockToCrossing(double crossingTime) noexcept {
+    const double twoPi = juce::MathConstants<double>::twoPi;
+    const double f0 = fundamentalHz;
+    const bool octaveDown = f0 * 0.5 >= minHz;
+    lockStep = octaveDown ? juce::MathConstants<double>::pi : twoPi;
+    subIncrement = twoPi * (octaveDown ? f0 * 0.5 : f0) / rate;
+
+    // The band crosses later than the input by the two sections' phase lag plus
+    // the sample lane 3 waits for lane 2.
+    const double lagSamples = 2.0 * sectionLag(f0) / (twoPi * f0) * rate + 1.0;
+    const double sinceTrueCrossing = (double) clock - (crossingTime - lagSamples);
+
+    // At the true crossing the sub sits on a multiple of lockStep (every other
+    // crossing for the octave-down sub); nudge it toward the nearest one.
+    const double wanted = subPhase - subIncrement * sinceTrueCrossing;
+    const double error = lockStep * std::round(wanted / lockStep) - wanted;
+    subPhase += voicedTarget > 0.0f ? 0.5 * error : error;
+    subPhase -= twoPi * std::floor(subPhase / twoPi);
+}
+
+void BassEnhancer::analyse(float band) noexcept {
+    const float hysteresis = 0.05f * env + 1.0e-5f;
+    if (band < -hysteresis)
+        armed = true;
+
+    if (armed && bandPrevDecimated < 0.0f && band >= 0.0f) {
+        armed = false;
+        const double crossing = (double) clock - decimation * (double) (band / (band - bandPrevDecimated));
+        const double period = crossing - lastCrossing;
+        lastCrossing = crossing;
+        if (period >= rate / maxHz && period <= rate / minHz) {
+            fundamentalHz = (float) (rate / period);
+            lockToCrossing(crossing);
+            voicedTarget = 1.0f;
+            voicedCountdown = (int) (2.5 * period);
+        }
+    }
+    bandPrevDecimated = band;
+
+    // Dynamic shelf: lift a quiet low end, trim a loud one.
+    const float envDb = juce::Decibels::gainToDecibels(env, -100.0f);
+    const float gainDb = amount * juce::jlimit(-maxCutDb, maxBoostDb, maxBoostDb - slope * juce::jmax(0.0f, envDb - kneeDb));
+    shelfTarget = juce::Decibels::decibelsToGain(gainDb);
+}
+
+void BassEnhancer::process(float* dataL, float* dataR, int numSamples, float targetAmount) noexcept {
+    if (targetAmount <= 0.0f && amount < 1.0e-4f) {
+        if (amount != 0.0f)
+            reset();
+        return;
+    }
+
+    const double twoPi = juce::MathConstants<double>::twoPi;
+    for (int n = 0; n < numSamples; ++n) {
+        amount += amountCoeff * (targetAmount - amount);
+
+        const float mono = 0.5f * (dataL[n] + dataR[n]);
+        alignas(16) float lanes[4];
+        filters.process(Vec4::set(dataL[n], dataR[n], mono, band2Prev)).store(lanes);
+        const float band = lanes[3];
+        band2Prev = lanes[2];
+
+        const float rectified = std::abs(band);
+        env += (rectified > env ? envAttack : envRelease) * (rectified - env);
+
+        ++clock;
+        if (++decimCount == decimation) {
+            decimCount = 0;
+            analyse(band);
+        }
+
+        if (voicedCountdown > 0 && --voicedCountdown == 0)
+            voicedTarget = 0.0f;
+        voiced += voicedCoeff * (voicedTarget - voiced);
+        shelfGain += shelfCoeff * (shelfTarget - shelfGain);
+
+        subPhase += subIncrement;
+        if (subPhase >= twoPi)
+            subPhase -= twoPi;
+        const float sub = (float) std::sin(subPhase) * env * voiced * subLevel * amount;
+
+        dataL[n] += (shelfGain - 1.0f) * lanes[0] + sub;
+        dataR[n] += (shelfGain - 1.0f) * lanes[1] + sub;
+    }
+}
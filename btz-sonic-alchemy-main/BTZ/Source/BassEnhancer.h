@@ -0,0 +1,56 @@
+/*
+  Box Tone Zone (BTZ) - BassEnhancer.h
+*/
+#pragma once
+
+#include "CrossoverBank.h"
+#include <JuceHeader.h>
+#include <cstdint>
+
+// Boom's sub stage, at host rate: a sub-harmonic synth plus a dynamic low shelf.
+//
+// One SVF tick per sample carries the shelf low-pass of L/R (90 Hz) in lanes 0-1
+// and a 4-pole 150 Hz low-pass of the mono sum in lanes 2-3 (lane 3 takes lane
+// 2's previous output). The pitch tracker reads that band only every 16th
+// sample: a zero-crossing detector with hysteresis times positive-going
+// crossings, interpolated to a fraction of a host sample, and accepts periods
+// between 30 and 160 Hz. The sine sub runs an octave below the detected
+// fundamental (at the fundamental once that would fall under 30 Hz) and is
+// pulled onto each crossing after correcting for the detector filter's phase
+// lag, so it stays locked to the kick rather than drifting against it. Its
+// level follows the band envelope. The shelf lifts the lows by up to 4 dB when
+// the band is quiet and backs off, down to a 3 dB cut, as the band energy rises.
+class BassEnhancer {
+public:
+    static constexpr int decimation = 16;
+
+    void prepare(double sampleRate);
+    void reset();
+
+    // amount 0..1 (the Boom macro) scales the sub level and the shelf range.
+    void process(float* dataL, float* dataR, int numSamples, float targetAmount) noexcept;
+
+    float getDetectedHz() const noexcept { return voicedTarget > 0.0f ? fundamentalHz : 0.0f; }
+
+private:
+    void analyse(float band) noexcept;
+    void lockToCrossing(double crossingTime) noexcept;
+
+    SvfLanes filters;
+    double rate = 48000.0;
+    int64_t clock = 0;
+    int decimCount = 0;
+
+    float band2Prev = 0.0f, bandPrevDecimated = 0.0f;
+    bool armed = false;
+    double lastCrossing = -1.0e9;
+
+    float fundamentalHz = 60.0f;
+    double subPhase = 0.0, subIncrement = 0.0, lockStep = juce::MathConstants<double>::twoPi;
+    float voiced = 0.0f, voicedTarget = 0.0f, voicedCoeff = 0.01f;
+    int voicedCountdown = 0;
+
+    float env = 0.0f, envAttack = 0.01f, envRelease = 0.001f;
+    float shelfGain = 1.0f, shelfTarget = 1.0f, shelfCoeff = 0.01f;
+    float amount = 0.0f, amountCoeff = 0.001f;
+};
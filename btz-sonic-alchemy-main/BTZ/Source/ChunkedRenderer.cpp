@@ -0,0 +1,229 @@
+/*
+  Box Tone Zone (BTZ) - ChunkedRenderer.cpp
+*/
+#include "ChunkedRenderer.h"
+#include <thread>
+
+namespace {
+static inline juce::int64 roundUpToBlock(juce::int64 n, int blockSize) {
+    return ((n + blockSize - 1) / blockSize) * blockSize;
+}
+
+// Feeds input[feedStart, feedEnd) block by block (silence past the end of the
+// file) and hands each processed block and its input position to sink.
+template <typename Sink>
+static void feedBlocks(juce::AudioProcessor& proc, const juce::AudioBuffer<float>& input,
+                       juce::int64 feedStart, juce::int64 feedEnd, int blockSize, Sink&& sink) {
+    const int numChannels = input.getNumChannels();
+    juce::AudioBuffer<float> block(numChannels, blockSize);
+    juce::MidiBuffer midi;
+
+    for (juce::int64 pos = feedStart; pos < feedEnd; pos += blockSize) {
+        block.clear();
+        const juce::int64 available = juce::jlimit<juce::int64>(0, blockSize, input.getNumSamples() - pos);
+        for (int ch = 0; ch < numChannels; ++ch)
+            if (available > 0)
+                block.copyFrom(ch, 0, input, ch, (int) pos, (int) available);
+
+        proc.processBlock(block, midi);
+        sink(block, pos);
+    }
+}
+
+// Copies the samples of a block starting at time blockTime that fall in [from, to)
+// to dest[ch][t - destStart].
+static void copySpan(const juce::AudioBuffer<float>& block, juce::int64 blockTime, juce::int64 from, juce::int64 to,
+                     float* const* dest, juce::int64 destStart) {
+    const juce::int64 begin = juce::jmax(from, blockTime);
+    const juce::int64 end = juce::jmin(to, blockTime + block.getNumSamples());
+    if (begin >= end)
+        return;
+    for (int ch = 0; ch < block.getNumChannels(); ++ch)
+        std::copy_n(block.getReadPointer(ch, (int) (begin - blockTime)), (size_t) (end - begin), dest[ch] + (begin - destStart));
+}
+}
+
+ChunkedRenderer::ChunkedRenderer(ProcessorFactory factoryToUse, Settings settingsToUse)
+    : factory(std::move(factoryToUse)), settings(settingsToUse) {
+    settings.blockSize = juce::jmax(16, settings.blockSize);
+    settings.maxRetries = juce::jmax(0, settings.maxRetries);
+}
+
+juce::String ChunkedRenderer::Report::toText() const {
+    auto dbfs = [](float gain) { return juce::String(juce::Decibels::gainToDecibels(gain, -200.0f), 1) + " dBFS"; };
+    juce::String text;
+    text << "chunks: " << juce::String(numChunks) << "\n";
+    text << "latency: " << juce::String(latencySamples) << " samples\n";
+    text << "wall time: " << juce::String(wallSeconds, 3) << " s\n";
+    if (serialReference)
+        text << "serial render: " << juce::String(serialSeconds, 3) << " s (speed-up "
+             << juce::String(serialSeconds / juce::jmax(1.0e-9, wallSeconds), 2) << "x)\n";
+    text << "seam reference: " << (serialReference ? "serial render" : "twice the pre-roll") << "\n";
+    for (size_t i = 0; i < seams.size(); ++i) {
+        const auto& seam = seams[i];
+        text << "seam " << juce::String((int) i + 1) << " @ " << juce::String(seam.position)
+             << ": max dev " << dbfs(seam.maxDeviation)
+             << ", pre-roll " << juce::String(seam.prerollSeconds, 2) << " s"
+             << ", attempts " << juce::String(seam.attempts) << "\n";
+    }
+    text << "max seam deviation: " << dbfs(maxSeamDeviation) << "\n";
+    if (serialReference)
+        text << "max file deviation: " << dbfs(maxFileDeviation) << "\n";
+    text << (withinTolerance ? "within" : "EXCEEDS") << " tolerance\n";
+    return text;
+}
+
+std::unique_ptr<juce::AudioProcessor> ChunkedRenderer::createPrepared(int numChannels, double sampleRate) const {
+    auto proc = factory();
+    proc->setNonRealtime(true);
+    proc->setPlayConfigDetails(numChannels, numChannels, sampleRate, settings.blockSize);
+    proc->prepareToPlay(sampleRate, settings.blockSize);
+    return proc;
+}
+
+void ChunkedRenderer::renderSpan(const juce::AudioBuffer<float>& input, juce::int64 start, juce::int64 end,
+                                 juce::int64 preroll, float* const* dest, juce::int64 destStart, double sampleRate) const {
+    auto proc = createPrepared(input.getNumChannels(), sampleRate);
+
+    // Block grid stays aligned to the file start (start and preroll are whole blocks)
+    // so per-block stages (auto gain, meters) see the same block boundaries as a
+    // serial render would.
+    const juce::int64 feedStart = start - preroll;
+    const juce::int64 feedEnd = feedStart + roundUpToBlock(end + latency - feedStart, settings.blockSize);
+
+    feedBlocks(*proc, input, feedStart, feedEnd, settings.blockSize, [&](const juce::AudioBuffer<float>& block, juce::int64 pos) {
+        copySpan(block, pos - latency, start, end, dest, destStart);
+    });
+
+    proc->releaseResources();
+}
+
+void ChunkedRenderer::renderChunk(Chunk& chunk, const juce::AudioBuffer<float>& input, float* const* output,
+                                  double sampleRate) const {
+    renderSpan(input, chunk.start, chunk.end, chunk.preroll, output, 0, sampleRate);
+}
+
+// A chunk whose pre-roll reaches back to the file start is exact and needs no check.
+void ChunkedRenderer::renderSeamCheck(Chunk& chunk, const juce::AudioBuffer<float>& input, double sampleRate) const {
+    if (chunk.preroll >= chunk.start)
+        return;
+    renderSpan(input, chunk.start, chunk.start + chunk.reference.getNumSamples(), juce::jmin(chunk.start, chunk.preroll * 2),
+               chunk.reference.getArrayOfWritePointers(), chunk.start, sampleRate);
+}
+
+ChunkedRenderer::Report ChunkedRenderer::render(const juce::AudioBuffer<float>& input, juce::AudioBuffer<float>& output,
+                                                double sampleRate) {
+    Report report;
+    report.serialReference = settings.serialReference;
+    const double startMs = juce::Time::getMillisecondCounterHiRes();
+    const int numChannels = input.getNumChannels();
+    const juce::int64 length = input.getNumSamples();
+    const int blockSize = settings.blockSize;
+
+    output.setSize(numChannels, (int) length, false, false, true);
+    output.clear();
+    if (length == 0 || numChannels == 0)
+        return report;
+
+    {
+        auto probe = createPrepared(numChannels, sampleRate);
+        latency = probe->getLatencySamples();
+        probe->releaseResources();
+    }
+
+    int numChunks = settings.numChunks > 0 ? settings.numChunks : (int) juce::jmax(1u, std::thread::hardware_concurrency());
+    const juce::int64 chunkLength = roundUpToBlock((length + numChunks - 1) / numChunks, blockSize);
+    numChunks = (int) ((length + chunkLength - 1) / chunkLength);
+
+    const juce::int64 preroll = roundUpToBlock((juce::int64) std::ceil(settings.prerollSeconds * sampleRate), blockSize);
+    const juce::int64 verifyLength = juce::jmax<juce::int64>(1, (juce::int64) std::ceil(settings.verifySeconds * sampleRate));
+
+    std::vector<Chunk> chunks((size_t) numChunks);
+    for (int i = 0; i < numChunks; ++i) {
+        auto& c = chunks[(size_t) i];
+        c.start = chunkLength * i;
+        c.end = juce::jmin(length, c.start + chunkLength);
+        c.preroll = juce::jmin(preroll, c.start);
+        if (! settings.serialReference) {
+            c.reference.setSize(numChannels, (int) juce::jmin(verifyLength, c.end - c.start));
+            c.reference.clear();
+        }
+    }
+
+    // Workers write disjoint spans through raw pointers; touching the shared buffer
+    // itself from several threads would race on its internal flags.
+    float* const* outputPointers = output.getArrayOfWritePointers();
+    {
+        std::vector<std::thread> workers;
+        workers.reserve(chunks.size() * 2);
+        for (auto& c : chunks) {
+            workers.emplace_back([this, &c, &input, outputPointers, sampleRate] {
+                renderChunk(c, input, outputPointers, sampleRate);
+            });
+            if (! settings.serialReference)
+                workers.emplace_back([this, &c, &input, sampleRate] { renderSeamCheck(c, input, sampleRate); });
+        }
+        for (auto& w : workers)
+            w.join();
+    }
+
+    // The serial render runs on its own, after the chunks, so its time is comparable.
+    juce::AudioBuffer<float> serial;
+    if (settings.serialReference) {
+        const double serialStartMs = juce::Time::getMillisecondCounterHiRes();
+        serial.setSize(numChannels, (int) length);
+        renderSpan(input, 0, length, 0, serial.getArrayOfWritePointers(), 0, sampleRate);
+        report.serialSeconds = (juce::Time::getMillisecondCounterHiRes() - serialStartMs) * 0.001;
+    }
+
+    // Verify seams in order; a chunk that misses the bound is re-rendered with a
+    // longer pre-roll (and, without the serial render, checked against twice that).
+    const float tolerance = juce::Decibels::decibelsToGain(settings.seamToleranceDb, -400.0f);
+    for (size_t i = 1; i < chunks.size(); ++i) {
+        auto& next = chunks[i];
+        SeamReport seam;
+        seam.position = next.start;
+
+        for (;;) {
+            const int compareLength = (int) juce::jmin(verifyLength, next.end - next.start);
+            float deviation = 0.0f;
+            for (int ch = 0; ch < numChannels && next.preroll < next.start; ++ch) {
+                const float* ref = settings.serialReference ? serial.getReadPointer(ch, (int) next.start)
+                                                            : next.reference.getReadPointer(ch);
+                const float* out = output.getReadPointer(ch, (int) next.start);
+                for (int n = 0; n < compareLength; ++n)
+                    deviation = juce::jmax(deviation, std::abs(ref[n] - out[n]));
+            }
+            seam.maxDeviation = deviation;
+            seam.prerollSeconds = (double) next.preroll / sampleRate;
+
+            if (deviation <= tolerance || seam.attempts > settings.maxRetries || next.preroll >= next.start)
+                break;
+
+            next.preroll = juce::jmin(next.start, next.preroll * 2 + blockSize);
+            renderChunk(next, input, outputPointers, sampleRate);
+            if (! settings.serialReference)
+                renderSeamCheck(next, input, sampleRate);
+            ++seam.attempts;
+        }
+
+        report.maxSeamDeviation = juce::jmax(report.maxSeamDeviation, seam.maxDeviation);
+        report.withinTolerance = report.withinTolerance && seam.maxDeviation <= tolerance;
+        report.seams.push_back(seam);
+    }
+
+    if (settings.serialReference) {
+        for (int ch = 0; ch < numChannels; ++ch) {
+            const float* ref = serial.getReadPointer(ch);
+            const float* out = output.getReadPointer(ch);
+            for (juce::int64 n = 0; n < length; ++n)
+                report.maxFileDeviation = juce::jmax(report.maxFileDeviation, std::abs(ref[n] - out[n]));
+        }
+        report.withinTolerance = report.withinTolerance && report.maxFileDeviation <= tolerance;
+    }
+
+    report.numChunks = numChunks;
+    report.latencySamples = latency;
+    report.wallSeconds = (juce::Time::getMillisecondCounterHiRes() - startMs) * 0.001 - report.serialSeconds;
+    return report;
+}
@@ -0,0 +1,80 @@
+/*
+  Box Tone Zone (BTZ) - ChunkedRenderer.h
+*/
+#pragma once
+
+#include <JuceHeader.h>
+#include <functional>
+#include <memory>
+#include <vector>
+
+// Renders one long file on several cores. The input is cut into block-aligned
+// chunks; each chunk gets its own processor instance and a pre-roll so the
+// stateful stages (envelopes, filters, oversamplers) converge before its first
+// output sample. Every seam is checked by rendering its first samples once more
+// with twice the pre-roll: the stages converge geometrically, so the difference
+// between the two bounds the error of the shorter one against a serial render
+// without paying for a serial pass. With serialReference the whole file is also
+// rendered serially after the chunks (timed, for the speed-up) and the seams and
+// the full output are checked against it instead.
+class ChunkedRenderer {
+public:
+    using ProcessorFactory = std::function<std::unique_ptr<juce::AudioProcessor>()>;
+
+    struct Settings {
+        int numChunks = 0;               // 0 = one per hardware thread
+        int blockSize = 512;
+        double prerollSeconds = 2.0;
+        double verifySeconds = 0.05;
+        float seamToleranceDb = -90.0f;  // max allowed seam deviation
+        int maxRetries = 3;              // pre-roll doubles on each retry of a seam
+        bool serialReference = false;    // true = check against a full serial render (a second pass)
+    };
+
+    struct SeamReport {
+        juce::int64 position = 0;
+        float maxDeviation = 0.0f;
+        double prerollSeconds = 0.0;
+        int attempts = 1;
+    };
+
+    struct Report {
+        int numChunks = 0;
+        int latencySamples = 0;
+        double wallSeconds = 0.0;        // chunked render, seam checks and retries
+        double serialSeconds = 0.0;      // the serial render (serialReference only)
+        float maxSeamDeviation = 0.0f;
+        float maxFileDeviation = 0.0f;   // whole output against the serial render (serialReference only)
+        bool withinTolerance = true;
+        bool serialReference = false;
+        std::vector<SeamReport> seams;
+
+        juce::String toText() const;
+    };
+
+    ChunkedRenderer(ProcessorFactory factoryToUse, Settings settingsToUse);
+
+    // input and output must have the same channel count; output is resized to match input.
+    Report render(const juce::AudioBuffer<float>& input, juce::AudioBuffer<float>& output, double sampleRate);
+
+private:
+    struct Chunk {
+        juce::int64 start = 0, end = 0;
+        juce::int64 preroll = 0;
+        juce::AudioBuffer<float> reference;    // the first samples again, with twice the pre-roll
+    };
+
+    std::unique_ptr<juce::AudioProcessor> createPrepared(int numChannels, double sampleRate) const;
+    // Renders input[start - preroll, end) and writes [start, end) through dest, one
+    // pointer per channel at time destStart (taken before any worker starts).
+    void renderSpan(const juce::AudioBuffer<float>& input, juce::int64 start, juce::int64 end, juce::int64 preroll,
+                    float* const* dest, juce::int64 destStart, double sampleRate) const;
+    void renderChunk(Chunk& chunk, const juce::AudioBuffer<float>& input, float* const* output, double sampleRate) const;
+    void renderSeamCheck(Chunk& chunk, const juce::AudioBuffer<float>& input, double sampleRate) const;
+
+    ProcessorFactory factory;
+    Settings settings;
+    int latency = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ChunkedRenderer)
+};
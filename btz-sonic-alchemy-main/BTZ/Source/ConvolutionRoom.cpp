@@ -0,0 +1,290 @@
+/*
+  Box Tone Zone (BTZ) - ConvolutionRoom.cpp
+*/
+#include "ConvolutionRoom.h"
+
+namespace {
+constexpr double maxIRSeconds = 3.0;
+constexpr double crossfadeSeconds = 0.03;
+
+static void normaliseIR(juce::AudioBuffer<float>& ir) {
+    double energy = 0.0;
+    for (int ch = 0; ch < ir.getNumChannels(); ++ch) {
+        const float* d = ir.getReadPointer(ch);
+        for (int i = 0; i < ir.getNumSamples(); ++i)
+            energy += (double) d[i] * d[i];
+    }
+    energy /= juce::jmax(1, ir.getNumChannels());
+    if (energy > 1.0e-12)
+        ir.applyGain((float) (0.5 / std::sqrt(energy)));
+}
+}
+
+std::shared_ptr<const ConvolutionKernel> RoomIRShared::getOrCreate(const juce::String& key,
+                                                                   const std::function<juce::AudioBuffer<float>()>& makeIR) {
+    {
+        const juce::ScopedLock sl(cacheLock);
+        auto it = cache.find(key);
+        if (it != cache.end())
+            if (auto kernel = it->second.lock())
+                return kernel;
+    }
+
+    auto kernel = ConvolutionKernel::create(makeIR());
+
+    const juce::ScopedLock sl(cacheLock);
+    for (auto it = cache.begin(); it != cache.end();)
+        it = it->second.expired() ? cache.erase(it) : std::next(it);
+    cache[key] = kernel;
+    return kernel;
+}
+
+ConvolutionRoom::Handoff::~Handoff() {
+    delete pending.exchange(nullptr);
+    delete retired.exchange(nullptr);
+}
+
+ConvolutionRoom::ConvolutionRoom() : handoff(std::make_shared<Handoff>()) {}
+
+ConvolutionRoom::~ConvolutionRoom() {
+    // Stale jobs drop their result; anything already published is freed with the handoff.
+    ++handoff->latestGeneration;
+}
+
+void ConvolutionRoom::prepare(double sampleRate, int maxBlockSize) {
+    const bool rateChanged = std::abs(sampleRate - preparedRate) > 1.0e-6;
+    preparedRate = sampleRate;
+
+    wetBuffer.setSize(2, juce::jmax(1, maxBlockSize), false, false, true);
+    incomingBuffer.setSize(2, juce::jmax(1, maxBlockSize), false, false, true);
+    fadeLength = juce::jmax(1, (int) (crossfadeSeconds * sampleRate));
+    fadePos = 0;
+
+    // Not playing here, so engines built for another rate can be dropped directly.
+    incoming.reset();
+    parked.reset();
+    if (rateChanged)
+        active.reset();
+    delete handoff->retired.exchange(nullptr);
+
+    if (active == nullptr)
+        requestLoad();
+    reset();
+}
+
+size_t ConvolutionRoom::getMemoryBytes() const noexcept {
+    size_t bytes = (size_t) (wetBuffer.getNumChannels() * wetBuffer.getNumSamples()
+                           + incomingBuffer.getNumChannels() * incomingBuffer.getNumSamples()) * sizeof(float);
+    for (auto* convolver : { active.get(), incoming.get(), parked.get() })
+        if (convolver != nullptr)
+            bytes += convolver->getMemoryBytes();
+    return bytes;
+}
+
+void ConvolutionRoom::reset() {
+    if (active != nullptr)
+        active->reset();
+    if (incoming != nullptr)
+        incoming->reset();
+    currentAmount = 0.0f;
+    idle = true;
+}
+
+void ConvolutionRoom::setImpulseResponse(const juce::File& file) {
+    {
+        const juce::ScopedLock sl(fileLock);
+        if (file.getFullPathName() == irFile.getFullPathName())
+            return;
+        irFile = file;
+    }
+    requestLoad();
+}
+
+juce::File ConvolutionRoom::getImpulseResponse() const {
+    const juce::ScopedLock sl(fileLock);
+    return irFile;
+}
+
+void ConvolutionRoom::requestLoad() {
+    if (preparedRate <= 0.0)
+        return;
+
+    auto h = handoff;
+    auto* sharedState = shared.get();
+    const int generation = ++h->latestGeneration;
+    const juce::File file = getImpulseResponse();
+    const double rate = preparedRate;
+
+    sharedState->loader.addJob([h, sharedState, generation, file, rate] {
+        delete h->retired.exchange(nullptr);
+        if (generation != h->latestGeneration.load())
+            return;
+
+        const juce::String source = file.getFullPathName().isEmpty() ? juce::String("builtin:small_room") : file.getFullPathName();
+        auto kernel = sharedState->getOrCreate(source + "@" + juce::String(rate, 1), [&file, rate] {
+            auto ir = file.existsAsFile() ? loadIR(file, rate) : juce::AudioBuffer<float>();
+            return ir.getNumSamples() > 0 ? ir : makeBuiltInRoom(rate);
+        });
+
+        if (kernel == nullptr || generation != h->latestGeneration.load())
+            return;
+
+        delete h->pending.exchange(new PartitionedConvolver(kernel));
+    });
+}
+
+juce::AudioBuffer<float> ConvolutionRoom::loadIR(const juce::File& file, double sampleRate) {
+    juce::AudioFormatManager formats;
+    formats.registerBasicFormats();
+    std::unique_ptr<juce::AudioFormatReader> reader(formats.createReaderFor(file));
+    if (reader == nullptr || reader->lengthInSamples <= 0 || reader->sampleRate <= 0.0)
+        return {};
+
+    const int channels = juce::jlimit(1, 2, (int) reader->numChannels);
+    const int sourceLength = (int) juce::jmin<juce::int64>(reader->lengthInSamples, (juce::int64) (reader->sampleRate * maxIRSeconds));
+    juce::AudioBuffer<float> source(channels, sourceLength);
+    reader->read(&source, 0, sourceLength, 0, true, channels > 1);
+
+    if (std::abs(reader->sampleRate - sampleRate) < 1.0e-3) {
+        normaliseIR(source);
+        return source;
+    }
+
+    // Windowed-sinc resample; the interpolator's fixed latency is skipped so the
+    // IR keeps its original onset.
+    const double ratio = reader->sampleRate / sampleRate;
+    const int latencyOut = (int) std::ceil(juce::WindowedSincInterpolator::getBaseLatency() / ratio);
+    const int outLength = (int) std::ceil(sourceLength / ratio);
+    const int padding = (int) std::ceil((latencyOut + 8) * ratio) + 256;
+
+    juce::AudioBuffer<float> padded(channels, sourceLength + padding);
+    padded.clear();
+    juce::AudioBuffer<float> resampled(channels, outLength + latencyOut);
+    juce::AudioBuffer<float> out(channels, outLength);
+    for (int ch = 0; ch < channels; ++ch) {
+        padded.copyFrom(ch, 0, source, ch, 0, sourceLength);
+        juce::WindowedSincInterpolator interpolator;
+        interpolator.process(ratio, padded.getReadPointer(ch), resampled.getWritePointer(ch), outLength + latencyOut);
+        out.copyFrom(ch, 0, resampled, ch, latencyOut, outLength);
+    }
+
+    normaliseIR(out);
+    return out;
+}
+
+// Deterministic stand-in for the planned small_room.wav: a few early reflections
+// followed by a damped, decorrelated diffuse tail (RT60 ~ 0.32 s).
+juce::AudioBuffer<float> ConvolutionRoom::makeBuiltInRoom(double sampleRate) {
+    const float sr = (float) sampleRate;
+    const int length = (int) (0.4 * sampleRate);
+    juce::AudioBuffer<float> ir(2, length);
+    ir.clear();
+
+    static constexpr float reflections[][2] = {
+        { 3.1f, 0.55f }, { 5.3f, -0.42f }, { 7.9f, 0.36f }, { 11.2f, -0.30f }, { 14.7f, 0.24f }, { 19.3f, -0.18f }
+    };
+
+    const float decay = std::exp(-6.9078f / (0.32f * sr));
+    const int onset = (int) (0.0025f * sr);
+    const float rampIn = 1.0f / juce::jmax(1.0f, 0.006f * sr);
+
+    for (int ch = 0; ch < 2; ++ch) {
+        float* d = ir.getWritePointer(ch);
+        const float spread = ch == 0 ? 1.0f : 1.07f;
+        for (const auto& r : reflections) {
+            const int pos = (int) (r[0] * spread * 0.001f * sr);
+            if (pos < length)
+                d[pos] += r[1];
+        }
+
+        juce::Random random(0x6274 + ch);
+        float env = 1.0f, lp = 0.0f;
+        for (int i = onset; i < length; ++i) {
+            const float t = (float) (i - onset) / (float) (length - onset);
+            const float damping = 0.65f - 0.5f * t;
+            lp += damping * ((random.nextFloat() * 2.0f - 1.0f) - lp);
+            d[i] += lp * env * 0.35f * juce::jmin(1.0f, (float) (i - onset) * rampIn);
+            env *= decay;
+        }
+    }
+
+    normaliseIR(ir);
+    return ir;
+}
+
+void ConvolutionRoom::process(float* dataL, float* dataR, int numSamples, float targetAmount) {
+    // The retire slot can still be occupied if a fade finished while a loader job was running.
+    if (parked != nullptr && handoff->retired.load() == nullptr)
+        handoff->retired.store(parked.release());
+
+    if (incoming == nullptr && parked == nullptr) {
+        if (auto* next = handoff->pending.exchange(nullptr)) {
+            if (active == nullptr) {
+                active.reset(next);
+            } else {
+                incoming.reset(next);
+                fadePos = 0;
+            }
+        }
+    }
+
+    if (active == nullptr || (targetAmount <= 1.0e-4f && currentAmount <= 1.0e-4f)) {
+        currentAmount = targetAmount;
+        idle = true;
+        return;
+    }
+
+    // Coming back from silence: drop whatever tail was left from before.
+    if (idle) {
+        active->reset();
+        if (incoming != nullptr)
+            incoming->reset();
+        idle = false;
+    }
+
+    const int maxChunk = wetBuffer.getNumSamples();
+    for (int offset = 0; offset < numSamples; offset += maxChunk) {
+        const int n = juce::jmin(maxChunk, numSamples - offset);
+        float* outL = dataL + offset;
+        float* outR = dataR + offset;
+
+        float* wet[2] = { wetBuffer.getWritePointer(0), wetBuffer.getWritePointer(1) };
+        std::copy(outL, outL + n, wet[0]);
+        std::copy(outR, outR + n, wet[1]);
+        active->process(wet, 2, n);
+
+        if (incoming != nullptr) {
+            float* next[2] = { incomingBuffer.getWritePointer(0), incomingBuffer.getWritePointer(1) };
+            std::copy(outL, outL + n, next[0]);
+            std::copy(outR, outR + n, next[1]);
+            incoming->process(next, 2, n);
+
+            const float step = 1.0f / (float) fadeLength;
+            for (int i = 0; i < n; ++i) {
+                const float g = juce::jmin(1.0f, (float) (fadePos + i) * step);
+                wet[0][i] += (next[0][i] - wet[0][i]) * g;
+                wet[1][i] += (next[1][i] - wet[1][i]) * g;
+            }
+
+            fadePos += n;
+            if (fadePos >= fadeLength) {
+                PartitionedConvolver* expected = nullptr;
+                if (handoff->retired.compare_exchange_strong(expected, active.get()))
+                    active.release();
+                else
+                    parked = std::move(active);
+                active = std::move(incoming);
+            }
+        }
+
+        const float start = currentAmount;
+        const float delta = (targetAmount - start) / (float) juce::jmax(1, numSamples);
+        for (int i = 0; i < n; ++i) {
+            const float amount = start + delta * (float) (offset + i + 1);
+            outL[i] += wet[0][i] * amount;
+            outR[i] += wet[1][i] * amount;
+        }
+    }
+
+    currentAmount = targetAmount;
+}
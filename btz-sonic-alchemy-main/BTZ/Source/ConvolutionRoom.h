@@ -0,0 +1,72 @@
+/*
+  Box Tone Zone (BTZ) - ConvolutionRoom.h
+*/
+#pragma once
+
+#include "PartitionedConvolver.h"
+#include <JuceHeader.h>
+#include <atomic>
+#include <map>
+#include <memory>
+
+// Process-wide loader thread plus a cache of transformed IRs keyed by source and
+// sample rate, so every BTZ instance using the same room shares one set of spectra.
+struct RoomIRShared {
+    RoomIRShared() : loader(1) {}
+    std::shared_ptr<const ConvolutionKernel> getOrCreate(const juce::String& key,
+                                                         const std::function<juce::AudioBuffer<float>()>& makeIR);
+
+    juce::CriticalSection cacheLock;
+    std::map<juce::String, std::weak_ptr<const ConvolutionKernel>> cache;
+    juce::ThreadPool loader; // declared last: destroyed first, so running jobs finish before the cache goes
+};
+
+// Zero-latency "Room" send: adds amount * (input convolved with the IR).
+// IRs are read, resampled and transformed on the shared loader thread; the
+// finished convolver is handed to the audio thread through an atomic slot and
+// crossfaded in, and the old one is handed back for deletion off the audio thread.
+class ConvolutionRoom {
+public:
+    ConvolutionRoom();
+    ~ConvolutionRoom();
+
+    void prepare(double sampleRate, int maxBlockSize);
+    void reset();
+    // Audio-thread buffers and convolver state; call when not processing.
+    size_t getMemoryBytes() const noexcept;
+
+    // Empty file selects the built-in small room. Safe to call from the message thread.
+    void setImpulseResponse(const juce::File& file);
+    juce::File getImpulseResponse() const;
+
+    void process(float* dataL, float* dataR, int numSamples, float targetAmount);
+
+private:
+    // Shared between the room and in-flight loader jobs so a job can finish safely
+    // after the room has been destroyed.
+    struct Handoff {
+        std::atomic<PartitionedConvolver*> pending { nullptr };
+        std::atomic<PartitionedConvolver*> retired { nullptr };
+        std::atomic<int> latestGeneration { 0 };
+        ~Handoff();
+    };
+
+    void requestLoad();
+    static juce::AudioBuffer<float> loadIR(const juce::File& file, double sampleRate);
+    static juce::AudioBuffer<float> makeBuiltInRoom(double sampleRate);
+
+    juce::SharedResourcePointer<RoomIRShared> shared;
+    std::shared_ptr<Handoff> handoff;
+
+    std::unique_ptr<PartitionedConvolver> active, incoming, parked;
+    juce::AudioBuffer<float> wetBuffer, incomingBuffer;
+    int fadePos = 0, fadeLength = 1;
+    float currentAmount = 0.0f;
+    bool idle = true;
+
+    double preparedRate = 0.0;
+    juce::File irFile;
+    mutable juce::CriticalSection fileLock;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ConvolutionRoom)
+};
@@ -0,0 +1,120 @@
+/*
+  Box Tone Zone (BTZ) - CrossoverBank.cpp
+*/
+#include "CrossoverBank.h"
+
+void SvfLanes::setCutoff(float hz, double sampleRate, float q) {
+    const double nyquistSafe = 0.49 * sampleRate;
+    const float g = (float) std::tan(juce::MathConstants<double>::pi * juce::jlimit(1.0, nyquistSafe, (double) hz) / sampleRate);
+    k = 1.0f / juce::jmax(0.05f, q);
+    const float c1 = 1.0f / (1.0f + g * (g + k));
+    a1 = Vec4::broadcast(c1);
+    a2 = Vec4::broadcast(g * c1);
+    a3 = Vec4::broadcast(g * g * c1);
+}
+
+namespace {
+// low = v2, high = v0 - k v1 - v2, allpass = v0 - 2k v1, band (unity peak) = k v1
+void responseWeights(SvfLanes::Response r, float k, float& low, float& band, float& in) {
+    low = r == SvfLanes::lowPass ? 1.0f : (r == SvfLanes::highPass ? -1.0f : 0.0f);
+    band = r == SvfLanes::highPass ? -k : (r == SvfLanes::allPass ? -2.0f * k : (r == SvfLanes::bandPass ? k : 0.0f));
+    in = r == SvfLanes::highPass || r == SvfLanes::allPass ? 1.0f : 0.0f;
+}
+}
+
+void SvfLanes::setResponses(Response l0, Response l1, Response l2, Response l3) {
+    float low[4], band[4], in[4];
+    const Response r[4] = { l0, l1, l2, l3 };
+    for (int i = 0; i < 4; ++i)
+        responseWeights(r[i], k, low[i], band[i], in[i]);
+    wLow = Vec4::load(low);
+    wBand = Vec4::load(band);
+    wIn = Vec4::load(in);
+}
+
+void SvfLanes::setLane(int lane, float hz, double sampleRate, float q, Response response) {
+    const double nyquistSafe = 0.49 * sampleRate;
+    const float g = (float) std::tan(juce::MathConstants<double>::pi * juce::jlimit(1.0, nyquistSafe, (double) hz) / sampleRate);
+    const float laneK = 1.0f / juce::jmax(0.05f, q);
+    const float c1 = 1.0f / (1.0f + g * (g + laneK));
+
+    float c[6][4];
+    a1.store(c[0]); a2.store(c[1]); a3.store(c[2]);
+    wLow.store(c[3]); wBand.store(c[4]); wIn.store(c[5]);
+    c[0][lane] = c1;
+    c[1][lane] = g * c1;
+    c[2][lane] = g * g * c1;
+    responseWeights(response, laneK, c[3][lane], c[4][lane], c[5][lane]);
+    a1 = Vec4::load(c[0]); a2 = Vec4::load(c[1]); a3 = Vec4::load(c[2]);
+    wLow = Vec4::load(c[3]); wBand = Vec4::load(c[4]); wIn = Vec4::load(c[5]);
+}
+
+CrossoverBank3::CrossoverBank3() {
+    prepare(48000.0, 120.0f, 2500.0f);
+}
+
+void CrossoverBank3::prepare(double sampleRate, float lowMidHz, float midHighHz) {
+    lowSplit1.setCutoff(lowMidHz, sampleRate);
+    lowSplit2.setCutoff(lowMidHz, sampleRate);
+    highSplit1.setCutoff(midHighHz, sampleRate);
+    highSplit2.setCutoff(midHighHz, sampleRate);
+    lowAllpass.setCutoff(midHighHz, sampleRate);
+
+    lowSplit1.setResponses(SvfLanes::lowPass, SvfLanes::lowPass, SvfLanes::highPass, SvfLanes::highPass);
+    lowSplit2.setResponses(SvfLanes::lowPass, SvfLanes::lowPass, SvfLanes::highPass, SvfLanes::highPass);
+    highSplit1.setResponses(SvfLanes::lowPass, SvfLanes::lowPass, SvfLanes::highPass, SvfLanes::highPass);
+    highSplit2.setResponses(SvfLanes::lowPass, SvfLanes::lowPass, SvfLanes::highPass, SvfLanes::highPass);
+    lowAllpass.setResponses(SvfLanes::allPass, SvfLanes::allPass, SvfLanes::allPass, SvfLanes::allPass);
+    reset();
+}
+
+void CrossoverBank3::reset() {
+    for (auto* svf : { &lowSplit1, &lowSplit2, &highSplit1, &highSplit2, &lowAllpass })
+        svf->reset();
+}
+
+void CrossoverBank3::process(float inL, float inR, Bands& out) noexcept {
+    // [lowL, lowR, restL, restR] from the lower LR4 section.
+    float split[4];
+    lowSplit2.process(lowSplit1.process(Vec4::set(inL, inR, inL, inR))).store(split);
+
+    // [midL, midR, highL, highR] from the upper section.
+    float upper[4];
+    highSplit2.process(highSplit1.process(Vec4::set(split[2], split[3], split[2], split[3]))).store(upper);
+
+    float low[4];
+    lowAllpass.process(Vec4::set(split[0], split[1], 0.0f, 0.0f)).store(low);
+
+    out.low[0] = low[0];
+    out.low[1] = low[1];
+    out.mid[0] = upper[0];
+    out.mid[1] = upper[1];
+    out.high[0] = upper[2];
+    out.high[1] = upper[3];
+}
+
+CrossoverAllpass3::CrossoverAllpass3() {
+    prepare(48000.0, 120.0f, 2500.0f);
+}
+
+void CrossoverAllpass3::prepare(double sampleRate, float lowMidHz, float midHighHz) {
+    lowAllpass.setCutoff(lowMidHz, sampleRate);
+    highAllpass.setCutoff(midHighHz, sampleRate);
+    lowAllpass.setResponses(SvfLanes::allPass, SvfLanes::allPass, SvfLanes::allPass, SvfLanes::allPass);
+    highAllpass.setResponses(SvfLanes::allPass, SvfLanes::allPass, SvfLanes::allPass, SvfLanes::allPass);
+    reset();
+}
+
+void CrossoverAllpass3::reset() {
+    lowAllpass.reset();
+    highAllpass.reset();
+}
+
+void CrossoverAllpass3::process(float* dataL, float* dataR, int numSamples) noexcept {
+    for (int n = 0; n < numSamples; ++n) {
+        float y[4];
+        highAllpass.process(lowAllpass.process(Vec4::set(dataL[n], dataR[n], 0.0f, 0.0f))).store(y);
+        dataL[n] = y[0];
+        dataR[n] = y[1];
+    }
+}
@@ -0,0 +1,71 @@
+/*
+  Box Tone Zone (BTZ) - CrossoverBank.h
+*/
+#pragma once
+
+#include "SimdVec.h"
+#include <JuceHeader.h>
+
+// Four-lane TPT state-variable filter (Zavalishin/Simper). Every lane shares the
+// cutoff but picks its own response, so one tick can produce e.g. the low-pass
+// of L/R in lanes 0-1 and the high-pass of L/R in lanes 2-3. setLane() gives a
+// lane its own cutoff and Q as well.
+struct SvfLanes {
+    enum Response { lowPass, highPass, allPass, bandPass };
+
+    Vec4 ic1 = Vec4::zero(), ic2 = Vec4::zero();
+    Vec4 a1 = Vec4::zero(), a2 = Vec4::zero(), a3 = Vec4::zero();
+    Vec4 wLow = Vec4::zero(), wBand = Vec4::zero(), wIn = Vec4::zero();
+    float k = 1.41421356f;
+
+    void setCutoff(float hz, double sampleRate, float q = 0.70710678f);
+    void setResponses(Response l0, Response l1, Response l2, Response l3);
+    void setLane(int lane, float hz, double sampleRate, float q, Response response);
+    void reset() { ic1 = ic2 = Vec4::zero(); }
+
+    Vec4 process(Vec4 v0) noexcept {
+        const Vec4 v3 = v0 - ic2;
+        const Vec4 v1 = a1 * ic1 + a2 * v3;
+        const Vec4 v2 = ic2 + a2 * ic1 + a3 * v3;
+        ic1 = v1 + v1 - ic1;
+        ic2 = v2 + v2 - ic2;
+        return wLow * v2 + wBand * v1 + wIn * v0;
+    }
+};
+
+// Stereo 3-band Linkwitz-Riley (LR4) split. Each LR4 section is two cascaded
+// Butterworth SVF ticks with low- and high-pass lanes side by side, so both
+// channels and both outputs of a crossover point run in one register. The low
+// band gets the upper crossover's allpass, so low + mid + high is an allpass of
+// the input (flat magnitude): band gains are applied as sum(g * band), which is
+// flat for any uniform g, and a parallel path that is mixed back against that
+// sum goes through CrossoverAllpass3 first.
+class CrossoverBank3 {
+public:
+    struct Bands {
+        float low[2], mid[2], high[2];
+    };
+
+    CrossoverBank3();
+
+    void prepare(double sampleRate, float lowMidHz, float midHighHz);
+    void reset();
+    void process(float inL, float inR, Bands& out) noexcept;
+
+private:
+    SvfLanes lowSplit1, lowSplit2, highSplit1, highSplit2, lowAllpass;
+};
+
+// The allpass CrossoverBank3's bands sum to (the LR4 allpass of each crossover
+// point, one after the other), for stereo blocks that are mixed with a band sum.
+class CrossoverAllpass3 {
+public:
+    CrossoverAllpass3();
+
+    void prepare(double sampleRate, float lowMidHz, float midHighHz);
+    void reset();
+    void process(float* dataL, float* dataR, int numSamples) noexcept;
+
+private:
+    SvfLanes lowAllpass, highAllpass;
+};
@@ -0,0 +1,114 @@
+/*
+  Box Tone Zone (BTZ) - DspKernels.cpp
+*/
+#define BTZ_KERNEL_NAMESPACE btz_kernels_baseline
+#define BTZ_KERNEL_TABLE btzKernelsBaseline
+#include "DspKernelsImpl.h"
+#undef BTZ_KERNEL_NAMESPACE
+#undef BTZ_KERNEL_TABLE
+
+#include <JuceHeader.h>
+#include <atomic>
+
+// Defined by DspKernelsAvx2.cpp / DspKernelsAvx512.cpp when CMake builds them
+// with the matching flags (x86-64 only).
+#if BTZ_HAVE_AVX2_KERNELS
+extern const DspKernelTable btzKernelsAvx2;
+#endif
+#if BTZ_HAVE_AVX512_KERNELS
+extern const DspKernelTable btzKernelsAvx512;
+#endif
+
+namespace {
+const DspKernelTable* tableFor(DspKernels::Isa isa) {
+    switch (isa) {
+#if BTZ_HAVE_AVX2_KERNELS
+        case DspKernels::avx2:   return &btzKernelsAvx2;
+#endif
+#if BTZ_HAVE_AVX512_KERNELS
+        case DspKernels::avx512: return &btzKernelsAvx512;
+#endif
+        case DspKernels::baseline:
+        default:                 return &btzKernelsBaseline;
+    }
+}
+
+bool cpuSupports(DspKernels::Isa isa) {
+    switch (isa) {
+        case DspKernels::avx2:   return juce::SystemStats::hasAVX2() && juce::SystemStats::hasFMA3();
+        case DspKernels::avx512: return juce::SystemStats::hasAVX512F() && juce::SystemStats::hasAVX512VL();
+        case DspKernels::baseline:
+        default:                 return true;
+    }
+}
+
+DspKernels::Isa detectBest() {
+    DspKernels::Isa forced;
+    const auto env = juce::SystemStats::getEnvironmentVariable("BTZ_ISA", {});
+    if (env.isNotEmpty() && DspKernels::fromName(env.toRawUTF8(), forced) && DspKernels::isAvailable(forced))
+        return forced;
+
+    for (int i = DspKernels::numIsas - 1; i > DspKernels::baseline; --i)
+        if (DspKernels::isAvailable((DspKernels::Isa) i))
+            return (DspKernels::Isa) i;
+    return DspKernels::baseline;
+}
+
+std::atomic<int> selectedIsa { -1 };
+std::atomic<const DspKernelTable*> selectedTable { nullptr };
+}
+
+const DspKernelTable* DspKernels::current() noexcept {
+    if (auto* table = selectedTable.load(std::memory_order_acquire))
+        return table;
+
+    // Racing first calls all detect the same answer, so either store is fine.
+    const Isa isa = detectBest();
+    selectedIsa.store((int) isa);
+    selectedTable.store(tableFor(isa), std::memory_order_release);
+    return tableFor(isa);
+}
+
+bool DspKernels::select(Isa isa) {
+    if (! isAvailable(isa))
+        return false;
+    selectedIsa.store((int) isa);
+    selectedTable.store(tableFor(isa), std::memory_order_release);
+    return true;
+}
+
+bool DspKernels::isAvailable(Isa isa) {
+    if (isa < baseline || isa >= numIsas || ! cpuSupports(isa))
+        return false;
+    return isa == baseline || tableFor(isa) != tableFor(baseline);
+}
+
+DspKernels::Isa DspKernels::getSelected() {
+    current();
+    return (Isa) selectedIsa.load();
+}
+
+const char* DspKernels::getName(Isa isa) {
+    switch (isa) {
+        case avx2:   return "avx2";
+        case avx512: return "avx512";
+        case baseline:
+        default:
+#if defined(__aarch64__) || defined(_M_ARM64)
+            return "neon";
+#else
+            return "sse2";
+#endif
+    }
+}
+
+bool DspKernels::fromName(const char* name, Isa& isa) {
+    const juce::String n = juce::String(name).trim().toLowerCase();
+    for (int i = 0; i < numIsas; ++i) {
+        if (n == getName((Isa) i) || (i == baseline && (n == "baseline" || n == "sse2" || n == "neon"))) {
+            isa = (Isa) i;
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,58 @@
+/*
+  Box Tone Zone (BTZ) - DspKernels.h
+*/
+#pragma once
+
+// Block kernels built once per instruction set and picked at load time.
+//
+// DspKernelsImpl.h holds the kernel bodies as plain loops with split
+// accumulators, so each translation unit that includes it is vectorised for
+// the flags it is compiled with: the baseline (SSE2 on x86-64, NEON on ARM64),
+// AVX2 + FMA and AVX-512. The first call to DspKernels::get() checks the CPU
+// and takes the best variant; the BTZ_ISA environment variable or
+// DspKernels::select() overrides that for testing. Per-sample stages (shapers,
+// SVF lanes) stay inline Vec4 code: an indirect call per sample would cost more
+// than the wider registers save.
+//
+// This header is included by the per-ISA translation units and must stay free
+// of JUCE and of inline code shared with the rest of the plugin, so nothing
+// compiled with wider flags can be merged into baseline code by the linker.
+// Accumulated by DspKernelTable::meter over four streams (in L/R, out L/R).
+struct MeterSums {
+    float peak[4] = {};
+    float sumSquares[4] = {};
+    float cross = 0.0f;     // sum of stream 2 * stream 3 (output correlation)
+    float clips[4] = {};    // samples with |x| >= clipLevel
+};
+
+struct DspKernelTable {
+    // acc += x * h over split-complex spectra.
+    void (*complexMultiplyAccumulate)(float* accRe, float* accIm, const float* xRe, const float* xIm,
+                                      const float* hRe, const float* hIm, int n);
+    float (*dot)(const float* a, const float* b, int n);
+    // wet = dry + (wet - dry) * gain, per sample.
+    void (*mixToDry)(float* wet, const float* dry, const float* gain, int n);
+    void (*applyGain)(float* data, float gain, int n);
+    // Running peak and sum of squares of one channel.
+    void (*peakAndEnergy)(const float* data, int n, float& peak, float& sumSquares);
+    // Every meter statistic of one block in a single pass over the four streams.
+    void (*meter)(const float* const* streams, int n, float clipLevel, MeterSums& sums);
+};
+
+class DspKernels {
+public:
+    enum Isa { baseline, avx2, avx512, numIsas };
+
+    // Best variant for this CPU (or the BTZ_ISA override) on first use.
+    static const DspKernelTable& get() noexcept { return *current(); }
+
+    // Switches every caller to a variant; false if it was not built or the CPU lacks it.
+    static bool select(Isa isa);
+    static bool isAvailable(Isa isa);
+    static Isa getSelected();
+    static const char* getName(Isa isa);
+    static bool fromName(const char* name, Isa& isa);
+
+private:
+    static const DspKernelTable* current() noexcept;
+};
@@ -0,0 +1,8 @@
+/*
+  Box Tone Zone (BTZ) - DspKernelsAvx2.cpp
+
+  Compiled with the AVX2 + FMA flags set in CMakeLists.txt; it contains only the kernel bodies.
+*/
+#define BTZ_KERNEL_NAMESPACE btz_kernels_avx2
+#define BTZ_KERNEL_TABLE btzKernelsAvx2
+#include "DspKernelsImpl.h"
@@ -0,0 +1,8 @@
+/*
+  Box Tone Zone (BTZ) - DspKernelsAvx512.cpp
+
+  Compiled with the AVX-512 (F/VL) flags set in CMakeLists.txt; it contains only the kernel bodies.
+*/
+#define BTZ_KERNEL_NAMESPACE btz_kernels_avx512
+#define BTZ_KERNEL_TABLE btzKernelsAvx512
+#include "DspKernelsImpl.h"
@@ -0,0 +1,130 @@
+/*
+  Box Tone Zone (BTZ) - DspKernelsImpl.h
+
+  Kernel bodies, included once per instruction set with BTZ_KERNEL_NAMESPACE and
+  BTZ_KERNEL_TABLE defined. No include guard on purpose.
+*/
+#include "DspKernels.h"
+#include <cmath>
+
+#if ! defined(BTZ_KERNEL_NAMESPACE) || ! defined(BTZ_KERNEL_TABLE)
+ #error "Define BTZ_KERNEL_NAMESPACE and BTZ_KERNEL_TABLE before including DspKernelsImpl.h"
+#endif
+
+namespace BTZ_KERNEL_NAMESPACE {
+// Sixteen independent partial sums keep reductions vectorisable without
+// -ffast-math and fill one AVX-512 register (two AVX2, four SSE/NEON).
+constexpr int lanes = 16;
+
+static void complexMultiplyAccumulate(float* __restrict accRe, float* __restrict accIm,
+                                      const float* __restrict xRe, const float* __restrict xIm,
+                                      const float* __restrict hRe, const float* __restrict hIm, int n) {
+    for (int i = 0; i < n; ++i) {
+        accRe[i] += xRe[i] * hRe[i] - xIm[i] * hIm[i];
+        accIm[i] += xRe[i] * hIm[i] + xIm[i] * hRe[i];
+    }
+}
+
+static float dot(const float* __restrict a, const float* __restrict b, int n) {
+    float acc[lanes] = {};
+    int i = 0;
+    for (; i + lanes <= n; i += lanes)
+        for (int k = 0; k < lanes; ++k)
+            acc[k] += a[i + k] * b[i + k];
+    float sum = 0.0f;
+    for (; i < n; ++i)
+        sum += a[i] * b[i];
+    for (int k = 0; k < lanes; ++k)
+        sum += acc[k];
+    return sum;
+}
+
+static void mixToDry(float* __restrict wet, const float* __restrict dry, const float* __restrict gain, int n) {
+    for (int i = 0; i < n; ++i)
+        wet[i] = dry[i] + (wet[i] - dry[i]) * gain[i];
+}
+
+static void applyGain(float* __restrict data, float gain, int n) {
+    for (int i = 0; i < n; ++i)
+        data[i] *= gain;
+}
+
+static void peakAndEnergy(const float* __restrict data, int n, float& peak, float& sumSquares) {
+    float pk[lanes] = {}, sq[lanes] = {};
+    int i = 0;
+    for (; i + lanes <= n; i += lanes) {
+        for (int k = 0; k < lanes; ++k) {
+            const float x = data[i + k];
+            const float a = std::fabs(x);
+            pk[k] = pk[k] > a ? pk[k] : a;
+            sq[k] += x * x;
+        }
+    }
+    float p = peak, s = 0.0f;
+    for (; i < n; ++i) {
+        const float a = std::fabs(data[i]);
+        p = p > a ? p : a;
+        s += data[i] * data[i];
+    }
+    for (int k = 0; k < lanes; ++k) {
+        p = p > pk[k] ? p : pk[k];
+        s += sq[k];
+    }
+    peak = p;
+    sumSquares += s;
+}
+
+// Eight lanes keep the 13 accumulator rows in registers on AVX2 and AVX-512.
+static void meter(const float* const* streams, int n, float clipLevel, MeterSums& sums) {
+    constexpr int w = 8;
+    const float* __restrict a = streams[0];
+    const float* __restrict b = streams[1];
+    const float* __restrict c = streams[2];
+    const float* __restrict d = streams[3];
+    float pk[4][w] = {}, sq[4][w] = {}, cl[4][w] = {}, cr[w] = {};
+
+    int i = 0;
+    for (; i + w <= n; i += w) {
+        for (int k = 0; k < w; ++k) {
+            const float x[4] = { a[i + k], b[i + k], c[i + k], d[i + k] };
+            for (int s = 0; s < 4; ++s) {
+                const float m = std::fabs(x[s]);
+                pk[s][k] = pk[s][k] > m ? pk[s][k] : m;
+                sq[s][k] += x[s] * x[s];
+                cl[s][k] += m >= clipLevel ? 1.0f : 0.0f;
+            }
+            cr[k] += x[2] * x[3];
+        }
+    }
+    for (; i < n; ++i) {
+        const float x[4] = { a[i], b[i], c[i], d[i] };
+        for (int s = 0; s < 4; ++s) {
+            const float m = std::fabs(x[s]);
+            pk[s][0] = pk[s][0] > m ? pk[s][0] : m;
+            sq[s][0] += x[s] * x[s];
+            cl[s][0] += m >= clipLevel ? 1.0f : 0.0f;
+        }
+        cr[0] += x[2] * x[3];
+    }
+
+    for (int s = 0; s < 4; ++s) {
+        for (int k = 0; k < w; ++k) {
+            sums.peak[s] = sums.peak[s] > pk[s][k] ? sums.peak[s] : pk[s][k];
+            sums.sumSquares[s] += sq[s][k];
+            sums.clips[s] += cl[s][k];
+        }
+    }
+    for (int k = 0; k < w; ++k)
+        sums.cross += cr[k];
+}
+}
+
+extern const DspKernelTable BTZ_KERNEL_TABLE;
+const DspKernelTable BTZ_KERNEL_TABLE = {
+    BTZ_KERNEL_NAMESPACE::complexMultiplyAccumulate,
+    BTZ_KERNEL_NAMESPACE::dot,
+    BTZ_KERNEL_NAMESPACE::mixToDry,
+    BTZ_KERNEL_NAMESPACE::applyGain,
+    BTZ_KERNEL_NAMESPACE::peakAndEnergy,
+    BTZ_KERNEL_NAMESPACE::meter,
+};
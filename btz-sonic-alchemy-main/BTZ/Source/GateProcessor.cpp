@@ -0,0 +1,91 @@
+/*
+  Box Tone Zone (BTZ) - GateProcessor.cpp
+*/
+#include "GateProcessor.h"
+
+void GateProcessor::prepare(double sampleRate, int maxBlockSize) {
+    rate = juce::jmax(1.0, sampleRate);
+    delayLength = juce::jmax(1, getLookaheadSamples(rate));
+    delayL.assign((size_t) delayLength, 0.0f);
+    delayR.assign((size_t) delayLength, 0.0f);
+    gains.assign((size_t) juce::jmax(1, maxBlockSize), 1.0f);
+    reset();
+}
+
+void GateProcessor::reset() {
+    std::fill(delayL.begin(), delayL.end(), 0.0f);
+    std::fill(delayR.begin(), delayR.end(), 0.0f);
+    delayPos = 0;
+    isOpen = 0.0f;
+    gain = floorGain;
+    holdCounter = 0;
+    grDb = 0.0f;
+}
+
+void GateProcessor::setParameters(float thresholdDb, float rangeDb, float attackMs, float holdMs, float releaseMs) noexcept {
+    openLevel = juce::Decibels::decibelsToGain(thresholdDb);
+    closeLevel = juce::Decibels::decibelsToGain(thresholdDb - hysteresisDb);
+    floorGain = juce::Decibels::decibelsToGain(-juce::jmax(0.0f, rangeDb), -200.0f);
+    // The gain ramps in dB: attack and release are the times to cross the whole range.
+    const float spanDb = juce::jmax(0.01f, -juce::Decibels::gainToDecibels(floorGain, -200.0f));
+    attackStep = juce::Decibels::decibelsToGain(spanDb / ((float) rate * juce::jmax(0.01f, attackMs) * 0.001f));
+    releaseStep = juce::Decibels::decibelsToGain(-spanDb / ((float) rate * juce::jmax(1.0f, releaseMs) * 0.001f));
+    holdSamples = juce::roundToInt(juce::jmax(0.0f, holdMs) * 0.001 * rate);
+}
+
+void GateProcessor::setLookaheadEnabled(bool enabled) noexcept {
+    if (enabled == lookaheadEnabled)
+        return;
+    lookaheadEnabled = enabled;
+    reset();
+}
+
+void GateProcessor::delayBlock(float* dataL, float* dataR, int numSamples) noexcept {
+    for (int n = 0; n < numSamples; ++n) {
+        const float l = delayL[(size_t) delayPos], r = delayR[(size_t) delayPos];
+        delayL[(size_t) delayPos] = dataL[n];
+        delayR[(size_t) delayPos] = dataR[n];
+        dataL[n] = l;
+        dataR[n] = r;
+        if (++delayPos == delayLength)
+            delayPos = 0;
+    }
+}
+
+void GateProcessor::process(float* dataL, float* dataR, const float* key, int numSamples) noexcept {
+    if (! lookaheadEnabled) {
+        gain = 1.0f;
+        grDb = 0.0f;
+        return;
+    }
+    delayBlock(dataL, dataR, numSamples);
+
+    if (floorGain >= 0.9999f && gain >= 0.9999f) {
+        gain = 1.0f;
+        grDb = 0.0f;
+        return;
+    }
+
+    const int count = juce::jmin(numSamples, (int) gains.size());
+    float minGain = 1.0f;
+    for (int n = 0; n < count; ++n) {
+        const float level = key[n];
+        const bool above = level > openLevel;
+        const bool keepOpen = level > closeLevel;
+
+        // Above the close threshold the hold restarts; below it the hold runs out.
+        holdCounter = keepOpen ? holdSamples : juce::jmax(0, holdCounter - 1);
+        isOpen = above ? 1.0f : (keepOpen || holdCounter > 0 ? isOpen : 0.0f);
+
+        const float target = floorGain + isOpen * (1.0f - floorGain);
+        gain = target > gain ? juce::jmin(target, gain * attackStep) : juce::jmax(target, gain * releaseStep);
+        gains[(size_t) n] = gain;
+        minGain = juce::jmin(minGain, gain);
+    }
+
+    for (int n = 0; n < count; ++n) {
+        dataL[n] *= gains[(size_t) n];
+        dataR[n] *= gains[(size_t) n];
+    }
+    grDb = -juce::Decibels::gainToDecibels(minGain, -120.0f);
+}
@@ -0,0 +1,56 @@
+/*
+  Box Tone Zone (BTZ) - GateProcessor.h
+*/
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+
+// Lookahead gate/expander for the front of the Punch path, at host rate.
+//
+// The key comes from SidechainDetector (band-passed, peak envelope). The gate
+// opens above the threshold and closes only once the key has stayed below
+// threshold - hysteresis for the hold time; the state machine is written with
+// selects so it compiles without data-dependent branches. The gain ramps in dB
+// (attack/release = time to cross the whole range) and is applied to the audio
+// delayed by the lookahead, so the gate is fully open when a transient arrives. The
+// lookahead is reported as latency; with it switched out (only while the gate is
+// off) the gate passes audio straight through.
+class GateProcessor {
+public:
+    static constexpr float lookaheadMs = 1.0f;
+    static constexpr float hysteresisDb = 4.0f;
+
+    static int getLookaheadSamples(double sampleRate) { return juce::roundToInt(lookaheadMs * 0.001 * sampleRate); }
+
+    void prepare(double sampleRate, int maxBlockSize);
+    void reset();
+    size_t getMemoryBytes() const noexcept { return (delayL.size() + delayR.size() + gains.size()) * sizeof(float); }
+
+    // rangeDb 0 disables the gate (a plain delay of the same length while the lookahead is in).
+    void setParameters(float thresholdDb, float rangeDb, float attackMs, float holdMs, float releaseMs) noexcept;
+
+    // Off clears the gain state; on starts from an empty delay line.
+    void setLookaheadEnabled(bool enabled) noexcept;
+
+    void process(float* dataL, float* dataR, const float* key, int numSamples) noexcept;
+
+    // Deepest attenuation of the last block, positive dB.
+    float getGainReductionDb() const noexcept { return grDb; }
+
+private:
+    void delayBlock(float* dataL, float* dataR, int numSamples) noexcept;
+
+    double rate = 48000.0;
+    std::vector<float> delayL, delayR, gains;
+    int delayLength = 1, delayPos = 0;
+    bool lookaheadEnabled = true;
+
+    float openLevel = 0.0f, closeLevel = 0.0f, floorGain = 1.0f;
+    float attackStep = 1.0f, releaseStep = 1.0f;
+    int holdSamples = 0;
+
+    float isOpen = 0.0f, gain = 1.0f;
+    int holdCounter = 0;
+    float grDb = 0.0f;
+};
@@ -0,0 +1,81 @@
+/*
+  Box Tone Zone (BTZ) - GlueCompressor.cpp
+*/
+#include "GlueCompressor.h"
+
+namespace {
+constexpr int hostSamplesPerControlTick = 16;
+}
+
+GlueCompressor::GlueCompressor() {
+    prepare(48000.0, 1);
+}
+
+void GlueCompressor::prepare(double processingRate, int osFactor) {
+    rate = juce::jmax(1.0, processingRate);
+    controlInterval = hostSamplesPerControlTick * juce::jmax(1, osFactor);
+    setTimes(attackMs, releaseMs);
+    const float hz = sidechainHz > 0.0f ? sidechainHz : 60.0f;
+    sidechainHz = 0.0f;
+    setSidechainHighPass(hz);
+    reset();
+}
+
+void GlueCompressor::reset() {
+    sidechainFilter.reset();
+    controlCounter = 0;
+    peakL = peakR = 0.0f;
+    grDbL = grDbR = 0.0f;
+    gainL = gainR = 1.0f;
+    gainStepL = gainStepR = 0.0f;
+}
+
+void GlueCompressor::setTimes(float newAttackMs, float newReleaseMs) noexcept {
+    attackMs = juce::jmax(0.05f, newAttackMs);
+    releaseMs = juce::jmax(1.0f, newReleaseMs);
+    // One-pole coefficients for the control tick period, so the times are exact at any rate.
+    const double tick = controlInterval / rate;
+    attackCoeff = (float) (1.0 - std::exp(-tick / (attackMs * 0.001)));
+    releaseCoeff = (float) (1.0 - std::exp(-tick / (releaseMs * 0.001)));
+}
+
+void GlueCompressor::setSidechainHighPass(float hz) noexcept {
+    if (std::abs(hz - sidechainHz) < 0.01f)
+        return;
+    sidechainHz = hz;
+    sidechainFilter.setCutoff(hz, rate);
+    sidechainFilter.setResponses(SvfLanes::highPass, SvfLanes::highPass, SvfLanes::highPass, SvfLanes::highPass);
+}
+
+// Soft-knee gain computer; returns the gain change in dB (<= 0).
+float GlueCompressor::staticCurve(float levelDb) const noexcept {
+    const float over = levelDb - threshold;
+    if (2.0f * over <= -knee)
+        return 0.0f;
+    if (2.0f * over < knee) {
+        const float x = over + 0.5f * knee;
+        return -slope * x * x / (2.0f * knee);
+    }
+    return -slope * over;
+}
+
+void GlueCompressor::updateGain() noexcept {
+    controlCounter = 0;
+
+    const float linked = juce::jmax(peakL, peakR);
+    const float levelL = linked * link + peakL * (1.0f - link);
+    const float levelR = linked * link + peakR * (1.0f - link);
+    peakL = peakR = 0.0f;
+
+    auto smooth = [this](float& state, float level) {
+        const float target = staticCurve(juce::Decibels::gainToDecibels(level, -120.0f));
+        state += (target < state ? attackCoeff : releaseCoeff) * (target - state);
+    };
+    smooth(grDbL, levelL);
+    smooth(grDbR, levelR);
+
+    // Ramp linearly to the new gain over the next interval.
+    const float step = 1.0f / (float) controlInterval;
+    gainStepL = (juce::Decibels::decibelsToGain(grDbL) - gainL) * step;
+    gainStepR = (juce::Decibels::decibelsToGain(grDbR) - gainR) * step;
+}
@@ -0,0 +1,64 @@
+/*
+  Box Tone Zone (BTZ) - GlueCompressor.h
+*/
+#pragma once
+
+#include "CrossoverBank.h"
+
+// Feed-forward bus compressor for the Glue macro.
+//
+// Keyed from the signal at the glue point in the core, after the gate, Drive,
+// Warmth, Tape and Punch. Per sample it only high-passes the sidechain, tracks
+// the per-channel peak and applies an interpolated gain. Every controlInterval
+// samples (16 host samples at any oversampling factor) the gain computer runs in
+// the log domain: stereo-linked level -> soft-knee static curve -> attack/release
+// smoothing of the gain reduction in dB -> one dB-to-gain conversion per channel.
+class GlueCompressor {
+public:
+    GlueCompressor();
+
+    // processingRate is the rate process() is called at; osFactor keeps the control
+    // rate and therefore the behaviour identical across quality modes.
+    void prepare(double processingRate, int osFactor);
+    void reset();
+
+    void setThresholdAndRatio(float thresholdDb, float ratio) noexcept { threshold = thresholdDb; slope = 1.0f - 1.0f / juce::jmax(1.0f, ratio); }
+    void setKnee(float kneeDb) noexcept { knee = juce::jmax(0.0f, kneeDb); }
+    void setTimes(float attackMs, float releaseMs) noexcept;
+    void setLink(float amount) noexcept { link = juce::jlimit(0.0f, 1.0f, amount); }
+    void setSidechainHighPass(float hz) noexcept;
+
+    void process(float& L, float& R) noexcept {
+        float sc[4];
+        sidechainFilter.process(Vec4::set(L, R, 0.0f, 0.0f)).store(sc);
+        peakL = juce::jmax(peakL, std::abs(sc[0]));
+        peakR = juce::jmax(peakR, std::abs(sc[1]));
+
+        gainL += gainStepL;
+        gainR += gainStepR;
+        L *= gainL;
+        R *= gainR;
+
+        if (++controlCounter == controlInterval)
+            updateGain();
+    }
+
+    float getGainReductionDb() const noexcept { return juce::jmin(grDbL, grDbR); }
+
+private:
+    void updateGain() noexcept;
+    float staticCurve(float levelDb) const noexcept;
+
+    SvfLanes sidechainFilter;
+    double rate = 48000.0;
+    float sidechainHz = 0.0f;
+
+    float threshold = -12.0f, slope = 0.5f, knee = 6.0f, link = 1.0f;
+    float attackMs = 5.0f, releaseMs = 90.0f;
+    float attackCoeff = 0.5f, releaseCoeff = 0.05f;
+
+    int controlInterval = 16, controlCounter = 0;
+    float peakL = 0.0f, peakR = 0.0f;
+    float grDbL = 0.0f, grDbR = 0.0f;
+    float gainL = 1.0f, gainR = 1.0f, gainStepL = 0.0f, gainStepR = 0.0f;
+};
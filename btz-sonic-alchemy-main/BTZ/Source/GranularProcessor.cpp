@@ -0,0 +1,180 @@
+/*
+  Box Tone Zone (BTZ) - GranularProcessor.cpp
+*/
+#include "GranularProcessor.h"
+
+namespace {
+constexpr int windowSize = 4096;
+constexpr double captureSeconds = 0.6;
+constexpr float maxStartOffsetSeconds = 0.25f;
+constexpr float maxPitchSemitones = 3.0f;
+constexpr float releaseMs = 2.0f;
+
+// Hann window, sampled finely enough that a nearest-entry read needs no interpolation.
+const float* windowTable() {
+    static const std::vector<float> table = [] {
+        std::vector<float> t((size_t) windowSize);
+        for (int i = 0; i < windowSize; ++i)
+            t[(size_t) i] = (float) (0.5 - 0.5 * std::cos(juce::MathConstants<double>::twoPi * (i + 0.5) / windowSize));
+        return t;
+    }();
+    return table.data();
+}
+}
+
+GranularProcessor::GranularProcessor() {
+    windowTable();
+}
+
+void GranularProcessor::prepare(double sampleRate) {
+    rate = juce::jmax(1.0, sampleRate);
+    const int size = juce::nextPowerOfTwo((int) std::ceil(captureSeconds * rate) + 4);
+    ring.assign((size_t) size, 0.0f);
+    ringMask = size - 1;
+    amountCoeff = 1.0f - std::exp(-1.0f / ((float) rate * 0.020f));
+    releaseStep = 1.0f / ((float) rate * releaseMs * 0.001f);
+    reset();
+}
+
+void GranularProcessor::reset() {
+    std::fill(ring.begin(), ring.end(), 0.0f);
+    writePos = 0;
+    for (int j = 0; j < poolSize; ++j) {
+        delay[j] = 1.0f;
+        drift[j] = phase[j] = phaseInc[j] = gainL[j] = gainR[j] = fade[j] = fadeStep[j] = 0.0f;
+        spawnOrder[j] = 0;
+    }
+    spawnCount = 0;
+    numActive = numSounding = 0;
+    countdown = 0.0f;
+    amount = 0.0f;
+    noise.reset(0x6A41u);
+    randomPos = 64;
+}
+
+void GranularProcessor::setParameters(float grainMs, float density, float jitter) noexcept {
+    grainSamples = juce::jmax(16.0f, grainMs * 0.001f * (float) rate);
+    spawnInterval = (float) rate / juce::jmax(0.1f, density);
+    spread = juce::jlimit(0.0f, 1.0f, jitter);
+    // Overlapping grains of unrelated material add in power; the voice cap bounds the overlap.
+    level = 1.0f / std::sqrt(juce::jlimit(1.0f, (float) maxVoices, density * grainMs * 0.001f));
+}
+
+float GranularProcessor::nextRandom() noexcept {
+    if (randomPos == 64) {
+        noise.fill(randoms, 64);
+        randomPos = 0;
+    }
+    return randoms[randomPos++];
+}
+
+// Phase is no measure of age: a long grain spawned first can be behind a short
+// one spawned later. The counter difference stays ordered across wrap-around.
+void GranularProcessor::releaseOldestGrain() noexcept {
+    int oldest = -1;
+    for (int j = 0; j < numActive; ++j)
+        if (fadeStep[j] >= 0.0f && (oldest < 0 || (int32_t) (spawnOrder[j] - spawnOrder[oldest]) < 0))
+            oldest = j;
+    if (oldest >= 0) {
+        fadeStep[oldest] = -releaseStep;
+        --numSounding;
+    }
+}
+
+void GranularProcessor::removeGrain(int index) noexcept {
+    if (fadeStep[index] >= 0.0f)
+        --numSounding;
+    const int last = --numActive;
+    delay[index] = delay[last];       drift[index] = drift[last];
+    phase[index] = phase[last];       phaseInc[index] = phaseInc[last];
+    gainL[index] = gainL[last];       gainR[index] = gainR[last];
+    fade[index] = fade[last];         fadeStep[index] = fadeStep[last];
+    spawnOrder[index] = spawnOrder[last];
+
+    // Vacated lanes stay readable and silent.
+    delay[last] = 1.0f;
+    drift[last] = phase[last] = phaseInc[last] = gainL[last] = gainR[last] = fade[last] = fadeStep[last] = 0.0f;
+}
+
+void GranularProcessor::spawnGrain() noexcept {
+    if (numSounding >= maxVoices)
+        releaseOldestGrain();
+    if (numActive == poolSize)
+        return;   // every spare slot is still fading out
+
+    const float length = grainSamples * (1.0f + spread * nextRandom());
+    const float playbackRate = std::exp2(spread * 2.0f * maxPitchSemitones * nextRandom() / 12.0f);
+    const float pan = 0.5f + spread * 0.9f * nextRandom();
+
+    // Pitched-up grains read faster than the ring is written, so they start far
+    // enough back never to overtake the write head.
+    const float startDelay = 2.0f + juce::jmax(0.0f, playbackRate - 1.0f) * length
+                           + spread * maxStartOffsetSeconds * (float) rate * (nextRandom() + 0.5f);
+
+    const int j = numActive++;
+    ++numSounding;
+    delay[j] = startDelay;
+    drift[j] = 1.0f - playbackRate;
+    phase[j] = 0.0f;
+    phaseInc[j] = 1.0f / length;
+    gainL[j] = std::cos(pan * juce::MathConstants<float>::halfPi) * juce::MathConstants<float>::sqrt2 * level;
+    gainR[j] = std::sin(pan * juce::MathConstants<float>::halfPi) * juce::MathConstants<float>::sqrt2 * level;
+    fade[j] = 1.0f;
+    fadeStep[j] = 0.0f;
+    spawnOrder[j] = spawnCount++;
+}
+
+void GranularProcessor::process(float* dataL, float* dataR, int numSamples, float targetAmount) noexcept {
+    if (ring.empty())
+        return;
+
+    const float* window = windowTable();
+    const float* buf = ring.data();
+    const Vec4 zero = Vec4::zero(), one = Vec4::broadcast(1.0f);
+
+    for (int n = 0; n < numSamples; ++n) {
+        writePos = (writePos + 1) & ringMask;
+        ring[(size_t) writePos] = 0.5f * (dataL[n] + dataR[n]);
+        amount += amountCoeff * (targetAmount - amount);
+
+        if (targetAmount > 0.0f) {
+            countdown -= 1.0f;
+            if (countdown <= 0.0f) {
+                spawnGrain();
+                countdown += spawnInterval * (1.0f + spread * 1.8f * nextRandom());
+            }
+        }
+        if (numActive == 0)
+            continue;
+
+        Vec4 accL = zero, accR = zero;
+        for (int g = 0; g < numActive; g += 4) {
+            alignas(16) float a[4], b[4], frac[4], w[4];
+            for (int k = 0; k < 4; ++k) {
+                const int j = g + k;
+                const int whole = (int) delay[j];
+                frac[k] = delay[j] - (float) whole;
+                a[k] = buf[(writePos - whole) & ringMask];
+                b[k] = buf[(writePos - whole - 1) & ringMask];
+                w[k] = window[(int) (phase[j] * (float) windowSize)];
+            }
+
+            const Vec4 x0 = Vec4::load(a);
+            const Vec4 f = Vec4::load(fade + g);
+            const Vec4 s = (x0 + Vec4::load(frac) * (Vec4::load(b) - x0)) * Vec4::load(w) * f;
+            accL = Vec4::mulAdd(accL, s, Vec4::load(gainL + g));
+            accR = Vec4::mulAdd(accR, s, Vec4::load(gainR + g));
+
+            (Vec4::load(delay + g) + Vec4::load(drift + g)).store(delay + g);
+            (Vec4::load(phase + g) + Vec4::load(phaseInc + g)).store(phase + g);
+            Vec4::clamp(f + Vec4::load(fadeStep + g), zero, one).store(fade + g);
+        }
+
+        for (int j = numActive - 1; j >= 0; --j)
+            if (phase[j] >= 1.0f || fade[j] <= 0.0f)
+                removeGrain(j);
+
+        dataL[n] += amount * accL.sum();
+        dataR[n] += amount * accR.sum();
+    }
+}
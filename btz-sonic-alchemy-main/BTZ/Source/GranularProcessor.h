@@ -0,0 +1,66 @@
+/*
+  Box Tone Zone (BTZ) - GranularProcessor.h
+*/
+#pragma once
+
+#include "WowFlutter.h"
+
+// Granular "Texture" send: adds amount * (grain cloud of the recent signal).
+//
+// A mono capture ring holds the last half second. The scheduler spawns grains
+// by density with jittered spacing, length, pitch, pan and start offset; each
+// grain reads the ring with linear interpolation under a Hann window from a
+// shared precomputed table. Grains live in a fixed pool stored as arrays and
+// kept packed, so rendering walks the live grains four at a time in Vec4
+// lanes. At most maxVoices grains sound at once: when the cap is reached the
+// oldest sounding grain (by spawn order, whatever its length) gets a 2 ms fade
+// and the new grain takes a spare slot. Nothing allocates after prepare(), and the cost per sample is bounded
+// by the pool size.
+class GranularProcessor {
+public:
+    static constexpr int maxVoices = 32;
+    static constexpr int poolSize = maxVoices + 8;
+
+    GranularProcessor();
+
+    void prepare(double sampleRate);
+    void reset();
+    size_t getMemoryBytes() const noexcept { return ring.size() * sizeof(float); }
+
+    // grainMs: grain length, density: grains per second, jitter 0..1 randomises
+    // spacing, length, pitch (up to +-3 semitones), pan and start offset.
+    void setParameters(float grainMs, float density, float jitter) noexcept;
+
+    void process(float* dataL, float* dataR, int numSamples, float targetAmount) noexcept;
+
+    int getNumActiveGrains() const noexcept { return numActive; }
+
+private:
+    void spawnGrain() noexcept;
+    void releaseOldestGrain() noexcept;
+    void removeGrain(int index) noexcept;
+    float nextRandom() noexcept;
+
+    std::vector<float> ring;
+    int ringMask = 0, writePos = 0;
+    double rate = 48000.0;
+
+    // Per-grain state, structure of arrays; [0, numActive) are live.
+    alignas(16) float delay[poolSize] = {};      // samples behind the write head
+    alignas(16) float drift[poolSize] = {};      // 1 - playback rate: delay change per sample
+    alignas(16) float phase[poolSize] = {};      // window position 0..1
+    alignas(16) float phaseInc[poolSize] = {};
+    alignas(16) float gainL[poolSize] = {}, gainR[poolSize] = {};
+    alignas(16) float fade[poolSize] = {}, fadeStep[poolSize] = {};
+    uint32_t spawnOrder[poolSize] = {};           // spawnCount when the grain started
+    uint32_t spawnCount = 0;
+    int numActive = 0, numSounding = 0;
+
+    float grainSamples = 2880.0f, spawnInterval = 1200.0f, spread = 0.35f, level = 1.0f;
+    float countdown = 0.0f;
+    float amount = 0.0f, amountCoeff = 0.001f, releaseStep = 0.01f;
+
+    CounterNoise noise;
+    float randoms[64] = {};
+    int randomPos = 64;
+};
@@ -0,0 +1,300 @@
+/*
+  Box Tone Zone (BTZ) - LimiterNo6.cpp
+*/
+#include "LimiterNo6.h"
+
+namespace {
+constexpr float bandLookaheadMs = 1.5f;
+constexpr float bandReleaseMs = 80.0f;
+constexpr float peakLookaheadMs = 1.0f;
+constexpr float peakReleaseMs = 50.0f;
+constexpr float maxDriveDb = 12.0f;
+
+static inline double sinc(double x) {
+    if (std::abs(x) < 1.0e-9)
+        return 1.0;
+    const double px = juce::MathConstants<double>::pi * x;
+    return std::sin(px) / px;
+}
+
+static inline double besselI0(double x) {
+    double sum = 1.0, term = 1.0;
+    for (int k = 1; k < 32; ++k) {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+    }
+    return sum;
+}
+}
+
+//==============================================================================
+void LookaheadGain::prepare(int lookaheadSamples, float releaseMs, double sampleRate) {
+    length = juce::jmax(1, lookaheadSamples) + 1;
+    invLength = 1.0f / (float) length;
+    block.assign((size_t) length, Vec4::broadcast(1.0f));
+    suffix.assign((size_t) length + 1, Vec4::broadcast(1.0f));
+    box.assign((size_t) length, Vec4::broadcast(1.0f));
+    releaseCoeff = Vec4::broadcast(1.0f - std::exp(-1.0f / ((float) sampleRate * releaseMs * 0.001f)));
+    reset();
+}
+
+void LookaheadGain::reset() {
+    for (auto* v : { &block, &suffix, &box })
+        std::fill(v->begin(), v->end(), Vec4::broadcast(1.0f));
+    prefix = held = Vec4::broadcast(1.0f);
+    sum = Vec4::broadcast((float) length);
+    pos = 0;
+}
+
+void LookaheadGain::finishBlock() noexcept {
+    pos = 0;
+    for (int i = length - 1; i >= 0; --i)
+        suffix[(size_t) i] = Vec4::min(suffix[(size_t) i + 1], block[(size_t) i]);
+
+    // Re-sum once per window so the running sum never drifts.
+    sum = Vec4::zero();
+    for (const auto& v : box)
+        sum = sum + v;
+}
+
+//==============================================================================
+OversampledSoftClip::OversampledSoftClip() {
+    // Half-band low-pass at 2x: h[n] = 0.5 sinc(n / 2), Kaiser window (beta 5),
+    // 39 taps: flat to 20 kHz at 48 kHz with ~50 dB image rejection. The
+    // odd-offset taps are zero apart from the 0.5 centre tap. Designed once per process.
+    static const auto design = [] {
+        const int order = 2 * taps - 2;
+        const double beta = 5.0;
+        double even[taps];
+        double total = 0.0;
+        for (int k = 0; k < taps; ++k) {
+            const int n = 2 * k;
+            const double r = 2.0 * n / order - 1.0;
+            const double w = besselI0(beta * std::sqrt(juce::jmax(0.0, 1.0 - r * r))) / besselI0(beta);
+            even[k] = 0.5 * sinc(0.5 * (n - (order / 2))) * w;
+            total += even[k];
+        }
+        std::array<float, taps> result {};
+        for (int k = 0; k < taps; ++k)
+            result[(size_t) (taps - 1 - k)] = (float) (even[k] * 0.5 / total);
+        return result;
+    }();
+    std::copy(design.begin(), design.end(), reversed);
+    reset();
+}
+
+void OversampledSoftClip::reset() {
+    left = {};
+    right = {};
+    pos = 0;
+}
+
+float OversampledSoftClip::clip(float x, float ceiling) noexcept {
+    const float knee = 0.85f * ceiling;
+    const float ax = std::abs(x);
+    if (ax <= knee)
+        return x;
+    const float range = ceiling - knee;
+    const float y = knee + range * std::tanh((ax - knee) / range);
+    return x < 0.0f ? -y : y;
+}
+
+float OversampledSoftClip::dot(const float* history) const noexcept {
+    Vec4 acc = Vec4::zero();
+    for (int k = 0; k < taps; k += 4)
+        acc = Vec4::mulAdd(acc, Vec4::load(history + k), Vec4::load(reversed + k));
+    return acc.sum();
+}
+
+float OversampledSoftClip::processChannel(Channel& ch, float x, float ceiling) noexcept {
+    // Window [pos + 1, pos + taps] runs oldest -> newest after this write.
+    ch.in[pos] = ch.in[pos + taps] = x;
+    const float upEven = 2.0f * dot(ch.in + pos + 1);
+    const float upOdd = ch.in[pos + taps - (taps - 1) / 2];
+
+    ch.evenOut[pos] = ch.evenOut[pos + taps] = clip(upEven, ceiling);
+    ch.oddOut[pos] = ch.oddOut[pos + taps] = clip(upOdd, ceiling);
+    return dot(ch.evenOut + pos + 1) + 0.5f * ch.oddOut[pos + taps - taps / 2];
+}
+
+void OversampledSoftClip::process(float& L, float& R, float ceiling) noexcept {
+    L = processChannel(left, L, ceiling);
+    R = processChannel(right, R, ceiling);
+    pos = (pos + 1) % taps;
+}
+
+//==============================================================================
+TruePeakDetector::TruePeakDetector() {
+    // Lane p estimates the signal at (latency - p / 4) samples ago. Kaiser (beta 3)
+    // windowed sinc: within ~0.05 dB of a long reference up to 20 kHz at 48 kHz.
+    static const auto coeffs = [] {
+        std::array<std::array<float, taps>, 4> c {};
+        for (size_t p = 0; p < 4; ++p) {
+            double total = 0.0;
+            for (int k = 0; k < taps; ++k) {
+                const double t = k - latency + (double) p * 0.25;
+                const double r = t / (latency + 0.5);
+                const double w = besselI0(3.0 * std::sqrt(juce::jmax(0.0, 1.0 - r * r))) / besselI0(3.0);
+                c[p][(size_t) k] = (float) (sinc(t) * w);
+                total += c[p][(size_t) k];
+            }
+            for (auto& v : c[p])
+                v = (float) (v / total);
+        }
+        return c;
+    }();
+    for (size_t k = 0; k < (size_t) taps; ++k)
+        phases[k] = Vec4::set(coeffs[0][k], coeffs[1][k], coeffs[2][k], coeffs[3][k]);
+}
+
+void TruePeakDetector::reset() {
+    std::fill(std::begin(histL), std::end(histL), 0.0f);
+    std::fill(std::begin(histR), std::end(histR), 0.0f);
+    pos = 0;
+}
+
+//==============================================================================
+void LimiterNo6::prepare(double sampleRate) {
+    bank.prepare(sampleRate, 120.0f, 2500.0f);
+    bandGain.prepare(juce::roundToInt(bandLookaheadMs * 0.001 * sampleRate), bandReleaseMs, sampleRate);
+    peakGain.prepare(juce::roundToInt(peakLookaheadMs * 0.001 * sampleRate), peakReleaseMs, sampleRate);
+
+    const int bandDelaySamples = bandGain.getDelay();
+    const int peakDelaySamples = peakGain.getDelay() + TruePeakDetector::latency;
+    latency = bandDelaySamples + OversampledSoftClip::latency + peakDelaySamples;
+
+    bandDelay.assign((size_t) bandDelaySamples, Frame { Vec4::zero(), Vec4::zero() });
+    peakDelay.assign((size_t) peakDelaySamples, Vec4::zero());
+    dryDelay.assign((size_t) latency, Vec4::zero());
+
+    smoothCoeff = 1.0f - std::exp(-1.0f / ((float) sampleRate * 0.020f));
+    reset();
+}
+
+void LimiterNo6::reset() {
+    resetWetPath();
+    std::fill(dryDelay.begin(), dryDelay.end(), Vec4::zero());
+    dryPos = 0;
+    drive = 1.0f;
+    engage = 0.0f;
+    primed = false;
+}
+
+void LimiterNo6::resetWetPath() {
+    bank.reset();
+    bandGain.reset();
+    peakGain.reset();
+    clipper.reset();
+    truePeak.reset();
+    std::fill(bandDelay.begin(), bandDelay.end(), Frame { Vec4::zero(), Vec4::zero() });
+    std::fill(peakDelay.begin(), peakDelay.end(), Vec4::zero());
+    bandPos = peakPos = 0;
+    bandGrDb[0] = bandGrDb[1] = bandGrDb[2] = 0.0f;
+    settledOff = true;
+}
+
+// The dry delay keeps running so the delayed tap is valid whenever it is next needed.
+void LimiterNo6::processDryOnly(float* dataL, float* dataR, int numSamples) noexcept {
+    const bool delayed = dryDelayed > 0.5f;
+    for (int n = 0; n < numSamples; ++n) {
+        float dry[4];
+        dryDelay[(size_t) dryPos].store(dry);
+        dryDelay[(size_t) dryPos] = Vec4::set(dataL[n], dataR[n], 0.0f, 0.0f);
+        if (++dryPos == (int) dryDelay.size())
+            dryPos = 0;
+        if (delayed) {
+            dataL[n] = dry[0];
+            dataR[n] = dry[1];
+        }
+    }
+}
+
+void LimiterNo6::process(float* dataL, float* dataR, int numSamples, float amount, float ceilingDb, bool keepLatency) noexcept {
+    if (bandDelay.empty())
+        return;
+
+    const float driveTarget = juce::Decibels::decibelsToGain(juce::jlimit(0.0f, 1.0f, amount) * maxDriveDb);
+    const float engageTarget = amount > 0.0f ? 1.0f : 0.0f;
+    const float delayedTarget = keepLatency || amount > 0.0f ? 1.0f : 0.0f;
+    if (! primed) {
+        dryDelayed = delayedTarget;
+        primed = true;
+    }
+
+    // Settled off: nothing but the delay line (or nothing at all without latency).
+    if (engageTarget == 0.0f && engage < 1.0e-4f && std::abs(dryDelayed - delayedTarget) < 1.0e-4f) {
+        engage = 0.0f;
+        drive = driveTarget;
+        dryDelayed = delayedTarget;
+        if (! settledOff)
+            resetWetPath();
+        processDryOnly(dataL, dataR, numSamples);
+        return;
+    }
+    settledOff = false;
+    const float ceiling = juce::Decibels::decibelsToGain(ceilingDb);
+    const Vec4 ceilingVec = Vec4::broadcast(ceiling);
+    Vec4 minGain = Vec4::broadcast(1.0f);
+
+    for (int n = 0; n < numSamples; ++n) {
+        drive += smoothCoeff * (driveTarget - drive);
+        engage += smoothCoeff * (engageTarget - engage);
+        // A float one-pole stalls short of its target; once engaged the output has
+        // to be the clamped wet signal exactly, with no trace of the dry input.
+        if (std::abs(engageTarget - engage) < 1.0e-4f)
+            engage = engageTarget;
+        dryDelayed += smoothCoeff * (delayedTarget - dryDelayed);
+
+        const float inL = dataL[n], inR = dataR[n];
+        const float xL = inL * drive, xR = inR * drive;
+
+        CrossoverBank3::Bands b;
+        bank.process(xL, xR, b);
+        const Frame frame { Vec4::set(0.0f, b.low[0], b.mid[0], b.high[0]), Vec4::set(0.0f, b.low[1], b.mid[1], b.high[1]) };
+
+        // Stereo-linked per-band gain; the empty lane 0 never exceeds the ceiling.
+        const Vec4 level = Vec4::max(Vec4::max(Vec4::abs(frame.l), Vec4::abs(frame.r)), ceilingVec);
+        const Vec4 g = bandGain.process(ceilingVec / level);
+        minGain = Vec4::min(minGain, g);
+
+        const Frame delayed = bandDelay[(size_t) bandPos];
+        bandDelay[(size_t) bandPos] = frame;
+        if (++bandPos == (int) bandDelay.size())
+            bandPos = 0;
+
+        // sum(g * band): flat under any uniform gain, the crossover's allpass at unity.
+        float yL = (g * delayed.l).sum();
+        float yR = (g * delayed.r).sum();
+
+        clipper.process(yL, yR, ceiling);
+
+        const float tp = truePeak.process(yL, yR);
+        const float peakRequired = ceiling / juce::jmax(tp, ceiling);
+        const float pg = peakGain.process(Vec4::broadcast(peakRequired)).lane(0);
+
+        float pd[4];
+        peakDelay[(size_t) peakPos].store(pd);
+        peakDelay[(size_t) peakPos] = Vec4::set(yL, yR, 0.0f, 0.0f);
+        if (++peakPos == (int) peakDelay.size())
+            peakPos = 0;
+
+        const float outL = juce::jlimit(-ceiling, ceiling, pd[0] * pg);
+        const float outR = juce::jlimit(-ceiling, ceiling, pd[1] * pg);
+
+        float dry[4];
+        dryDelay[(size_t) dryPos].store(dry);
+        dryDelay[(size_t) dryPos] = Vec4::set(inL, inR, 0.0f, 0.0f);
+        if (++dryPos == (int) dryDelay.size())
+            dryPos = 0;
+
+        const float dryL = inL + dryDelayed * (dry[0] - inL);
+        const float dryR = inR + dryDelayed * (dry[1] - inR);
+        dataL[n] = outL * engage + dryL * (1.0f - engage);
+        dataR[n] = outR * engage + dryR * (1.0f - engage);
+    }
+
+    float g[4];
+    minGain.store(g);
+    for (int band = 0; band < 3; ++band)
+        bandGrDb[band] = -juce::Decibels::gainToDecibels(g[band + 1], -60.0f);
+}
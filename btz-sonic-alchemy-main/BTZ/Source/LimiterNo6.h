@@ -0,0 +1,160 @@
+/*
+  Box Tone Zone (BTZ) - LimiterNo6.h
+*/
+#pragma once
+
+#include "CrossoverBank.h"
+#include <array>
+#include <vector>
+
+// Lookahead gain computer for four independent lanes. The target is the minimum
+// required gain over the lookahead window (van Herk/Gil-Werman running minimum,
+// three min operations per sample), released exponentially, then smoothed by a
+// box filter over the same window. With the signal delayed by getDelay()
+// samples every peak meets its target gain exactly when it arrives.
+class LookaheadGain {
+public:
+    void prepare(int lookaheadSamples, float releaseMs, double sampleRate);
+    void reset();
+    int getDelay() const noexcept { return length - 1; }
+    size_t getMemoryBytes() const noexcept { return (block.size() + suffix.size() + box.size()) * sizeof(Vec4); }
+
+    Vec4 process(Vec4 required) noexcept {
+        const Vec4 one = Vec4::broadcast(1.0f);
+        const size_t i = (size_t) pos;
+
+        // Window = tail of the previous block (suffix minima) + head of this one.
+        block[i] = required;
+        prefix = pos == 0 ? required : Vec4::min(prefix, required);
+        held = Vec4::min(Vec4::min(prefix, suffix[i + 1]), held + releaseCoeff * (one - held));
+
+        sum = sum + held - box[i];
+        box[i] = held;
+        if (++pos == length)
+            finishBlock();
+        return sum * Vec4::broadcast(invLength);
+    }
+
+private:
+    void finishBlock() noexcept;
+
+    std::vector<Vec4> block, suffix, box;
+    Vec4 prefix = Vec4::broadcast(1.0f), held = Vec4::broadcast(1.0f), sum = Vec4::zero();
+    Vec4 releaseCoeff = Vec4::zero();
+    int length = 1, pos = 0;
+    float invLength = 1.0f;
+};
+
+// Soft clipper run at 2x through half-band polyphase FIRs. Only the non-zero
+// half-band taps are evaluated, so each direction is one 20-tap dot product per
+// channel; the odd up-sampled phase is a pure delay.
+class OversampledSoftClip {
+public:
+    static constexpr int taps = 20;
+    static constexpr int latency = taps - 1;
+
+    OversampledSoftClip();
+    void reset();
+    void process(float& L, float& R, float ceiling) noexcept;
+
+private:
+    struct Channel {
+        float in[taps * 2] = {}, evenOut[taps * 2] = {}, oddOut[taps * 2] = {};
+    };
+
+    static float clip(float x, float ceiling) noexcept;
+    float processChannel(Channel& ch, float x, float ceiling) noexcept;
+    float dot(const float* history) const noexcept;
+
+    float reversed[taps] = {};
+    Channel left, right;
+    int pos = 0;
+};
+
+// 4x inter-sample peak estimate (BS.1770-style): four windowed-sinc phases, one
+// per lane, evaluated with a single 16-tap multiply-add pass per channel. The
+// estimate refers to the input `latency` samples ago.
+class TruePeakDetector {
+public:
+    static constexpr int taps = 16;
+    static constexpr int latency = taps / 2;
+
+    TruePeakDetector();
+    void reset();
+
+    float process(float L, float R) noexcept {
+        histL[pos] = histL[pos + taps] = L;
+        histR[pos] = histR[pos + taps] = R;
+        pos = (pos + 1) % taps;
+
+        Vec4 accL = Vec4::zero(), accR = Vec4::zero();
+        for (int k = 0; k < taps; ++k) {
+            // Newest sample is at pos + taps - 1.
+            const int idx = pos + taps - 1 - k;
+            accL = Vec4::mulAdd(accL, phases[k], Vec4::broadcast(histL[idx]));
+            accR = Vec4::mulAdd(accR, phases[k], Vec4::broadcast(histR[idx]));
+        }
+        float p[4];
+        Vec4::max(Vec4::abs(accL), Vec4::abs(accR)).store(p);
+        return juce::jmax(juce::jmax(p[0], p[1]), juce::jmax(p[2], p[3]));
+    }
+
+private:
+    Vec4 phases[taps];
+    float histL[taps * 2] = {}, histR[taps * 2] = {};
+    int pos = 0;
+};
+
+// Drive output stage: three-band lookahead limiter -> 2x soft clip -> true-peak
+// limiter, all at host rate after the dry/wet mix.
+//
+// One crossover pass feeds one shared lookahead buffer whose lanes hold
+// [unused, low, mid, high] per channel; the band gains are computed in the same
+// lanes and the output is y = sum(g * band). The bands sum to the crossover's
+// allpass of the input, so any uniform reduction stays flat and an idle limiter
+// passes that allpass. An amount of 0 crossfades to the untouched dry input,
+// either delayed by the lookahead (keepLatency, so the latency never moves) or
+// undelayed (no latency while the limiter is off). Once settled off, only the
+// dry delay line runs.
+class LimiterNo6 {
+public:
+    void prepare(double sampleRate);
+    void reset();
+    int getLatencySamples() const noexcept { return latency; }
+    size_t getMemoryBytes() const noexcept {
+        return bandGain.getMemoryBytes() + peakGain.getMemoryBytes() + bandDelay.size() * sizeof(Frame)
+             + (peakDelay.size() + dryDelay.size()) * sizeof(Vec4);
+    }
+
+    // amount pushes the input by up to +12 dB; ceilingDb is the true-peak output ceiling.
+    // keepLatency delays the dry path by getLatencySamples() while off; it is implied
+    // whenever amount > 0.
+    void process(float* dataL, float* dataR, int numSamples, float amount, float ceilingDb, bool keepLatency) noexcept;
+
+    // Deepest reduction of the last block per band (0 = low, 1 = mid, 2 = high), positive dB.
+    float getBandGainReductionDb(int band) const noexcept { return bandGrDb[juce::jlimit(0, 2, band)]; }
+
+private:
+    struct Frame {
+        Vec4 l, r;
+    };
+
+    CrossoverBank3 bank;
+    LookaheadGain bandGain, peakGain;
+    OversampledSoftClip clipper;
+    TruePeakDetector truePeak;
+
+    std::vector<Frame> bandDelay;
+    std::vector<Vec4> peakDelay, dryDelay;
+    int bandPos = 0, peakPos = 0, dryPos = 0;
+    int latency = 0;
+
+    void resetWetPath();
+    void processDryOnly(float* dataL, float* dataR, int numSamples) noexcept;
+
+    float drive = 1.0f, engage = 0.0f, smoothCoeff = 0.001f;
+    float dryDelayed = 1.0f;     // 1 = dry tap at the lookahead delay, 0 = undelayed
+    bool settledOff = true;      // wet path idle and reset
+    bool primed = false;         // dryDelayed snapped to its first target
+    float bandGrDb[3] = {};
+};
@@ -0,0 +1,545 @@
+/*
+  Box Tone Zone (BTZ) - NeuralInference.h
+*/
+#pragma once
+
+#include "SimdVec.h"
+#include <JuceHeader.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+// Small header-only inference runtime for the BTZ_WITH_ML features.
+//
+// Everything is allocated when a model is loaded; forward() only touches
+// preallocated buffers, so it is safe on the audio thread. Weight matrices are
+// row-major with rows padded to a multiple of 4 floats (zero-filled), which lets
+// the GEMV run on Vec4 without tail handling.
+//
+// Weight file (little-endian):
+//   "BTZN" | u32 version (1) | u32 numLayers
+//   per layer: u32 type | u32 activation | u32 in | u32 out | u32 kernel | u32 dilation
+//              followed by float32 payload in PyTorch parameter order:
+//     Dense   weight[out][in], bias[out]
+//     GRU     weight_ih[3H][in], weight_hh[3H][H], bias_ih[3H], bias_hh[3H]   (gates r, z, n)
+//     LSTM    weight_ih[4H][in], weight_hh[4H][H], bias_ih[4H], bias_hh[4H]   (gates i, f, g, o)
+//     Conv1D  weight[out][in][kernel], bias[out]   (causal, left-padded)
+namespace nn {
+
+enum class LayerType : juce::uint32 { Dense = 0, GRU = 1, LSTM = 2, Conv1D = 3 };
+enum class Activation : juce::uint32 { Linear = 0, Tanh = 1, Sigmoid = 2, Relu = 3 };
+
+constexpr int padTo4(int n) { return (n + 3) & ~3; }
+
+static inline float sigmoid(float x) { return 1.0f / (1.0f + std::exp(-x)); }
+
+static inline void applyActivation(float* data, int n, Activation act) noexcept {
+    switch (act) {
+        case Activation::Tanh:    for (int i = 0; i < n; ++i) data[i] = std::tanh(data[i]); break;
+        case Activation::Sigmoid: for (int i = 0; i < n; ++i) data[i] = sigmoid(data[i]); break;
+        case Activation::Relu:    for (int i = 0; i < n; ++i) data[i] = juce::jmax(0.0f, data[i]); break;
+        case Activation::Linear:  break;
+    }
+}
+
+// y[r] = bias[r] + sum_c w[r * stride + c] * x[c]; stride is a multiple of 4 and
+// x is zero-padded up to stride. Four rows per pass keep the horizontal sums off
+// the critical path.
+static inline void gemv(const float* w, const float* bias, const float* x, float* y, int rows, int stride) noexcept {
+    int r = 0;
+    for (; r + 4 <= rows; r += 4) {
+        const float* w0 = w + r * stride;
+        Vec4 a0 = Vec4::zero(), a1 = Vec4::zero(), a2 = Vec4::zero(), a3 = Vec4::zero();
+        for (int c = 0; c < stride; c += 4) {
+            const Vec4 xv = Vec4::load(x + c);
+            a0 = Vec4::mulAdd(a0, Vec4::load(w0 + c), xv);
+            a1 = Vec4::mulAdd(a1, Vec4::load(w0 + stride + c), xv);
+            a2 = Vec4::mulAdd(a2, Vec4::load(w0 + 2 * stride + c), xv);
+            a3 = Vec4::mulAdd(a3, Vec4::load(w0 + 3 * stride + c), xv);
+        }
+        y[r]     = (bias != nullptr ? bias[r] : 0.0f) + a0.sum();
+        y[r + 1] = (bias != nullptr ? bias[r + 1] : 0.0f) + a1.sum();
+        y[r + 2] = (bias != nullptr ? bias[r + 2] : 0.0f) + a2.sum();
+        y[r + 3] = (bias != nullptr ? bias[r + 3] : 0.0f) + a3.sum();
+    }
+    for (const float* wr = w + r * stride; r < rows; ++r, wr += stride) {
+        Vec4 acc = Vec4::zero();
+        for (int c = 0; c < stride; c += 4)
+            acc = Vec4::mulAdd(acc, Vec4::load(wr + c), Vec4::load(x + c));
+        y[r] = (bias != nullptr ? bias[r] : 0.0f) + acc.sum();
+    }
+}
+
+//==============================================================================
+struct LayerHeader {
+    LayerType type = LayerType::Dense;
+    Activation activation = Activation::Linear;
+    int inSize = 0, outSize = 0, kernelSize = 1, dilation = 1;
+};
+
+// Sequential reader over a weight file. All reads fail softly; check ok() at the end.
+class WeightReader {
+public:
+    WeightReader(const void* data, size_t size) : stream(data, size, false) {}
+
+    bool readFileHeader(int& numLayers) {
+        char magic[4] = {};
+        if (stream.read(magic, 4) != 4 || std::memcmp(magic, "BTZN", 4) != 0)
+            return false;
+        const int version = stream.readInt();
+        numLayers = stream.readInt();
+        return version == 1 && numLayers > 0 && numLayers < 256 && ! stream.isExhausted();
+    }
+
+    bool readLayerHeader(LayerHeader& h) {
+        h.type = (LayerType) (juce::uint32) stream.readInt();
+        h.activation = (Activation) (juce::uint32) stream.readInt();
+        h.inSize = stream.readInt();
+        h.outSize = stream.readInt();
+        h.kernelSize = stream.readInt();
+        h.dilation = stream.readInt();
+        good = good && h.inSize > 0 && h.outSize > 0 && h.inSize <= 4096 && h.outSize <= 4096
+                    && h.kernelSize > 0 && h.kernelSize <= 64 && h.dilation > 0 && h.dilation <= 4096
+                    && (juce::uint32) h.type <= (juce::uint32) LayerType::Conv1D
+                    && (juce::uint32) h.activation <= (juce::uint32) Activation::Relu;
+        return good;
+    }
+
+    // Reads a rows x cols row-major matrix into storage with the given row stride.
+    bool readMatrix(float* dst, int rows, int cols, int stride) {
+        for (int r = 0; r < rows; ++r)
+            if (! readFloats(dst + r * stride, cols))
+                return false;
+        return true;
+    }
+
+    bool readFloats(float* dst, int count) {
+        for (int i = 0; i < count && good; ++i) {
+            if (stream.getNumBytesRemaining() < 4)
+                good = false;
+            else
+                dst[i] = stream.readFloat();
+        }
+        return good;
+    }
+
+    bool ok() const { return good; }
+    bool finished() { return stream.isExhausted(); }
+
+private:
+    juce::MemoryInputStream stream;
+    bool good = true;
+};
+
+//==============================================================================
+// Layer kernels. Weights and state live in caller-provided storage so the same
+// code serves the runtime-sized Model and the fixed-size StaticModel.
+
+struct DenseKernel {
+    static void forward(const float* w, const float* b, const float* in, float* out,
+                        int outSize, int inStride, Activation act) noexcept {
+        gemv(w, b, in, out, outSize, inStride);
+        applyActivation(out, outSize, act);
+    }
+};
+
+struct GRUKernel {
+    // gates: 6H scratch (3H input projection, 3H hidden projection); h: hidden state,
+    // padded to a multiple of 4 with zeros.
+    static void forward(const float* wih, const float* whh, const float* bih, const float* bhh,
+                        const float* in, float* h, float* gates, float* out,
+                        int hidden, int inStride, int hiddenStride) noexcept {
+        float* gx = gates;
+        float* gh = gates + 3 * hidden;
+        gemv(wih, bih, in, gx, 3 * hidden, inStride);
+        gemv(whh, bhh, h, gh, 3 * hidden, hiddenStride);
+        for (int i = 0; i < hidden; ++i) {
+            const float r = sigmoid(gx[i] + gh[i]);
+            const float z = sigmoid(gx[hidden + i] + gh[hidden + i]);
+            const float n = std::tanh(gx[2 * hidden + i] + r * gh[2 * hidden + i]);
+            h[i] = (1.0f - z) * n + z * h[i];
+        }
+        std::copy(h, h + hidden, out);
+    }
+};
+
+struct LSTMKernel {
+    // gates: 4H scratch; h, c: state (h padded with zeros).
+    static void forward(const float* wih, const float* whh, const float* bias,
+                        const float* in, float* h, float* c, float* gates, float* scratch, float* out,
+                        int hidden, int inStride, int hiddenStride) noexcept {
+        gemv(wih, bias, in, gates, 4 * hidden, inStride);
+        gemv(whh, nullptr, h, scratch, 4 * hidden, hiddenStride);
+        for (int i = 0; i < hidden; ++i) {
+            const float ig = sigmoid(gates[i] + scratch[i]);
+            const float fg = sigmoid(gates[hidden + i] + scratch[hidden + i]);
+            const float gg = std::tanh(gates[2 * hidden + i] + scratch[2 * hidden + i]);
+            const float og = sigmoid(gates[3 * hidden + i] + scratch[3 * hidden + i]);
+            c[i] = fg * c[i] + ig * gg;
+            h[i] = og * std::tanh(c[i]);
+        }
+        std::copy(h, h + hidden, out);
+    }
+};
+
+struct Conv1DKernel {
+    // history: ring of (kernel - 1) * dilation + 1 frames of inSize; gathered: the
+    // receptive field flattened to [tap][channel], padded to gatherStride.
+    static void forward(const float* w, const float* b, const float* in, float* out,
+                        float* history, int& historyPos, int historyFrames, float* gathered,
+                        int inSize, int outSize, int kernel, int dilation, int gatherStride, Activation act) noexcept {
+        std::copy(in, in + inSize, history + historyPos * inSize);
+        for (int k = 0; k < kernel; ++k) {
+            int frame = historyPos - (kernel - 1 - k) * dilation;
+            if (frame < 0)
+                frame += historyFrames;
+            std::copy(history + frame * inSize, history + (frame + 1) * inSize, gathered + k * inSize);
+        }
+        if (++historyPos == historyFrames)
+            historyPos = 0;
+
+        gemv(w, b, gathered, out, outSize, gatherStride);
+        applyActivation(out, outSize, act);
+    }
+};
+
+//==============================================================================
+// Runtime-sized model loaded from a weight file.
+class Layer {
+public:
+    virtual ~Layer() = default;
+    virtual void reset() noexcept {}
+    virtual void forward(const float* in, float* out) noexcept = 0;
+    int getInSize() const { return inSize; }
+    int getOutSize() const { return outSize; }
+
+protected:
+    int inSize = 0, outSize = 0;
+};
+
+class DenseLayer : public Layer {
+public:
+    DenseLayer(const LayerHeader& h, WeightReader& reader) : act(h.activation), inStride(padTo4(h.inSize)) {
+        inSize = h.inSize;
+        outSize = h.outSize;
+        weights.assign((size_t) (outSize * inStride), 0.0f);
+        bias.assign((size_t) outSize, 0.0f);
+        reader.readMatrix(weights.data(), outSize, inSize, inStride);
+        reader.readFloats(bias.data(), outSize);
+    }
+
+    void forward(const float* in, float* out) noexcept override {
+        DenseKernel::forward(weights.data(), bias.data(), in, out, outSize, inStride, act);
+    }
+
+private:
+    Activation act;
+    int inStride;
+    std::vector<float> weights, bias;
+};
+
+class GRULayer : public Layer {
+public:
+    GRULayer(const LayerHeader& h, WeightReader& reader)
+        : inStride(padTo4(h.inSize)), hiddenStride(padTo4(h.outSize)) {
+        inSize = h.inSize;
+        outSize = h.outSize;
+        const int rows = 3 * outSize;
+        wih.assign((size_t) (rows * inStride), 0.0f);
+        whh.assign((size_t) (rows * hiddenStride), 0.0f);
+        bih.assign((size_t) rows, 0.0f);
+        bhh.assign((size_t) rows, 0.0f);
+        state.assign((size_t) hiddenStride, 0.0f);
+        gates.assign((size_t) (2 * rows), 0.0f);
+        reader.readMatrix(wih.data(), rows, inSize, inStride);
+        reader.readMatrix(whh.data(), rows, outSize, hiddenStride);
+        reader.readFloats(bih.data(), rows);
+        reader.readFloats(bhh.data(), rows);
+    }
+
+    void reset() noexcept override { std::fill(state.begin(), state.end(), 0.0f); }
+    void forward(const float* in, float* out) noexcept override {
+        GRUKernel::forward(wih.data(), whh.data(), bih.data(), bhh.data(), in, state.data(), gates.data(), out,
+                           outSize, inStride, hiddenStride);
+    }
+
+private:
+    int inStride, hiddenStride;
+    std::vector<float> wih, whh, bih, bhh, state, gates;
+};
+
+class LSTMLayer : public Layer {
+public:
+    LSTMLayer(const LayerHeader& h, WeightReader& reader)
+        : inStride(padTo4(h.inSize)), hiddenStride(padTo4(h.outSize)) {
+        inSize = h.inSize;
+        outSize = h.outSize;
+        const int rows = 4 * outSize;
+        wih.assign((size_t) (rows * inStride), 0.0f);
+        whh.assign((size_t) (rows * hiddenStride), 0.0f);
+        bias.assign((size_t) rows, 0.0f);
+        std::vector<float> bhh((size_t) rows, 0.0f);
+        hState.assign((size_t) hiddenStride, 0.0f);
+        cState.assign((size_t) outSize, 0.0f);
+        gates.assign((size_t) rows, 0.0f);
+        scratch.assign((size_t) rows, 0.0f);
+        reader.readMatrix(wih.data(), rows, inSize, inStride);
+        reader.readMatrix(whh.data(), rows, outSize, hiddenStride);
+        reader.readFloats(bias.data(), rows);
+        reader.readFloats(bhh.data(), rows);
+        for (int i = 0; i < rows; ++i)
+            bias[(size_t) i] += bhh[(size_t) i];
+    }
+
+    void reset() noexcept override {
+        std::fill(hState.begin(), hState.end(), 0.0f);
+        std::fill(cState.begin(), cState.end(), 0.0f);
+    }
+    void forward(const float* in, float* out) noexcept override {
+        LSTMKernel::forward(wih.data(), whh.data(), bias.data(), in, hState.data(), cState.data(),
+                            gates.data(), scratch.data(), out, outSize, inStride, hiddenStride);
+    }
+
+private:
+    int inStride, hiddenStride;
+    std::vector<float> wih, whh, bias, hState, cState, gates, scratch;
+};
+
+class Conv1DLayer : public Layer {
+public:
+    Conv1DLayer(const LayerHeader& h, WeightReader& reader)
+        : act(h.activation), kernel(h.kernelSize), dilation(h.dilation),
+          historyFrames((h.kernelSize - 1) * h.dilation + 1), gatherStride(padTo4(h.kernelSize * h.inSize)) {
+        inSize = h.inSize;
+        outSize = h.outSize;
+        weights.assign((size_t) (outSize * gatherStride), 0.0f);
+        bias.assign((size_t) outSize, 0.0f);
+        history.assign((size_t) (historyFrames * inSize), 0.0f);
+        gathered.assign((size_t) gatherStride, 0.0f);
+
+        // File order is [out][in][tap]; the kernel wants [out][tap][in] to match the gather.
+        std::vector<float> raw((size_t) (inSize * kernel));
+        for (int o = 0; o < outSize; ++o) {
+            if (! reader.readFloats(raw.data(), inSize * kernel))
+                break;
+            for (int c = 0; c < inSize; ++c)
+                for (int k = 0; k < kernel; ++k)
+                    weights[(size_t) (o * gatherStride + k * inSize + c)] = raw[(size_t) (c * kernel + k)];
+        }
+        reader.readFloats(bias.data(), outSize);
+    }
+
+    void reset() noexcept override {
+        std::fill(history.begin(), history.end(), 0.0f);
+        historyPos = 0;
+    }
+    void forward(const float* in, float* out) noexcept override {
+        Conv1DKernel::forward(weights.data(), bias.data(), in, out, history.data(), historyPos, historyFrames,
+                              gathered.data(), inSize, outSize, kernel, dilation, gatherStride, act);
+    }
+
+private:
+    Activation act;
+    int kernel, dilation, historyFrames, gatherStride;
+    int historyPos = 0;
+    std::vector<float> weights, bias, history, gathered;
+};
+
+class Model {
+public:
+    // Message/loader thread only. Returns false (and leaves the model empty) on any format error.
+    bool loadFromData(const void* data, size_t size) {
+        layers.clear();
+        WeightReader reader(data, size);
+        int numLayers = 0;
+        if (! reader.readFileHeader(numLayers))
+            return false;
+
+        std::vector<std::unique_ptr<Layer>> loaded;
+        for (int i = 0; i < numLayers; ++i) {
+            LayerHeader h;
+            if (! reader.readLayerHeader(h))
+                return false;
+            if (! loaded.empty() && loaded.back()->getOutSize() != h.inSize)
+                return false;
+
+            switch (h.type) {
+                case LayerType::Dense:  loaded.push_back(std::make_unique<DenseLayer>(h, reader)); break;
+                case LayerType::GRU:    loaded.push_back(std::make_unique<GRULayer>(h, reader)); break;
+                case LayerType::LSTM:   loaded.push_back(std::make_unique<LSTMLayer>(h, reader)); break;
+                case LayerType::Conv1D: loaded.push_back(std::make_unique<Conv1DLayer>(h, reader)); break;
+            }
+            if (! reader.ok())
+                return false;
+        }
+        if (! reader.finished())
+            return false;
+
+        int widest = 0;
+        for (auto& l : loaded)
+            widest = juce::jmax(widest, l->getInSize(), l->getOutSize());
+        bufferA.assign((size_t) padTo4(widest), 0.0f);
+        bufferB = bufferA;
+        layers = std::move(loaded);
+        return true;
+    }
+
+    bool loadFromFile(const juce::File& file) {
+        juce::MemoryBlock block;
+        return file.loadFileAsData(block) && loadFromData(block.getData(), block.getSize());
+    }
+
+    bool isLoaded() const { return ! layers.empty(); }
+    int getInputSize() const { return layers.empty() ? 0 : layers.front()->getInSize(); }
+    int getOutputSize() const { return layers.empty() ? 0 : layers.back()->getOutSize(); }
+
+    void reset() noexcept {
+        for (auto& l : layers)
+            l->reset();
+    }
+
+    // One time step: in has getInputSize() values, out receives getOutputSize().
+    void forward(const float* in, float* out) noexcept {
+        if (layers.empty())
+            return;
+
+        float* src = bufferA.data();
+        float* dst = bufferB.data();
+        std::copy(in, in + layers.front()->getInSize(), src);
+        for (auto& l : layers) {
+            l->forward(src, dst);
+            // Keep the padding lanes zero for the next layer's GEMV.
+            std::fill(dst + l->getOutSize(), dst + padTo4(l->getOutSize()), 0.0f);
+            std::swap(src, dst);
+        }
+        std::copy(src, src + layers.back()->getOutSize(), out);
+    }
+
+private:
+    std::vector<std::unique_ptr<Layer>> layers;
+    std::vector<float> bufferA, bufferB;
+};
+
+//==============================================================================
+// Fixed-size layers for models whose topology is known at compile time. Sizes
+// become constants in the kernels, so loops unroll and nothing is virtual.
+
+template <int In, int Out, Activation Act = Activation::Linear>
+struct DenseT {
+    static constexpr int inSize = In, outSize = Out, inStride = padTo4(In);
+    alignas(16) std::array<float, (size_t) (Out * inStride)> weights {};
+    std::array<float, (size_t) Out> bias {};
+
+    bool load(WeightReader& r, const LayerHeader& h) {
+        return h.type == LayerType::Dense && h.inSize == In && h.outSize == Out && h.activation == Act
+            && r.readMatrix(weights.data(), Out, In, inStride) && r.readFloats(bias.data(), Out);
+    }
+    void reset() noexcept {}
+    void forward(const float* in, float* out) noexcept {
+        DenseKernel::forward(weights.data(), bias.data(), in, out, Out, inStride, Act);
+    }
+};
+
+template <int In, int Hidden>
+struct GRUT {
+    static constexpr int inSize = In, outSize = Hidden, inStride = padTo4(In), hiddenStride = padTo4(Hidden);
+    alignas(16) std::array<float, (size_t) (3 * Hidden * inStride)> wih {};
+    alignas(16) std::array<float, (size_t) (3 * Hidden * hiddenStride)> whh {};
+    std::array<float, (size_t) (3 * Hidden)> bih {}, bhh {};
+    alignas(16) std::array<float, (size_t) hiddenStride> state {};
+    std::array<float, (size_t) (6 * Hidden)> gates {};
+
+    bool load(WeightReader& r, const LayerHeader& h) {
+        return h.type == LayerType::GRU && h.inSize == In && h.outSize == Hidden
+            && r.readMatrix(wih.data(), 3 * Hidden, In, inStride)
+            && r.readMatrix(whh.data(), 3 * Hidden, Hidden, hiddenStride)
+            && r.readFloats(bih.data(), 3 * Hidden) && r.readFloats(bhh.data(), 3 * Hidden);
+    }
+    void reset() noexcept { state.fill(0.0f); }
+    void forward(const float* in, float* out) noexcept {
+        GRUKernel::forward(wih.data(), whh.data(), bih.data(), bhh.data(), in, state.data(), gates.data(), out,
+                           Hidden, inStride, hiddenStride);
+    }
+};
+
+template <int In, int Hidden>
+struct LSTMT {
+    static constexpr int inSize = In, outSize = Hidden, inStride = padTo4(In), hiddenStride = padTo4(Hidden);
+    alignas(16) std::array<float, (size_t) (4 * Hidden * inStride)> wih {};
+    alignas(16) std::array<float, (size_t) (4 * Hidden * hiddenStride)> whh {};
+    std::array<float, (size_t) (4 * Hidden)> bias {}, gates {}, scratch {};
+    alignas(16) std::array<float, (size_t) hiddenStride> hState {};
+    std::array<float, (size_t) Hidden> cState {};
+
+    bool load(WeightReader& r, const LayerHeader& h) {
+        std::array<float, (size_t) (4 * Hidden)> bhh {};
+        if (! (h.type == LayerType::LSTM && h.inSize == In && h.outSize == Hidden
+               && r.readMatrix(wih.data(), 4 * Hidden, In, inStride)
+               && r.readMatrix(whh.data(), 4 * Hidden, Hidden, hiddenStride)
+               && r.readFloats(bias.data(), 4 * Hidden) && r.readFloats(bhh.data(), 4 * Hidden)))
+            return false;
+        for (int i = 0; i < 4 * Hidden; ++i)
+            bias[(size_t) i] += bhh[(size_t) i];
+        return true;
+    }
+    void reset() noexcept { hState.fill(0.0f); cState.fill(0.0f); }
+    void forward(const float* in, float* out) noexcept {
+        LSTMKernel::forward(wih.data(), whh.data(), bias.data(), in, hState.data(), cState.data(),
+                            gates.data(), scratch.data(), out, Hidden, inStride, hiddenStride);
+    }
+};
+
+template <typename... Layers>
+class StaticModel {
+public:
+    static constexpr int inputSize = std::tuple_element_t<0, std::tuple<Layers...>>::inSize;
+    static constexpr int outputSize = std::tuple_element_t<sizeof...(Layers) - 1, std::tuple<Layers...>>::outSize;
+
+    bool loadFromData(const void* data, size_t size) {
+        WeightReader reader(data, size);
+        int numLayers = 0;
+        if (! reader.readFileHeader(numLayers) || numLayers != (int) sizeof...(Layers))
+            return false;
+        loaded = std::apply([&reader](auto&... l) {
+            return (loadLayer(l, reader) && ...);
+        }, layers) && reader.finished();
+        return loaded;
+    }
+
+    bool loadFromFile(const juce::File& file) {
+        juce::MemoryBlock block;
+        return file.loadFileAsData(block) && loadFromData(block.getData(), block.getSize());
+    }
+
+    bool isLoaded() const { return loaded; }
+    void reset() noexcept { std::apply([](auto&... l) { (l.reset(), ...); }, layers); }
+
+    void forward(const float* in, float* out) noexcept {
+        float* src = bufferA.data();
+        float* dst = bufferB.data();
+        std::copy(in, in + inputSize, src);
+        std::apply([&src, &dst](auto&... l) {
+            ((l.forward(src, dst), std::fill(dst + l.outSize, dst + padTo4(l.outSize), 0.0f), std::swap(src, dst)), ...);
+        }, layers);
+        std::copy(src, src + outputSize, out);
+    }
+
+private:
+    template <typename L>
+    static bool loadLayer(L& layer, WeightReader& reader) {
+        LayerHeader h;
+        return reader.readLayerHeader(h) && layer.load(reader, h);
+    }
+
+    static constexpr int widest = std::max({ padTo4(Layers::inSize)..., padTo4(Layers::outSize)... });
+    std::tuple<Layers...> layers;
+    alignas(16) std::array<float, (size_t) widest> bufferA {}, bufferB {};
+    bool loaded = false;
+};
+
+} // namespace nn
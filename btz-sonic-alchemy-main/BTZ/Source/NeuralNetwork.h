@@ -0,0 +1,94 @@
+/*
+  Box Tone Zone (BTZ) - NeuralNetwork.h
+*/
+#pragma once
+
+#include "NeuralInference.h"
+#include <JuceHeader.h>
+#include <memory>
+#include <vector>
+
+#ifdef BTZ_WITH_ML
+// Sample-in/sample-out audio model (e.g. a GRU amp/tone model) on the embedded
+// runtime. One model instance per channel so recurrent state never leaks across
+// channels. Load and prepare off the audio thread; process() is allocation-free.
+class NeuralNetwork {
+public:
+    NeuralNetwork() = default;
+    explicit NeuralNetwork(const juce::File& modelFile) { loadModel(modelFile); }
+
+    // Only mono-in/mono-out models are accepted. Call while the processor is not running.
+    bool loadModel(const juce::File& modelFile) {
+        nn::Model probe;
+        juce::MemoryBlock data;
+        isLoaded = modelFile.loadFileAsData(data) && probe.loadFromData(data.getData(), data.getSize())
+                && probe.getInputSize() == 1 && probe.getOutputSize() == 1;
+        modelData = isLoaded ? data : juce::MemoryBlock();
+        channelModels.clear();
+        if (isLoaded && numChannels > 0)
+            buildChannelModels();
+        return isLoaded;
+    }
+
+    void prepare(const juce::dsp::ProcessSpec& spec) {
+        numChannels = (int) spec.numChannels;
+        channelModels.clear();
+        if (isLoaded)
+            buildChannelModels();
+    }
+
+    void reset() {
+        for (auto& m : channelModels)
+            m->reset();
+    }
+
+    bool process(juce::dsp::AudioBlock<float>& block) {
+        if (! getEnabled() || channelModels.empty())
+            return false;
+
+        const int channels = juce::jmin((int) block.getNumChannels(), (int) channelModels.size());
+        const int numSamples = (int) block.getNumSamples();
+        for (int ch = 0; ch < channels; ++ch) {
+            auto& model = *channelModels[(size_t) ch];
+            float* data = block.getChannelPointer((size_t) ch);
+            for (int i = 0; i < numSamples; ++i)
+                model.forward(data + i, data + i);
+        }
+        return true;
+    }
+
+    void setEnabled(bool enabled) { isEnabled = enabled; }
+    bool getEnabled() const { return isEnabled && isLoaded; }
+    bool isModelLoaded() const { return isLoaded; }
+
+private:
+    void buildChannelModels() {
+        for (int ch = 0; ch < numChannels; ++ch) {
+            auto model = std::make_unique<nn::Model>();
+            model->loadFromData(modelData.getData(), modelData.getSize());
+            channelModels.push_back(std::move(model));
+        }
+    }
+
+    juce::MemoryBlock modelData;
+    std::vector<std::unique_ptr<nn::Model>> channelModels;
+    int numChannels = 0;
+    bool isLoaded = false;
+    bool isEnabled = false;
+};
+
+#else
+// Fallback implementation when ML is disabled
+class NeuralNetwork {
+public:
+    NeuralNetwork() = default;
+    explicit NeuralNetwork(const juce::File&) {}
+    bool loadModel(const juce::File&) { return false; }
+    void prepare(const juce::dsp::ProcessSpec&) {}
+    void reset() {}
+    bool process(juce::dsp::AudioBlock<float>&) { return false; }
+    void setEnabled(bool) {}
+    bool getEnabled() const { return false; }
+    bool isModelLoaded() const { return false; }
+};
+#endif
@@ -0,0 +1,153 @@
+/*
+  Box Tone Zone (BTZ) - ParameterTable.h
+*/
+#pragma once
+
+#include <cstddef>
+
+// Every host parameter in one constexpr table: ID, name, range, default and
+// smoothing. createParameterLayout(), the smoother setup, the processor's
+// cached value pointers and the editor attachments are all generated from it,
+// so a parameter is added in exactly one place. Entries are in host order and
+// must match the Id enum (checked at compile time); never reorder them, hosts
+// address automation by index.
+namespace BTZParams {
+
+enum Id {
+    // Baseline parameters, in their original host order.
+    punch, warmth, boom, glue, air, width, density, motion,
+    vintageModern, mix, drive,
+    sparkCeiling, sparkMix,
+    shineAmount, shineMix,
+    masterIntensity, autogain,
+    qualityMode, stabilityMode, bypass,
+    // Added later, always appended so existing automation keeps its index.
+    renderQuality,
+    room, adaptive, antiAlias,
+    glueLink, glueScHpf,
+    limiter,
+    tape, tapeSolver, motionInterp,
+    texture, textureSize, textureDensity, textureJitter,
+    gateThreshold, gateRange, gateAttack, gateHold, gateRelease, gateKey,
+    match,
+    qualityGovernor, renderPipeline,
+    fixedLatency,
+    count
+};
+
+// Where a parameter's SmoothParam runs: not smoothed, per core sample (times
+// follow the oversampled rate) or per host sample.
+enum class Smoothing { none, core, host };
+
+struct Spec {
+    Id index;
+    const char* id;
+    const char* name;
+    float min, max, step, skew, defaultValue;
+    Smoothing smoothing;
+    float smoothMs;
+};
+
+constexpr Spec pct(Id index, const char* id, const char* name, float def, Smoothing s = Smoothing::none, float ms = 0.0f) {
+    return { index, id, name, 0.0f, 1.0f, 0.001f, 1.0f, def, s, ms };
+}
+
+constexpr Spec range(Id index, const char* id, const char* name, float min, float max, float step, float def,
+                     float skew = 1.0f, Smoothing s = Smoothing::none, float ms = 0.0f) {
+    return { index, id, name, min, max, step, skew, def, s, ms };
+}
+
+// Stepped 0..last selector; the meaning of each step is documented with its reader.
+constexpr Spec choice(Id index, const char* id, const char* name, int last, int def) {
+    return { index, id, name, 0.0f, (float) last, 1.0f, 1.0f, (float) def, Smoothing::none, 0.0f };
+}
+
+constexpr Smoothing core = Smoothing::core;
+
+inline constexpr Spec table[] = {
+    pct(punch, "punch", "Punch", 0.18f, core, 5.0f),
+    pct(warmth, "warmth", "Warmth", 0.22f, core, 6.0f),
+    pct(boom, "boom", "Boom", 0.10f, core, 8.0f),
+    pct(glue, "glue", "Glue", 0.25f, core, 20.0f),
+    pct(air, "air", "Air", 0.12f, core, 6.0f),
+    pct(width, "width", "Width", 0.50f, core, 20.0f),
+    pct(density, "density", "Density", 0.16f, core, 6.0f),
+    pct(motion, "motion", "Motion", 0.04f, core, 40.0f),
+
+    range(vintageModern, "vintageModern", "Era", -1.0f, 1.0f, 0.01f, 0.0f, 1.0f, core, 25.0f),
+    pct(mix, "mix", "Mix", 1.0f, Smoothing::host, 12.0f),
+    range(drive, "drive", "Drive", 0.0f, 12.0f, 0.1f, 0.0f, 1.0f, core, 5.0f),
+
+    range(sparkCeiling, "sparkCeiling", "TP Ceil", -3.0f, 0.0f, 0.01f, -0.3f, 1.0f, core, 5.0f),
+    pct(sparkMix, "sparkMix", "Spark Mix", 1.0f, core, 5.0f),
+
+    range(shineAmount, "shineAmount", "Shine", 0.0f, 6.0f, 0.1f, 1.2f, 1.0f, core, 5.0f),
+    pct(shineMix, "shineMix", "Shine Mix", 0.30f, core, 5.0f),
+
+    pct(masterIntensity, "masterIntensity", "Master", 0.42f, core, 25.0f),
+    pct(autogain, "autogain", "AutoGain", 1.0f),
+
+    choice(qualityMode, "qualityMode", "Quality", 2, 1),
+    choice(stabilityMode, "stabilityMode", "Character", 1, 1),
+    choice(bypass, "bypass", "Bypass", 1, 0),
+
+    // 0 = follow qualityMode when bouncing, 1 = 8x, 2 = 16x linear-phase render path.
+    choice(renderQuality, "renderQuality", "Render Quality", 2, 0),
+
+    pct(room, "room", "Room", 0.0f),
+    pct(adaptive, "adaptive", "Adaptive", 0.0f),
+    // 0 = Auto (Eco: ADAA2, 2x: ADAA1, 4x and render: off), 1 = Off, 2 = ADAA1, 3 = ADAA2.
+    choice(antiAlias, "antiAlias", "Anti-Alias", 3, 0),
+
+    pct(glueLink, "glueLink", "Glue Link", 1.0f),
+    range(glueScHpf, "glueScHpf", "Glue SC HPF", 20.0f, 300.0f, 1.0f, 60.0f, 0.5f),
+
+    pct(limiter, "limiter", "Limiter", 0.0f),
+
+    pct(tape, "tape", "Tape", 0.0f, core, 10.0f),
+    // 0 = Auto (Eco: RK2 + Langevin table, 2x: RK2, 4x: RK4, render: Newton x8),
+    // 1 = RK2, 2 = RK4, 3 = Newton x4, 4 = Newton x8. Eco always uses the table.
+    choice(tapeSolver, "tapeSolver", "Tape Solver", 4, 0),
+    // 0 = Auto (Eco: Thiran allpass, otherwise cubic Lagrange), 1 = Linear, 2 = Lagrange, 3 = Thiran.
+    choice(motionInterp, "motionInterp", "Motion Interp", 3, 0),
+
+    pct(texture, "texture", "Texture", 0.0f),
+    range(textureSize, "textureSize", "Grain Size", 10.0f, 250.0f, 1.0f, 60.0f, 0.5f),
+    range(textureDensity, "textureDensity", "Grain Density", 2.0f, 400.0f, 1.0f, 40.0f, 0.4f),
+    pct(textureJitter, "textureJitter", "Grain Jitter", 0.35f),
+
+    // Lookahead gate at the front of the Punch path; Gate Range 0 dB = off.
+    range(gateThreshold, "gateThreshold", "Gate Thresh", -70.0f, 0.0f, 0.1f, -40.0f),
+    range(gateRange, "gateRange", "Gate Range", 0.0f, 60.0f, 0.1f, 0.0f),
+    range(gateAttack, "gateAttack", "Gate Attack", 0.05f, 20.0f, 0.01f, 0.5f, 0.4f),
+    range(gateHold, "gateHold", "Gate Hold", 0.0f, 200.0f, 0.1f, 20.0f, 0.5f),
+    range(gateRelease, "gateRelease", "Gate Release", 5.0f, 500.0f, 0.1f, 80.0f, 0.4f),
+    range(gateKey, "gateKey", "Gate Key", 40.0f, 8000.0f, 1.0f, 120.0f, 0.3f),
+
+    pct(match, "match", "Match", 1.0f),
+
+    // 1 = realtime quality steps down under CPU pressure and back up when it eases (QualityGovernor).
+    choice(qualityGovernor, "qualityGovernor", "CPU Governor", 1, 0),
+    // 1 = offline bounces run the chain as a pipeline across cores, bit-identical to one core.
+    choice(renderPipeline, "renderPipeline", "Render Pipeline", 1, 0),
+    // 0 = the limiter lookahead, gate lookahead and Motion centre delay are only reported and
+    // applied while Limiter / Gate Range / Motion are above 0, 1 = always, so automating them
+    // never moves the latency.
+    choice(fixedLatency, "fixedLatency", "Fixed Latency", 1, 0),
+};
+
+constexpr bool isInIdOrder() {
+    for (int i = 0; i < count; ++i)
+        if (table[i].index != (Id) i)
+            return false;
+    return true;
+}
+
+static_assert(sizeof(table) / sizeof(table[0]) == (std::size_t) count, "one table entry per BTZParams::Id");
+static_assert(isInIdOrder(), "BTZParams::table must list parameters in Id order");
+static_assert(shineAmount == 13 && masterIntensity == 15 && qualityMode == 17 && bypass == 19,
+              "baseline parameters keep their host indices; append new ones after bypass");
+
+constexpr const Spec& spec(Id index) { return table[index]; }
+
+}
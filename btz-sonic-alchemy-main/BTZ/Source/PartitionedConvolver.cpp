@@ -0,0 +1,225 @@
+/*
+  Box Tone Zone (BTZ) - PartitionedConvolver.cpp
+*/
+#include "PartitionedConvolver.h"
+#include "DspKernels.h"
+
+namespace {
+constexpr int headPartition = 64;
+constexpr int segmentSizes[] = { 64, 512, 4096 };
+constexpr int numSegmentSizes = (int) (sizeof(segmentSizes) / sizeof(segmentSizes[0]));
+// Larger segments are spread over one extra period, which moves their IR offset to 2P.
+constexpr int maxImmediatePartition = 64;
+constexpr int maxPartitionChannels = 2;
+
+static inline int fftOrderFor(int size) {
+    int order = 0;
+    while ((1 << order) < size)
+        ++order;
+    return order;
+}
+
+}
+
+std::shared_ptr<const ConvolutionKernel> ConvolutionKernel::create(const juce::AudioBuffer<float>& ir) {
+    auto kernel = std::make_shared<ConvolutionKernel>();
+    kernel->numChannels = juce::jlimit(1, maxPartitionChannels, ir.getNumChannels());
+    kernel->length = ir.getNumSamples();
+    kernel->headLength = headPartition;
+
+    kernel->headReversed.assign((size_t) kernel->numChannels, std::vector<float>((size_t) headPartition, 0.0f));
+    for (int ch = 0; ch < kernel->numChannels; ++ch)
+        for (int t = 0; t < juce::jmin(headPartition, kernel->length); ++t)
+            kernel->headReversed[(size_t) ch][(size_t) (headPartition - 1 - t)] = ir.getSample(ch, t);
+
+    int offsets[numSegmentSizes];
+    for (int s = 0; s < numSegmentSizes; ++s)
+        offsets[s] = segmentSizes[s] > maxImmediatePartition ? 2 * segmentSizes[s] : segmentSizes[s];
+
+    for (int s = 0; s < numSegmentSizes; ++s) {
+        const int size = segmentSizes[s];
+        const int offset = offsets[s];
+        const int end = s + 1 < numSegmentSizes ? juce::jmin(kernel->length, offsets[s + 1]) : kernel->length;
+        if (offset >= end)
+            break;
+
+        Segment seg;
+        seg.partitionSize = size;
+        seg.offset = offset;
+        seg.deferred = size > maxImmediatePartition;
+        seg.numPartitions = (end - offset + size - 1) / size;
+        seg.numBins = size + 1;
+        seg.binStride = (seg.numBins + 3) & ~3;
+
+        juce::dsp::FFT fft(fftOrderFor(2 * size));
+        std::vector<float> buffer((size_t) (4 * size));
+        seg.re.assign((size_t) kernel->numChannels, std::vector<float>((size_t) (seg.numPartitions * seg.binStride), 0.0f));
+        seg.im = seg.re;
+
+        for (int ch = 0; ch < kernel->numChannels; ++ch) {
+            for (int p = 0; p < seg.numPartitions; ++p) {
+                std::fill(buffer.begin(), buffer.end(), 0.0f);
+                const int start = offset + p * size;
+                const int count = juce::jmin(size, end - start);
+                for (int i = 0; i < count; ++i)
+                    buffer[(size_t) i] = ir.getSample(ch, start + i);
+
+                fft.performRealOnlyForwardTransform(buffer.data(), true);
+                float* re = seg.re[(size_t) ch].data() + p * seg.binStride;
+                float* im = seg.im[(size_t) ch].data() + p * seg.binStride;
+                for (int b = 0; b < seg.numBins; ++b) {
+                    re[b] = buffer[(size_t) (2 * b)];
+                    im[b] = buffer[(size_t) (2 * b + 1)];
+                }
+            }
+        }
+
+        kernel->segments.push_back(std::move(seg));
+    }
+
+    return kernel;
+}
+
+PartitionedConvolver::PartitionedConvolver(std::shared_ptr<const ConvolutionKernel> kernelToUse)
+    : kernel(std::move(kernelToUse)) {
+    channelStates.resize((size_t) maxPartitionChannels);
+    for (auto& cs : channelStates) {
+        cs.headHistory.assign((size_t) (2 * kernel->headLength), 0.0f);
+        cs.segments.resize(kernel->segments.size());
+        for (size_t s = 0; s < kernel->segments.size(); ++s) {
+            const auto& seg = kernel->segments[s];
+            auto& ss = cs.segments[s];
+            const int size = seg.partitionSize;
+            ss.fft = std::make_unique<juce::dsp::FFT>(fftOrderFor(2 * size));
+            ss.input.assign((size_t) (2 * size), 0.0f);
+            ss.fdlRe.assign((size_t) (seg.numPartitions * seg.binStride), 0.0f);
+            ss.fdlIm = ss.fdlRe;
+            ss.accRe.assign((size_t) seg.binStride, 0.0f);
+            ss.accIm = ss.accRe;
+            ss.fftBuffer.assign((size_t) (4 * size), 0.0f);
+            ss.output.assign((size_t) size, 0.0f);
+            ss.step = getNumSteps(seg);
+        }
+    }
+}
+
+size_t PartitionedConvolver::getMemoryBytes() const noexcept {
+    size_t floats = 0;
+    for (const auto& state : channelStates) {
+        floats += state.headHistory.size();
+        for (const auto& seg : state.segments)
+            floats += seg.input.size() + seg.fdlRe.size() + seg.fdlIm.size() + seg.accRe.size()
+                    + seg.accIm.size() + seg.fftBuffer.size() + seg.output.size();
+    }
+    return floats * sizeof(float);
+}
+
+void PartitionedConvolver::reset() {
+    for (auto& cs : channelStates) {
+        cs.headPos = 0;
+        std::fill(cs.headHistory.begin(), cs.headHistory.end(), 0.0f);
+        for (size_t s = 0; s < cs.segments.size(); ++s) {
+            auto& ss = cs.segments[s];
+            ss.fill = 0;
+            ss.fdlPos = 0;
+            // Nothing in flight: the first deferred result is the zeroed buffer.
+            ss.step = getNumSteps(kernel->segments[s]);
+            for (auto* v : { &ss.input, &ss.fdlRe, &ss.fdlIm, &ss.fftBuffer, &ss.output })
+                std::fill(v->begin(), v->end(), 0.0f);
+        }
+    }
+}
+
+void PartitionedConvolver::loadPartition(const ConvolutionKernel::Segment& seg, SegmentState& ss) {
+    const int size = seg.partitionSize;
+    std::copy(ss.input.begin(), ss.input.end(), ss.fftBuffer.begin());
+    std::fill(ss.fftBuffer.begin() + 2 * size, ss.fftBuffer.end(), 0.0f);
+    std::copy(ss.input.begin() + size, ss.input.end(), ss.input.begin());
+}
+
+void PartitionedConvolver::runStep(const ConvolutionKernel::Segment& seg, SegmentState& ss, int irChannel, int step) {
+    const int stride = seg.binStride;
+
+    if (step == 0) {
+        ss.fft->performRealOnlyForwardTransform(ss.fftBuffer.data(), true);
+        float* slotRe = ss.fdlRe.data() + ss.fdlPos * stride;
+        float* slotIm = ss.fdlIm.data() + ss.fdlPos * stride;
+        for (int b = 0; b < seg.numBins; ++b) {
+            slotRe[b] = ss.fftBuffer[(size_t) (2 * b)];
+            slotIm[b] = ss.fftBuffer[(size_t) (2 * b + 1)];
+        }
+        std::fill(ss.accRe.begin(), ss.accRe.end(), 0.0f);
+        std::fill(ss.accIm.begin(), ss.accIm.end(), 0.0f);
+    } else if (step <= seg.numPartitions) {
+        const int p = step - 1;
+        int slot = ss.fdlPos - p;
+        if (slot < 0)
+            slot += seg.numPartitions;
+        DspKernels::get().complexMultiplyAccumulate(ss.accRe.data(), ss.accIm.data(),
+                                                    ss.fdlRe.data() + slot * stride, ss.fdlIm.data() + slot * stride,
+                                                    seg.re[(size_t) irChannel].data() + p * stride,
+                                                    seg.im[(size_t) irChannel].data() + p * stride, stride);
+    } else {
+        for (int b = 0; b < seg.numBins; ++b) {
+            ss.fftBuffer[(size_t) (2 * b)] = ss.accRe[(size_t) b];
+            ss.fftBuffer[(size_t) (2 * b + 1)] = ss.accIm[(size_t) b];
+        }
+        // Overlap-save: the second half of the circular result is the valid output.
+        ss.fft->performRealOnlyInverseTransform(ss.fftBuffer.data());
+        if (++ss.fdlPos == seg.numPartitions)
+            ss.fdlPos = 0;
+    }
+}
+
+float PartitionedConvolver::processSample(ChannelState& cs, int irChannel, float x) {
+    const int headLength = kernel->headLength;
+    cs.headHistory[(size_t) cs.headPos] = x;
+    cs.headHistory[(size_t) (cs.headPos + headLength)] = x;
+    float y = DspKernels::get().dot(cs.headHistory.data() + cs.headPos + 1, kernel->headReversed[(size_t) irChannel].data(), headLength);
+    if (++cs.headPos == headLength)
+        cs.headPos = 0;
+
+    for (size_t s = 0; s < cs.segments.size(); ++s) {
+        const auto& seg = kernel->segments[s];
+        auto& ss = cs.segments[s];
+        const int size = seg.partitionSize;
+        ss.input[(size_t) (size + ss.fill)] = x;
+        y += ss.output[(size_t) ss.fill];
+        ++ss.fill;
+
+        if (seg.deferred) {
+            // The previous partition's steps, spread evenly so the last one lands
+            // before the end of this period.
+            const int numSteps = getNumSteps(seg);
+            const int due = juce::jmin(numSteps, (int) ((juce::int64) ss.fill * (numSteps + 1) / size));
+            while (ss.step < due)
+                runStep(seg, ss, irChannel, ss.step++);
+        }
+
+        if (ss.fill == size) {
+            if (seg.deferred) {
+                std::copy(ss.fftBuffer.begin() + size, ss.fftBuffer.begin() + 2 * size, ss.output.begin());
+                loadPartition(seg, ss);
+                ss.step = 0;
+            } else {
+                loadPartition(seg, ss);
+                for (int step = 0; step < getNumSteps(seg); ++step)
+                    runStep(seg, ss, irChannel, step);
+                std::copy(ss.fftBuffer.begin() + size, ss.fftBuffer.begin() + 2 * size, ss.output.begin());
+            }
+            ss.fill = 0;
+        }
+    }
+    return y;
+}
+
+void PartitionedConvolver::process(float* const* channels, int numChannels, int numSamples) {
+    const int channelsToProcess = juce::jmin(numChannels, (int) channelStates.size());
+    for (int ch = 0; ch < channelsToProcess; ++ch) {
+        auto& cs = channelStates[(size_t) ch];
+        const int irChannel = juce::jmin(ch, kernel->numChannels - 1);
+        float* data = channels[ch];
+        for (int i = 0; i < numSamples; ++i)
+            data[i] = processSample(cs, irChannel, data[i]);
+    }
+}
@@ -0,0 +1,86 @@
+/*
+  Box Tone Zone (BTZ) - PartitionedConvolver.h
+*/
+#pragma once
+
+#include <JuceHeader.h>
+#include <memory>
+#include <vector>
+
+// Immutable, pre-transformed impulse response. Built off the audio thread and
+// shared between every convolver (and plugin instance) using the same IR.
+//
+// Non-uniform layout: a direct-form head covers the first partition with zero
+// latency. The 64-pt segment starts at an IR offset of one partition, so its
+// one-partition latency is absorbed exactly and it runs as soon as a partition
+// is full. The larger segments start at two partitions; the extra period is the
+// budget over which their FFT, multiply-accumulates and inverse FFT are spread,
+// so no single sample pays for a whole partition.
+//   head [0, 64) | 64-pt segment [64, 1024) | 512-pt [1024, 8192) | 4096-pt [8192, end)
+struct ConvolutionKernel {
+    struct Segment {
+        int partitionSize = 0;
+        int offset = 0;          // first IR sample covered
+        bool deferred = false;   // computed over the following period instead of at once
+        int numPartitions = 0;
+        int numBins = 0;     // partitionSize + 1, padded to a multiple of 4 in storage
+        int binStride = 0;
+        // [channel][partition * binStride + bin], split complex for SIMD MAC
+        std::vector<std::vector<float>> re, im;
+    };
+
+    int numChannels = 0;
+    int length = 0;
+    int headLength = 0;
+    std::vector<std::vector<float>> headReversed;  // [channel][tap], reversed for a forward dot product
+    std::vector<Segment> segments;
+
+    static std::shared_ptr<const ConvolutionKernel> create(const juce::AudioBuffer<float>& ir);
+};
+
+// Streaming zero-latency convolver for one or two channels. All buffers are
+// allocated in the constructor; process() never allocates or locks.
+class PartitionedConvolver {
+public:
+    explicit PartitionedConvolver(std::shared_ptr<const ConvolutionKernel> kernelToUse);
+
+    void reset();
+    // Processes in place. Channel c uses IR channel min(c, irChannels - 1).
+    void process(float* const* channels, int numChannels, int numSamples);
+
+    const ConvolutionKernel& getKernel() const { return *kernel; }
+    // Streaming state only; the kernel is shared between convolvers.
+    size_t getMemoryBytes() const noexcept;
+
+private:
+    struct SegmentState {
+        std::unique_ptr<juce::dsp::FFT> fft;
+        int fill = 0;
+        int fdlPos = 0;
+        int step = 0;                 // next step of the partition in progress
+        std::vector<float> input;     // last 2P samples, FFT input window
+        std::vector<float> fdlRe, fdlIm; // numPartitions input spectra
+        std::vector<float> accRe, accIm;
+        std::vector<float> fftBuffer; // 4P floats (interleaved complex scratch)
+        std::vector<float> output;    // P samples emitted during the next period
+    };
+
+    struct ChannelState {
+        int headPos = 0;
+        std::vector<float> headHistory; // 2 * headLength, mirrored for contiguous reads
+        std::vector<SegmentState> segments;
+    };
+
+    float processSample(ChannelState& state, int irChannel, float x);
+    // Snapshots the input window for the next partition.
+    void loadPartition(const ConvolutionKernel::Segment& seg, SegmentState& state);
+    // 0: forward FFT into the FDL, 1..numPartitions: one multiply-accumulate each,
+    // numPartitions + 1: inverse FFT. getNumSteps() steps per partition.
+    void runStep(const ConvolutionKernel::Segment& seg, SegmentState& state, int irChannel, int step);
+    static int getNumSteps(const ConvolutionKernel::Segment& seg) noexcept { return seg.numPartitions + 2; }
+
+    std::shared_ptr<const ConvolutionKernel> kernel;
+    std::vector<ChannelState> channelStates;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PartitionedConvolver)
+};
@@ -52,49 +52,137 @@ void BTZLookAndFeel::drawLinearSlider(juce::Graphics& g, int x, int y, int w, in
 }
 
 BTZAudioProcessorEditor::BTZAudioProcessorEditor(BTZAudioProcessor& p) : AudioProcessorEditor(p), proc(p) {
-    setLookAndFeel(&lookAndFeel);
-    setSize(980, 610);
+    setLookAndFeel(lookAndFeel.get());
+    setSize(980, 720);
 
     auto styleTab = [&](juce::TextButton& b, int pageIdx) {
         addAndMakeVisible(b);
-        b.onClick = [this, pageIdx] { currentPage = pageIdx; resized(); repaint(); };
+        b.onClick = [this, pageIdx] { currentPage = pageIdx; buildPage(pageIdx); resized(); repaint(); };
     };
     styleTab(tabMain, 0);
     styleTab(tabSpark, 1);
     styleTab(tabAdvanced, 2);
 
     addAndMakeVisible(btnBypass);
+    bypassAttachment = std::make_unique<ButtonAttachment>(proc.getAPVTS(), BTZParams::spec(BTZParams::bypass).id, btnBypass);
 
-    auto initKnob = [&](juce::Slider& s, juce::Label& l) { setupKnob(s, l); };
-    initKnob(kPunch, lPunch); initKnob(kWarmth, lWarmth); initKnob(kBoom, lBoom);
-    initKnob(kGlue, lGlue); initKnob(kAir, lAir); initKnob(kWidth, lWidth);
-    initKnob(kDensity, lDensity); initKnob(kMotion, lMotion); initKnob(kEra, lEra);
-    initKnob(kDrive, lDrive); initKnob(kMix, lMix); initKnob(kMaster, lMaster);
+    // The meter timer starts with the first paint rather than here.
+    buildPage(currentPage);
+    resized();
+}
 
-    setupSlider(sCeiling); setupSlider(sSparkMix); setupSlider(sShine);
-    setupSlider(sShineMix); setupSlider(sIntensity);
+void BTZAudioProcessorEditor::buildPage(int page) {
+    if (pageBuilt[(size_t) page])
+        return;
+    pageBuilt[(size_t) page] = true;
+
+    std::vector<std::pair<juce::Slider*, BTZParams::Id>> sliderBindings;
+    if (page == 0) {
+        auto initKnob = [&](juce::Slider& s, juce::Label& l) { setupKnob(s, l); };
+        initKnob(kPunch, lPunch); initKnob(kWarmth, lWarmth); initKnob(kBoom, lBoom);
+        initKnob(kGlue, lGlue); initKnob(kAir, lAir); initKnob(kWidth, lWidth);
+        initKnob(kDensity, lDensity); initKnob(kMotion, lMotion); initKnob(kEra, lEra);
+        initKnob(kDrive, lDrive); initKnob(kMix, lMix); initKnob(kMaster, lMaster);
+
+        sliderBindings = {
+            { &kPunch, BTZParams::punch },
+            { &kWarmth, BTZParams::warmth },
+            { &kBoom, BTZParams::boom },
+            { &kGlue, BTZParams::glue },
+            { &kAir, BTZParams::air },
+            { &kWidth, BTZParams::width },
+            { &kDensity, BTZParams::density },
+            { &kMotion, BTZParams::motion },
+            { &kEra, BTZParams::vintageModern },
+            { &kMix, BTZParams::mix },
+            { &kDrive, BTZParams::drive },
+            { &kMaster, BTZParams::masterIntensity },
+        };
+    } else if (page == 1) {
+        setupSlider(sCeiling); setupSlider(sSparkMix); setupSlider(sShine);
+        setupSlider(sShineMix); setupSlider(sIntensity); setupSlider(sLimiter); setupSlider(sFixedLatency);
+
+        sliderBindings = {
+            { &sCeiling, BTZParams::sparkCeiling },
+            { &sSparkMix, BTZParams::sparkMix },
+            { &sLimiter, BTZParams::limiter },
+            { &sFixedLatency, BTZParams::fixedLatency },
+            { &sShine, BTZParams::shineAmount },
+            { &sShineMix, BTZParams::shineMix },
+            { &sIntensity, BTZParams::masterIntensity },
+        };
+    } else {
+        setupSlider(sRoom); setupSlider(sAdaptive);
+        setupSlider(sGlueLink); setupSlider(sGlueScHpf);
+        setupSlider(sTape); setupSlider(sTapeSolver); setupSlider(sMotionInterp); setupSlider(sGovernor); setupSlider(sRenderPipeline);
+        setupSlider(sTexture); setupSlider(sTextureSize); setupSlider(sTextureDensity); setupSlider(sTextureJitter);
+        setupSlider(sGateThreshold); setupSlider(sGateRange); setupSlider(sGateAttack);
+        setupSlider(sGateHold); setupSlider(sGateRelease); setupSlider(sGateKey);
+        setupSlider(sMatch);
+
+        addAndMakeVisible(btnLoadIR);
+        addAndMakeVisible(btnDefaultIR);
+        btnLoadIR.onClick = [this] {
+            irChooser = std::make_unique<juce::FileChooser>("Room impulse response", proc.getRoomImpulseResponse(), "*.wav;*.aif;*.aiff;*.flac");
+            irChooser->launchAsync(juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles,
+                                   [this](const juce::FileChooser& fc) {
+                                       if (fc.getResult().existsAsFile())
+                                           proc.setRoomImpulseResponse(fc.getResult());
+                                   });
+        };
+        btnDefaultIR.onClick = [this] { proc.setRoomImpulseResponse({}); };
+
+        // Learn captures the signal being matched, Learn Ref captures a reference played through BTZ.
+        for (auto* b : { &btnLoadRef, &btnLearnRef, &btnLearn })
+            addAndMakeVisible(*b);
+        btnLearnRef.setClickingTogglesState(true);
+        btnLearn.setClickingTogglesState(true);
+        btnLoadRef.onClick = [this] {
+            refChooser = std::make_unique<juce::FileChooser>("Match reference", proc.getMatchReference(), "*.wav;*.aif;*.aiff;*.flac");
+            refChooser->launchAsync(juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles,
+                                    [this](const juce::FileChooser& fc) {
+                                        if (fc.getResult().existsAsFile())
+                                            proc.setMatchReference(fc.getResult());
+                                    });
+        };
+        btnLearn.onClick = [this] {
+            btnLearnRef.setToggleState(false, juce::dontSendNotification);
+            proc.setMatchLearning(btnLearn.getToggleState() ? TimbralMatch::Learn::source : TimbralMatch::Learn::off);
+        };
+        btnLearnRef.onClick = [this] {
+            btnLearn.setToggleState(false, juce::dontSendNotification);
+            proc.setMatchLearning(btnLearnRef.getToggleState() ? TimbralMatch::Learn::reference : TimbralMatch::Learn::off);
+        };
+        btnLearn.setToggleState(proc.getMatchLearning() == TimbralMatch::Learn::source, juce::dontSendNotification);
+        btnLearnRef.setToggleState(proc.getMatchLearning() == TimbralMatch::Learn::reference, juce::dontSendNotification);
+
+        sliderBindings = {
+            { &sRoom, BTZParams::room },
+            { &sAdaptive, BTZParams::adaptive },
+            { &sGlueLink, BTZParams::glueLink },
+            { &sGlueScHpf, BTZParams::glueScHpf },
+            { &sTape, BTZParams::tape },
+            { &sTapeSolver, BTZParams::tapeSolver },
+            { &sMotionInterp, BTZParams::motionInterp },
+            { &sGovernor, BTZParams::qualityGovernor },
+            { &sRenderPipeline, BTZParams::renderPipeline },
+            { &sTexture, BTZParams::texture },
+            { &sTextureSize, BTZParams::textureSize },
+            { &sTextureDensity, BTZParams::textureDensity },
+            { &sTextureJitter, BTZParams::textureJitter },
+            { &sMatch, BTZParams::match },
+            { &sGateThreshold, BTZParams::gateThreshold },
+            { &sGateRange, BTZParams::gateRange },
+            { &sGateAttack, BTZParams::gateAttack },
+            { &sGateHold, BTZParams::gateHold },
+            { &sGateRelease, BTZParams::gateRelease },
+            { &sGateKey, BTZParams::gateKey },
+        };
+    }
 
     auto& apvts = proc.getAPVTS();
-    aPunch    = std::make_unique<SliderAttachment>(apvts, "punch", kPunch);
-    aWarmth   = std::make_unique<SliderAttachment>(apvts, "warmth", kWarmth);
-    aBoom     = std::make_unique<SliderAttachment>(apvts, "boom", kBoom);
-    aGlue     = std::make_unique<SliderAttachment>(apvts, "glue", kGlue);
-    aAir      = std::make_unique<SliderAttachment>(apvts, "air", kAir);
-    aWidth    = std::make_unique<SliderAttachment>(apvts, "width", kWidth);
-    aDensity  = std::make_unique<SliderAttachment>(apvts, "density", kDensity);
-    aMotion   = std::make_unique<SliderAttachment>(apvts, "motion", kMotion);
-    aEra      = std::make_unique<SliderAttachment>(apvts, "vintageModern", kEra);
-    aMix      = std::make_unique<SliderAttachment>(apvts, "mix", kMix);
-    aDrive    = std::make_unique<SliderAttachment>(apvts, "drive", kDrive);
-    aMaster   = std::make_unique<SliderAttachment>(apvts, "masterIntensity", kMaster);
-    aCeiling  = std::make_unique<SliderAttachment>(apvts, "sparkCeiling", sCeiling);
-    aSparkMix = std::make_unique<SliderAttachment>(apvts, "sparkMix", sSparkMix);
-    aShine    = std::make_unique<SliderAttachment>(apvts, "shineAmount", sShine);
-    aShineMix = std::make_unique<SliderAttachment>(apvts, "shineMix", sShineMix);
-    aIntensity = std::make_unique<SliderAttachment>(apvts, "masterIntensity", sIntensity);
-    aBypass = std::make_unique<ButtonAttachment>(apvts, "bypass", btnBypass);
-
-    startTimerHz(45);
+    for (const auto& [slider, id] : sliderBindings)
+        sliderAttachments.push_back(std::make_unique<SliderAttachment>(apvts, BTZParams::spec(id).id, *slider));
 }
 
 BTZAudioProcessorEditor::~BTZAudioProcessorEditor() {
@@ -110,7 +198,7 @@ void BTZAudioProcessorEditor::setupKnob(juce::Slider& s, juce::Label& l) {
 
     addAndMakeVisible(l);
     l.setJustificationType(juce::Justification::centred);
-    l.setFont(juce::Font(9.0f));
+    l.setFont(lookAndFeel->labelFont);
     l.setColour(juce::Label::textColourId, BTZColors::text2);
 }
 
@@ -124,6 +212,12 @@ void BTZAudioProcessorEditor::setupSlider(juce::Slider& s) {
 }
 
 void BTZAudioProcessorEditor::timerCallback() {
+    // Hidden (minimised, tab switched away): stop until the next paint.
+    if (! isShowing()) {
+        stopTimer();
+        return;
+    }
+
     auto& m = proc.getMeters();
     auto lerp = [](float& d, float t, float c) { d += c * (t - d); };
     lerp(inPeakL, m.inputPeakL.load(std::memory_order_relaxed), 0.3f);
@@ -135,10 +229,16 @@ void BTZAudioProcessorEditor::timerCallback() {
     lerp(outRmsL,  m.outputRmsL.load(std::memory_order_relaxed), 0.2f);
     lerp(outRmsR,  m.outputRmsR.load(std::memory_order_relaxed), 0.2f);
     lerp(sparkGR, m.sparkGainReductionDb.load(std::memory_order_relaxed), 0.25f);
+    lerp(limGrLow, m.limiterGrLowDb.load(std::memory_order_relaxed), 0.25f);
+    lerp(limGrMid, m.limiterGrMidDb.load(std::memory_order_relaxed), 0.25f);
+    lerp(limGrHigh, m.limiterGrHighDb.load(std::memory_order_relaxed), 0.25f);
+    lerp(gateGr, m.gateGrDb.load(std::memory_order_relaxed), 0.25f);
     lerp(lufs, m.lufs.load(std::memory_order_relaxed), 0.15f);
     lerp(corr, m.correlation.load(std::memory_order_relaxed), 0.2f);
     lerp(inClip, m.inputClip.load(std::memory_order_relaxed), 0.3f);
     lerp(outClip, m.outputClip.load(std::memory_order_relaxed), 0.3f);
+    qualityMode = m.qualityMode.load(std::memory_order_relaxed);
+    qualityGoverned = m.qualityGoverned.load(std::memory_order_relaxed);
     repaint();
 }
 
@@ -159,15 +259,18 @@ void BTZAudioProcessorEditor::paintGrMeter(juce::Graphics& g, juce::Rectangle<fl
 }
 
 void BTZAudioProcessorEditor::paint(juce::Graphics& g) {
+    if (! isTimerRunning())
+        startTimerHz(45);
+
     auto bounds = getLocalBounds().toFloat();
     g.setColour(BTZColors::canvas);
     g.fillRoundedRectangle(bounds, 10.0f);
 
     auto header = bounds.removeFromTop(54.0f);
     g.setColour(BTZColors::text);
-    g.setFont(juce::Font(14.0f).boldened());
+    g.setFont(lookAndFeel->titleFont);
     g.drawText("BOX TONE ZONE (BTZ)", header.removeFromLeft(250.0f), juce::Justification::centredLeft);
-    g.setFont(juce::Font(8.5f));
+    g.setFont(lookAndFeel->captionFont);
     g.setColour(BTZColors::text3);
     g.drawText("BTZ Audio", header.removeFromLeft(120.0f), juce::Justification::centredLeft);
 
@@ -179,7 +282,7 @@ void BTZAudioProcessorEditor::paint(juce::Graphics& g) {
     auto drawMeterRow = [&](juce::String label, float a, float b, bool gr = false) {
         auto row = meterBody.removeFromTop(12.0f);
         g.setColour(BTZColors::text3);
-        g.setFont(juce::Font(8.0f));
+        g.setFont(lookAndFeel->meterFont);
         g.drawText(label, row.removeFromLeft(80.0f), juce::Justification::centredLeft);
         auto m1 = row.removeFromLeft(180.0f).reduced(3.0f, 2.0f);
         auto m2 = row.removeFromLeft(180.0f).reduced(3.0f, 2.0f);
@@ -204,6 +307,15 @@ void BTZAudioProcessorEditor::paint(juce::Graphics& g) {
     g.drawText("IN CLIP", statusRow.removeFromLeft(80.0f), juce::Justification::centredLeft);
     g.setColour(outClip > 0.2f ? BTZColors::red : BTZColors::text3);
     g.drawText("OUT CLIP", statusRow.removeFromLeft(90.0f), juce::Justification::centredLeft);
+    g.setColour(BTZColors::text3);
+    g.drawText("LIM GR L/M/H: " + juce::String(limGrLow, 1) + " / " + juce::String(limGrMid, 1) + " / " + juce::String(limGrHigh, 1),
+               statusRow.removeFromLeft(220.0f), juce::Justification::centredLeft);
+    g.drawText("GATE GR: " + juce::String(gateGr, 1), statusRow.removeFromLeft(120.0f), juce::Justification::centredLeft);
+    // The running mode; oak while the CPU governor holds it below the selected one.
+    static const char* const modeNames[] = { "ECO", "2X", "4X", "RENDER" };
+    g.setColour(qualityGoverned ? BTZColors::oak : BTZColors::text3);
+    g.drawText(juce::String("QUALITY: ") + modeNames[juce::jlimit(0, 3, qualityMode)] + (qualityGoverned ? " (CPU)" : ""),
+               statusRow.removeFromLeft(130.0f), juce::Justification::centredLeft);
 
     auto content = bounds.reduced(16.0f, 4.0f);
     g.setColour(BTZColors::panel);
@@ -238,6 +350,14 @@ void BTZAudioProcessorEditor::resized() {
     hideKnob(kDensity, lDensity); hideKnob(kMotion, lMotion); hideKnob(kEra, lEra);
     hideKnob(kDrive, lDrive); hideKnob(kMix, lMix); hideKnob(kMaster, lMaster);
     sCeiling.setVisible(false); sSparkMix.setVisible(false); sShine.setVisible(false); sShineMix.setVisible(false); sIntensity.setVisible(false);
+    sLimiter.setVisible(false); sFixedLatency.setVisible(false);
+    sRoom.setVisible(false); sAdaptive.setVisible(false); btnLoadIR.setVisible(false); btnDefaultIR.setVisible(false);
+    sGlueLink.setVisible(false); sGlueScHpf.setVisible(false); sTape.setVisible(false); sTapeSolver.setVisible(false);
+    sMotionInterp.setVisible(false); sGovernor.setVisible(false); sRenderPipeline.setVisible(false);
+    sTexture.setVisible(false); sTextureSize.setVisible(false); sTextureDensity.setVisible(false); sTextureJitter.setVisible(false);
+    sMatch.setVisible(false); btnLoadRef.setVisible(false); btnLearnRef.setVisible(false); btnLearn.setVisible(false);
+    for (auto* s : { &sGateThreshold, &sGateRange, &sGateAttack, &sGateHold, &sGateRelease, &sGateKey })
+        s->setVisible(false);
 
     if (currentPage == 0) {
         const int knob = 74, label = 16;
@@ -258,11 +378,48 @@ void BTZAudioProcessorEditor::resized() {
         auto left = content.removeFromLeft(content.getWidth() / 2).reduced(20, 24);
         auto right = content.reduced(20, 24);
         sCeiling.setBounds(left.removeFromTop(30)); left.removeFromTop(8);
-        sSparkMix.setBounds(left.removeFromTop(30));
+        sSparkMix.setBounds(left.removeFromTop(30)); left.removeFromTop(24);
+        sLimiter.setBounds(left.removeFromTop(30)); left.removeFromTop(8);
+        sFixedLatency.setBounds(left.removeFromTop(30));
         sShine.setBounds(right.removeFromTop(30)); right.removeFromTop(8);
         sShineMix.setBounds(right.removeFromTop(30)); right.removeFromTop(24);
         sIntensity.setBounds(right.removeFromTop(30));
         sCeiling.setVisible(true); sSparkMix.setVisible(true); sShine.setVisible(true); sShineMix.setVisible(true); sIntensity.setVisible(true);
+        sLimiter.setVisible(true); sFixedLatency.setVisible(true);
+    } else if (currentPage == 2) {
+        auto left = content.removeFromLeft(content.getWidth() / 2).reduced(20, 24);
+        sRoom.setBounds(left.removeFromTop(30)); left.removeFromTop(8);
+        auto irRow = left.removeFromTop(26);
+        btnLoadIR.setBounds(irRow.removeFromLeft(90)); irRow.removeFromLeft(8);
+        btnDefaultIR.setBounds(irRow.removeFromLeft(90));
+        left.removeFromTop(24);
+        sTape.setBounds(left.removeFromTop(30)); left.removeFromTop(8);
+        sTapeSolver.setBounds(left.removeFromTop(30)); left.removeFromTop(24);
+        sTexture.setBounds(left.removeFromTop(30)); left.removeFromTop(8);
+        sTextureSize.setBounds(left.removeFromTop(30)); left.removeFromTop(8);
+        sTextureDensity.setBounds(left.removeFromTop(30)); left.removeFromTop(8);
+        sTextureJitter.setBounds(left.removeFromTop(30)); left.removeFromTop(24);
+        sMatch.setBounds(left.removeFromTop(30)); left.removeFromTop(8);
+        auto matchRow = left.removeFromTop(26);
+        btnLoadRef.setBounds(matchRow.removeFromLeft(90)); matchRow.removeFromLeft(8);
+        btnLearnRef.setBounds(matchRow.removeFromLeft(90)); matchRow.removeFromLeft(8);
+        btnLearn.setBounds(matchRow.removeFromLeft(90));
+        auto right = content.reduced(20, 24);
+        sAdaptive.setBounds(right.removeFromTop(30)); right.removeFromTop(24);
+        sGlueLink.setBounds(right.removeFromTop(30)); right.removeFromTop(8);
+        sGlueScHpf.setBounds(right.removeFromTop(30)); right.removeFromTop(24);
+        sMotionInterp.setBounds(right.removeFromTop(30)); right.removeFromTop(8);
+        sGovernor.setBounds(right.removeFromTop(30)); right.removeFromTop(8);
+        sRenderPipeline.setBounds(right.removeFromTop(30)); right.removeFromTop(24);
+        for (auto* s : { &sGateThreshold, &sGateRange, &sGateAttack, &sGateHold, &sGateRelease, &sGateKey }) {
+            s->setBounds(right.removeFromTop(30)); right.removeFromTop(8);
+            s->setVisible(true);
+        }
+        sRoom.setVisible(true); btnLoadIR.setVisible(true); btnDefaultIR.setVisible(true); sAdaptive.setVisible(true);
+        sGlueLink.setVisible(true); sGlueScHpf.setVisible(true); sTape.setVisible(true); sTapeSolver.setVisible(true);
+        sMotionInterp.setVisible(true); sGovernor.setVisible(true); sRenderPipeline.setVisible(true);
+        sTexture.setVisible(true); sTextureSize.setVisible(true); sTextureDensity.setVisible(true); sTextureJitter.setVisible(true);
+        sMatch.setVisible(true); btnLoadRef.setVisible(true); btnLearnRef.setVisible(true); btnLearn.setVisible(true);
     }
 }
 
@@ -5,6 +5,7 @@
 
 #include "PluginProcessor.h"
 #include <JuceHeader.h>
+#include <array>
 
 namespace BTZColors {
     const juce::Colour canvas { 0xFFF1EFEA };
@@ -18,6 +19,7 @@ namespace BTZColors {
     const juce::Colour red    { 0xFFC0543E };
 }
 
+// One instance is shared by every open editor (SharedResourcePointer), fonts included.
 class BTZLookAndFeel : public juce::LookAndFeel_V4 {
 public:
     BTZLookAndFeel();
@@ -25,6 +27,11 @@ public:
                           float rotaryStartAngle, float rotaryEndAngle, juce::Slider&) override;
     void drawLinearSlider(juce::Graphics&, int x, int y, int w, int h, float sliderPos,
                           float minSliderPos, float maxSliderPos, juce::Slider::SliderStyle, juce::Slider&) override;
+
+    const juce::Font titleFont { juce::Font(14.0f).boldened() };
+    const juce::Font captionFont { 8.5f };
+    const juce::Font labelFont { 9.0f };
+    const juce::Font meterFont { 8.0f };
 };
 
 class BTZAudioProcessorEditor : public juce::AudioProcessorEditor, private juce::Timer {
@@ -37,14 +44,17 @@ public:
 
 private:
     void timerCallback() override;
+    // Pages are populated (widgets styled, added and attached) the first time they are shown.
+    void buildPage(int page);
     void setupKnob(juce::Slider& s, juce::Label& l);
     void setupSlider(juce::Slider& s);
     void paintMeter(juce::Graphics& g, juce::Rectangle<float> area, float db, float minDb = -60.0f, float maxDb = 6.0f);
     void paintGrMeter(juce::Graphics& g, juce::Rectangle<float> area, float grDb);
 
     BTZAudioProcessor& proc;
-    BTZLookAndFeel lookAndFeel;
+    juce::SharedResourcePointer<BTZLookAndFeel> lookAndFeel;
     int currentPage = 0;
+    std::array<bool, 3> pageBuilt {};
 
     juce::TextButton tabMain { "MAIN" }, tabSpark { "SPARK" }, tabAdvanced { "ADVANCED" };
     juce::ToggleButton btnBypass { "BYPASS" };
@@ -56,19 +66,30 @@ private:
     juce::Label lDensity{ "", "Density" }, lMotion{ "", "Motion" }, lEra{ "", "Era" };
     juce::Label lDrive{ "", "Drive" }, lMix{ "", "Mix" }, lMaster{ "", "Master" };
 
-    juce::Slider sCeiling, sSparkMix, sShine, sShineMix, sIntensity;
+    juce::Slider sCeiling, sSparkMix, sShine, sShineMix, sIntensity, sLimiter, sFixedLatency;
+
+    juce::Slider sRoom, sAdaptive, sGlueLink, sGlueScHpf, sTape, sTapeSolver, sMotionInterp, sGovernor, sRenderPipeline;
+    juce::Slider sTexture, sTextureSize, sTextureDensity, sTextureJitter;
+    juce::Slider sGateThreshold, sGateRange, sGateAttack, sGateHold, sGateRelease, sGateKey;
+    juce::TextButton btnLoadIR { "LOAD IR" }, btnDefaultIR { "BUILT-IN" };
+    std::unique_ptr<juce::FileChooser> irChooser;
+    juce::Slider sMatch;
+    juce::TextButton btnLoadRef { "LOAD REF" }, btnLearnRef { "LEARN REF" }, btnLearn { "LEARN" };
+    std::unique_ptr<juce::FileChooser> refChooser;
 
     using SliderAttachment = juce::AudioProcessorValueTreeState::SliderAttachment;
     using ButtonAttachment = juce::AudioProcessorValueTreeState::ButtonAttachment;
-    std::unique_ptr<SliderAttachment> aPunch, aWarmth, aBoom, aGlue, aAir, aWidth;
-    std::unique_ptr<SliderAttachment> aDensity, aMotion, aEra, aMix, aDrive, aMaster;
-    std::unique_ptr<SliderAttachment> aCeiling, aSparkMix, aShine, aShineMix, aIntensity;
-    std::unique_ptr<ButtonAttachment> aBypass;
+    // Built from (widget, BTZParams::Id) pairs per page so the IDs come from the parameter table.
+    std::vector<std::unique_ptr<SliderAttachment>> sliderAttachments;
+    std::unique_ptr<ButtonAttachment> bypassAttachment;
 
     float inPeakL = -100.0f, inPeakR = -100.0f, inRmsL = -100.0f, inRmsR = -100.0f;
     float outPeakL = -100.0f, outPeakR = -100.0f, outRmsL = -100.0f, outRmsR = -100.0f;
     float sparkGR = 0.0f, lufs = -24.0f, corr = 1.0f;
+    float limGrLow = 0.0f, limGrMid = 0.0f, limGrHigh = 0.0f, gateGr = 0.0f;
     float inClip = 0.0f, outClip = 0.0f;
+    int qualityMode = 1;
+    bool qualityGoverned = false;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(BTZAudioProcessorEditor)
 };
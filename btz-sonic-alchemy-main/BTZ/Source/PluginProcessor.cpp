@@ -3,66 +3,26 @@
 */
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
+#include "DspKernels.h"
 
 namespace {
 static inline float fastTanh(float x) {
     const float x2 = x * x;
     return x * (27.0f + x2) / (27.0f + 9.0f * x2);
 }
+
+// Tape amount (0..1) to the hysteresis drive.
+static inline float tapeDrive(float amount) {
+    return 0.15f + 0.85f * amount;
+}
 }
 
 juce::AudioProcessorValueTreeState::ParameterLayout BTZAudioProcessor::createParameterLayout() {
     std::vector<std::unique_ptr<juce::RangedAudioParameter>> params;
-
-    auto pct = [](const juce::String& id, const juce::String& name, float def) {
-        return std::make_unique<juce::AudioParameterFloat>(
-            juce::ParameterID(id, 1), name,
-            juce::NormalisableRange<float>(0.0f, 1.0f, 0.001f), def);
-    };
-
-    params.push_back(pct("punch", "Punch", 0.18f));
-    params.push_back(pct("warmth", "Warmth", 0.22f));
-    params.push_back(pct("boom", "Boom", 0.10f));
-    params.push_back(pct("glue", "Glue", 0.25f));
-    params.push_back(pct("air", "Air", 0.12f));
-    params.push_back(pct("width", "Width", 0.50f));
-    params.push_back(pct("density", "Density", 0.16f));
-    params.push_back(pct("motion", "Motion", 0.04f));
-
-    params.push_back(std::make_unique<juce::AudioParameterFloat>(
-        juce::ParameterID("vintageModern", 1), "Era",
-        juce::NormalisableRange<float>(-1.0f, 1.0f, 0.01f), 0.0f));
-
-    params.push_back(pct("mix", "Mix", 1.0f));
-    params.push_back(std::make_unique<juce::AudioParameterFloat>(
-        juce::ParameterID("drive", 1), "Drive",
-        juce::NormalisableRange<float>(0.0f, 12.0f, 0.1f), 0.0f));
-
-    params.push_back(std::make_unique<juce::AudioParameterFloat>(
-        juce::ParameterID("sparkCeiling", 1), "TP Ceil",
-        juce::NormalisableRange<float>(-3.0f, 0.0f, 0.01f), -0.3f));
-    params.push_back(pct("sparkMix", "Spark Mix", 1.0f));
-
-    params.push_back(std::make_unique<juce::AudioParameterFloat>(
-        juce::ParameterID("shineAmount", 1), "Shine",
-        juce::NormalisableRange<float>(0.0f, 6.0f, 0.1f), 1.2f));
-    params.push_back(pct("shineMix", "Shine Mix", 0.30f));
-
-    params.push_back(pct("masterIntensity", "Master", 0.42f));
-    params.push_back(pct("autogain", "AutoGain", 1.0f));
-
-    params.push_back(std::make_unique<juce::AudioParameterFloat>(
-        juce::ParameterID("qualityMode", 1), "Quality",
-        juce::NormalisableRange<float>(0.0f, 2.0f, 1.0f), 1.0f));
-
-    params.push_back(std::make_unique<juce::AudioParameterFloat>(
-        juce::ParameterID("stabilityMode", 1), "Character",
-        juce::NormalisableRange<float>(0.0f, 1.0f, 1.0f), 1.0f));
-
-    params.push_back(std::make_unique<juce::AudioParameterFloat>(
-        juce::ParameterID("bypass", 1), "Bypass",
-        juce::NormalisableRange<float>(0.0f, 1.0f, 1.0f), 0.0f));
-
+    for (const auto& p : BTZParams::table)
+        params.push_back(std::make_unique<juce::AudioParameterFloat>(
+            juce::ParameterID(p.id, 1), p.name,
+            juce::NormalisableRange<float>(p.min, p.max, p.step, p.skew), p.defaultValue));
     return { params.begin(), params.end() };
 }
 
@@ -70,141 +30,519 @@ BTZAudioProcessor::BTZAudioProcessor()
     : AudioProcessor(BusesProperties()
                      .withInput("Input", juce::AudioChannelSet::stereo(), true)
                      .withOutput("Output", juce::AudioChannelSet::stereo(), true)),
-      apvts(*this, nullptr, "BTZParams", createParameterLayout()) {}
+      apvts(*this, nullptr, "BTZParams", createParameterLayout()) {
+    for (const auto& p : BTZParams::table) {
+        paramValues[(size_t) p.index] = apvts.getRawParameterValue(p.id);
+        jassert(paramValues[(size_t) p.index] != nullptr);
+    }
+}
+
+BTZAudioProcessor::~BTZAudioProcessor() {
+    stopTimer();
+}
 
 bool BTZAudioProcessor::isBusesLayoutSupported(const BusesLayout& layouts) const {
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    const auto in = layouts.getMainInputChannelSet();
+    const auto out = layouts.getMainOutputChannelSet();
+    if (out != juce::AudioChannelSet::stereo() && out != juce::AudioChannelSet::mono())
         return false;
-    return layouts.getMainInputChannelSet() == layouts.getMainOutputChannelSet();
+    return in == out || (in == juce::AudioChannelSet::mono() && out == juce::AudioChannelSet::stereo());
 }
 
 void BTZAudioProcessor::initSmoothers(double sampleRate) {
-    auto initSmooth = [sampleRate](SmoothParam& s, float ms) { s.setTime(ms, sampleRate); };
-    initSmooth(sPunch, 5.0f);      initSmooth(sWarmth, 6.0f);
-    initSmooth(sBoom, 8.0f);       initSmooth(sGlue, 20.0f);
-    initSmooth(sAir, 6.0f);        initSmooth(sWidth, 20.0f);
-    initSmooth(sDensity, 6.0f);    initSmooth(sMotion, 40.0f);
-    initSmooth(sEra, 25.0f);       initSmooth(sMix, 12.0f);
-    initSmooth(sDrive, 5.0f);      initSmooth(sMaster, 25.0f);
-    initSmooth(sSparkCeil, 5.0f);  initSmooth(sSparkMix, 5.0f);
-    initSmooth(sShine, 5.0f);      initSmooth(sShineMix, 5.0f);
-
-    sPunch.snapTo(*apvts.getRawParameterValue("punch"));
-    sWarmth.snapTo(*apvts.getRawParameterValue("warmth"));
-    sBoom.snapTo(*apvts.getRawParameterValue("boom"));
-    sGlue.snapTo(*apvts.getRawParameterValue("glue"));
-    sAir.snapTo(*apvts.getRawParameterValue("air"));
-    sWidth.snapTo(*apvts.getRawParameterValue("width"));
-    sDensity.snapTo(*apvts.getRawParameterValue("density"));
-    sMotion.snapTo(*apvts.getRawParameterValue("motion"));
-    sEra.snapTo(*apvts.getRawParameterValue("vintageModern"));
-    sMix.snapTo(*apvts.getRawParameterValue("mix"));
-    sDrive.snapTo(*apvts.getRawParameterValue("drive"));
-    sMaster.snapTo(*apvts.getRawParameterValue("masterIntensity"));
-    sSparkCeil.snapTo(*apvts.getRawParameterValue("sparkCeiling"));
-    sSparkMix.snapTo(*apvts.getRawParameterValue("sparkMix"));
-    sShine.snapTo(*apvts.getRawParameterValue("shineAmount"));
-    sShineMix.snapTo(*apvts.getRawParameterValue("shineMix"));
+    // Host-rate smoothers (Mix) run in processBlock; the core ones are timed per path in configureCoreForRate().
+    for (const auto& p : BTZParams::table) {
+        if (p.smoothing == BTZParams::Smoothing::none)
+            continue;
+        if (p.smoothing == BTZParams::Smoothing::host)
+            smoothers[(size_t) p.index].setTime(p.smoothMs, sampleRate);
+        smoothers[(size_t) p.index].snapTo(param(p.index));
+    }
+}
+
+// The core runs at host rate x oversampling factor, so every time constant and
+// filter coefficient is derived from the rate of the active path. This keeps the
+// Eco, HQ and offline render paths sounding the same apart from aliasing.
+void BTZAudioProcessor::configureCoreForRate(double processingRate) {
+    safetyPre.setSampleRate(processingRate);
+    safetyPost.setSampleRate(processingRate);
+    slewL.setSampleRate(processingRate);
+    slewR.setSampleRate(processingRate);
+    peakEnvL.setTimes(0.2f, 220.0f, processingRate);
+    peakEnvR.setTimes(0.2f, 220.0f, processingRate);
+    rmsEnvL.setTimes(25.0f, 300.0f, processingRate);
+    rmsEnvR.setTimes(25.0f, 300.0f, processingRate);
+    const int osFactor = juce::roundToInt(processingRate / currentSampleRate);
+    glueComp.prepare(processingRate, osFactor);
+
+    for (const auto& p : BTZParams::table)
+        if (p.smoothing == BTZParams::Smoothing::core)
+            smoothers[(size_t) p.index].setTime(p.smoothMs, processingRate);
+
+    const float rate = (float) juce::jmax(1.0, processingRate);
+    const float omega = 6.2831853f * 250.0f / rate;
+    xoverCoeff = omega / (1.0f + omega);
+
+    const float sideOmega = 6.2831853f * 120.0f / rate;
+    sideLowCoeff = sideOmega / (1.0f + sideOmega);
+
+    const float sparkAttackMs = 8.0f;
+    const float sparkReleaseMs = 120.0f;
+    sparkAttackCoeff = 1.0f - std::exp(-1.0f / (rate * sparkAttackMs * 0.001f));
+    sparkReleaseCoeff = 1.0f - std::exp(-1.0f / (rate * sparkReleaseMs * 0.001f));
+
+    punchShaper.prepare(processingRate);
+    tape.prepare(processingRate);
+    tape.setParameters(tapeDrive(sTape.current), 0.5f);
+    wowFlutter.prepare(currentSampleRate, osFactor);
+
+    // The air high-pass coefficients were voiced per sample on the default 2x path,
+    // so they are rescaled from twice the prepared host rate to the active rate.
+    airRateScale = (float) (currentSampleRate * 2.0) / rate;
 }
 
 void BTZAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock) {
     currentSampleRate = sampleRate;
-    maxPreparedBlockSize = juce::jmax(samplesPerBlock, 32768);
+    // Everything block-sized follows the host's maximum; larger blocks are split in processBlock().
+    maxPreparedBlockSize = juce::jmax(1, samplesPerBlock);
 
-    safetyPre.setSampleRate(sampleRate);
-    safetyPost.setSampleRate(sampleRate);
     safetyPre.reset();
     safetyPost.reset();
-    slewL.setSampleRate(sampleRate);
-    slewR.setSampleRate(sampleRate);
     slewL.reset();
     slewR.reset();
-    peakEnvL.setTimes(0.2f, 220.0f, sampleRate);
-    peakEnvR.setTimes(0.2f, 220.0f, sampleRate);
-    rmsEnvL.setTimes(25.0f, 300.0f, sampleRate);
-    rmsEnvR.setTimes(25.0f, 300.0f, sampleRate);
-    glueEnv.setTimes(5.0f, 80.0f, sampleRate);
-    glueEnv.reset();
-
-    glueGain = 1.0f;
+    glueComp.reset();
+    resetShapers();
+
     sparkGrEnvelope = 0.0f;
+    meterBallistics.prepare(sampleRate);
     hpStateL = hpStateR = 0.0f;
     sideLowState = 0.0f;
     xoverLowL = xoverLowR = 0.0f;
-    noiseSeed = 12345u;
-
-    const float omega = 6.2831853f * 250.0f / (float) sampleRate;
-    xoverCoeff = omega / (1.0f + omega);
-
-    const float sideOmega = 6.2831853f * 120.0f / (float) sampleRate;
-    sideLowCoeff = sideOmega / (1.0f + sideOmega);
-
-    const float sparkAttackMs = 8.0f;
-    const float sparkReleaseMs = 120.0f;
-    sparkAttackCoeff = 1.0f - std::exp(-1.0f / ((float) sampleRate * sparkAttackMs * 0.001f));
-    sparkReleaseCoeff = 1.0f - std::exp(-1.0f / ((float) sampleRate * sparkReleaseMs * 0.001f));
 
     initSmoothers(sampleRate);
 
     dryBuffer.setSize(2, maxPreparedBlockSize, false, false, true);
     dryBuffer.clear();
-
-    juce::dsp::ProcessSpec spec;
-    spec.sampleRate = sampleRate;
-    spec.maximumBlockSize = (juce::uint32) juce::jmax(1, samplesPerBlock);
-    spec.numChannels = 2;
-
-    os2x = std::make_unique<juce::dsp::Oversampling<float>>(2, 1, juce::dsp::Oversampling<float>::filterHalfBandPolyphaseIIR, true, false);
-    os4x = std::make_unique<juce::dsp::Oversampling<float>>(2, 2, juce::dsp::Oversampling<float>::filterHalfBandPolyphaseIIR, true, false);
-    os2x->initProcessing(spec.maximumBlockSize);
-    os4x->initProcessing(spec.maximumBlockSize);
-    os2x->reset();
-    os4x->reset();
-
-    activeQualityMode = getRequestedQualityMode();
+    mixGains.assign((size_t) maxPreparedBlockSize, 1.0f);
+    mixDry.setSize(2, maxPreparedBlockSize, false, false, true);
+    mixDryPhase.prepare(sampleRate, MultibandTransientShaper::lowMidHz, MultibandTransientShaper::midHighHz);
+    monoWork.setSize(2, maxPreparedBlockSize, false, false, true);
+
+    // Only the engine for the active mode is built now. While rendering offline the
+    // realtime one is built as well, so the return to realtime is immediate.
+    preparedRenderQuality = getRequestedRenderQuality();
+    governor.reset();
+    activeQualityMode = getEffectiveQualityMode();
+    engines.prepare(maxPreparedBlockSize, getRenderStages(), activeQualityMode);
+    if (activeQualityMode == renderQualityMode)
+        engines.build(getRequestedQualityMode());
+
+    limiter.prepare(sampleRate);
+    wowFlutter.allocate(sampleRate * (preparedRenderQuality > 0 ? getOversamplingFactor(renderQualityMode) : 4));
+    motionDelaySamples = WowFlutter::getCentreDelaySamples(sampleRate);
+    sidechain.prepare(sampleRate, maxPreparedBlockSize);
+    gate.prepare(sampleRate, maxPreparedBlockSize);
+    gateLookaheadSamples = GateProcessor::getLookaheadSamples(sampleRate);
+
+    // Sized for the highest anti-alias order with the gate lookahead and Motion delay
+    // in, which the user can pick after prepare. Latency changes while playing
+    // crossfade the dry tap.
+    applyLatencyStages(true, true);
+    int maxLatency = 0;
+    for (int mode = 0; mode <= renderQualityMode; ++mode)
+        maxLatency = juce::jmax(maxLatency, getPathLatency(mode) - getShaperDelay(mode, getShaperOrder(mode))
+                                                + getShaperDelay(mode, AdaaTanh4::second));
+    for (auto* d : { &wetPadL, &wetPadR, &dryDelayL, &dryDelayR })
+        d->prepare(maxLatency, juce::roundToInt(0.01 * sampleRate));
+    applyLatencyStages(wantsGateLookahead(), wantsMotionDelay());
+
+    modeFade.setTime(10.0f, sampleRate);
+    modeFade.reset();
+    dualMono.setTime(50.0f, 10.0f, sampleRate);
+    dualMono.reset();
+    motionRestSamples = 0;
+    motionSettleSamples = juce::roundToInt(6.0 * BTZParams::spec(BTZParams::motion).smoothMs * 0.001 * sampleRate);
+
+    configureCoreForRate(sampleRate * getOversamplingFactor(activeQualityMode));
     updateLatencyFromQuality(activeQualityMode);
+
+    room.prepare(sampleRate, maxPreparedBlockSize);
+    match.prepare(sampleRate, maxPreparedBlockSize);
+    boomSub.prepare(sampleRate);
+    texture.prepare(sampleRate);
+    analysis.prepare(sampleRate);
+    pipelineReady.store(false, std::memory_order_release);
+    if (isNonRealtime())
+        preparePipeline();
+    startTimer(200);
 }
 
 void BTZAudioProcessor::releaseResources() {
+    stopTimer();
+    analysis.release();
+    match.release();
+    engines.release();
     dryBuffer.setSize(0, 0);
+    mixDry.setSize(0, 0);
+    monoWork.setSize(0, 0);
+    std::vector<float>().swap(mixGains);
+    releasePipeline();
+}
+
+// Offline bounces switch to the render engine, built here (off the audio thread)
+// so the first rendered block already uses it; the render pipeline is set up here
+// for the same reason. Its workers sleep between bounces until releaseResources().
+// The callback lock keeps processBlock() out while the slots and workers change.
+// This is noexcept: if anything fails to allocate or spawn, the engine that is
+// running stays and the bounce runs serially.
+void BTZAudioProcessor::setNonRealtime(bool isNonRealtime) noexcept {
+    juce::AudioProcessor::setNonRealtime(isNonRealtime);
+    if (maxPreparedBlockSize <= 0)
+        return;
+    const juce::ScopedLock sl(getCallbackLock());
+    try {
+        engines.build(isNonRealtime && preparedRenderQuality > 0 ? renderQualityMode : getRequestedQualityMode());
+        if (! isNonRealtime)
+            pipelineReady.store(false, std::memory_order_release);
+        else if (! pipelineReady.load(std::memory_order_acquire))
+            preparePipeline();
+    } catch (...) {
+        releasePipeline();
+    }
+}
+
+void BTZAudioProcessor::setRenderPipelineWorkers(int numWorkers) {
+    const juce::ScopedLock sl(getCallbackLock());
+    pipelineWorkers = numWorkers;
+    pipelineReady.store(false, std::memory_order_release);
+    if (isNonRealtime())
+        preparePipeline();
+}
+
+// Only with the option on, so realtime-only sessions never hold the slots or threads.
+void BTZAudioProcessor::preparePipeline() {
+    if (maxPreparedBlockSize <= 0 || param(BTZParams::renderPipeline) <= 0.5f)
+        return;
+
+    const int unitSamples = juce::jmin(pipelineUnitSamples, maxPreparedBlockSize);
+    const int maxFactor = preparedRenderQuality > 0 ? getOversamplingFactor(renderQualityMode) : 4;
+    for (auto& slot : pipelineSlots) {
+        slot.dry.setSize(2, unitSamples, false, false, true);
+        slot.core.setSize(2, unitSamples * maxFactor, false, false, true);
+    }
+
+    // The calling thread works too, so one stage per thread needs numPipelineStages - 1 workers.
+    const int cores = (int) std::thread::hardware_concurrency();
+    const int workers = pipelineWorkers >= 0 ? pipelineWorkers : juce::jlimit(0, numPipelineStages - 1, cores - 1);
+    pipeline.prepare(numPipelineStages, pipelineSlotCount, workers);
+    pipelineReady.store(true, std::memory_order_release);
+}
+
+void BTZAudioProcessor::releasePipeline() {
+    pipelineReady.store(false, std::memory_order_release);
+    pipeline.release();
+    for (auto& slot : pipelineSlots) {
+        slot.dry.setSize(0, 0);
+        slot.core.setSize(0, 0);
+    }
+}
+
+void BTZAudioProcessor::timerCallback() {
+    engines.service();
+    // With the governor on, the engine one tier down is kept ready so a step down never waits for a build.
+    const int standby = getStandbyQualityMode(meters.qualityMode.load(std::memory_order_relaxed));
+    if (standby > 0)
+        engines.build(standby);
+}
+
+BTZMemoryReport BTZAudioProcessor::getMemoryReport() const {
+    const auto bufferBytes = [](const juce::AudioBuffer<float>& b) {
+        return (size_t) (b.getNumChannels() * b.getNumSamples()) * sizeof(float);
+    };
+
+    size_t pipelineBytes = 0;
+    for (const auto& slot : pipelineSlots)
+        pipelineBytes += bufferBytes(slot.dry) + bufferBytes(slot.core);
+
+    BTZMemoryReport report;
+    report.items = {
+        { "block buffers", bufferBytes(dryBuffer) + bufferBytes(mixDry) + bufferBytes(monoWork) + mixGains.size() * sizeof(float) },
+        { "oversamplers", engines.getMemoryBytes() },
+        { "latency pads", wetPadL.getMemoryBytes() + wetPadR.getMemoryBytes()
+                          + dryDelayL.getMemoryBytes() + dryDelayR.getMemoryBytes() },
+        { "sidechain + gate", sidechain.getMemoryBytes() + gate.getMemoryBytes() },
+        { "motion", wowFlutter.getMemoryBytes() },
+        { "texture", texture.getMemoryBytes() },
+        { "room", room.getMemoryBytes() },
+        { "match", match.getMemoryBytes() },
+        { "limiter", limiter.getMemoryBytes() },
+        { "analysis", analysis.getMemoryBytes() },
+        { "render pipeline", pipelineBytes },
+    };
+    return report;
 }
 
 int BTZAudioProcessor::getRequestedQualityMode() const {
-    const float quality = apvts.getRawParameterValue("qualityMode")->load(std::memory_order_relaxed);
+    const float quality = param(BTZParams::qualityMode);
     return (int) juce::jlimit(0.0f, 2.0f, quality);
 }
 
+int BTZAudioProcessor::getRequestedRenderQuality() const {
+    const float render = param(BTZParams::renderQuality);
+    return (int) juce::jlimit(0.0f, 2.0f, render);
+}
+
+int BTZAudioProcessor::getEffectiveQualityMode() const {
+    if (isNonRealtime() && preparedRenderQuality > 0 && getRequestedRenderQuality() > 0)
+        return renderQualityMode;
+    // The governor's cap is at the top whenever it is off.
+    return juce::jmin(getRequestedQualityMode(), governor.cap);
+}
+
+int BTZAudioProcessor::getStandbyQualityMode(int mode) const {
+    const bool governed = param(BTZParams::qualityGovernor) > 0.5f;
+    return governed && mode >= 1 && mode < renderQualityMode ? mode - 1 : -1;
+}
+
+int BTZAudioProcessor::getOversamplingFactor(int mode) const {
+    if (mode == renderQualityMode)
+        return preparedRenderQuality >= 2 ? 16 : 8;
+    return mode == 1 ? 2 : (mode >= 2 ? 4 : 1);
+}
+
+int BTZAudioProcessor::getRenderStages() const {
+    return preparedRenderQuality > 0 ? (preparedRenderQuality >= 2 ? 4 : 3) : 0;
+}
+
+int BTZAudioProcessor::getPathLatency(int mode) const {
+    // Engine latencies are known without building the engine. The gate lookahead and
+    // the Motion delay centre, while switched in, add the same latency to every path.
+    return QualityEngines::getLatency(mode, getRenderStages()) + getShaperDelay(mode, getShaperOrder(mode))
+         + (gateLookaheadOn ? gateLookaheadSamples : 0) + (motionDelayOn ? motionDelaySamples : 0);
+}
+
+// Each of the four core shapers delays its blend by half a core sample per order,
+// rounded to the nearest host sample.
+int BTZAudioProcessor::getShaperDelay(int mode, int order) const {
+    constexpr int numShapers = 4;
+    const int osFactor = getOversamplingFactor(mode);
+    return (numShapers * order + osFactor) / (2 * osFactor);
+}
+
+int BTZAudioProcessor::getShaperOrder(int mode) const {
+    const int setting = (int) juce::jlimit(0.0f, 3.0f, param(BTZParams::antiAlias));
+    if (setting > 0)
+        return setting - 1;
+    return mode == 0 ? AdaaTanh4::second : (mode == 1 ? AdaaTanh4::first : AdaaTanh4::off);
+}
+
+void BTZAudioProcessor::configureTapeSolver(int mode) {
+    const int setting = (int) juce::jlimit(0.0f, 4.0f, param(BTZParams::tapeSolver));
+    if (setting == 0) {
+        if (mode == renderQualityMode)
+            tape.setSolver(TapeHysteresis::newtonRaphson, 8);
+        else
+            tape.setSolver(mode >= 2 ? TapeHysteresis::rk4 : TapeHysteresis::rk2);
+    } else {
+        tape.setSolver(setting == 1 ? TapeHysteresis::rk2 : (setting == 2 ? TapeHysteresis::rk4 : TapeHysteresis::newtonRaphson),
+                       setting == 4 ? 8 : 4);
+    }
+    tape.setUseTable(mode == 0);
+}
+
+void BTZAudioProcessor::configureMotionInterpolation(int mode) {
+    const int setting = (int) juce::jlimit(0.0f, 3.0f, param(BTZParams::motionInterp));
+    if (setting == 0)
+        wowFlutter.setInterpolation(mode == 0 ? WowFlutter::thiran : WowFlutter::lagrange3);
+    else
+        wowFlutter.setInterpolation(setting == 1 ? WowFlutter::linear : (setting == 2 ? WowFlutter::lagrange3 : WowFlutter::thiran));
+}
+
+void BTZAudioProcessor::resetShapers() {
+    adaaPre.reset();
+    adaaXover.reset();
+    adaaPunch.reset();
+    adaaDensity.reset();
+}
+
+void BTZAudioProcessor::switchQualityMode(int mode) {
+    activeQualityMode = mode;
+    if (auto* os = engines.get(mode))
+        os->reset();
+    resetShapers();
+    configureCoreForRate(currentSampleRate * getOversamplingFactor(mode));
+    updateLatencyFromQuality(mode);
+}
+
+// With render quality enabled the dry/wet aligned latency is the worse of the realtime
+// and render paths, and the faster path is padded, so tracking and bounces line up.
+// A mode the governor has stepped down to is padded to the selected one, so the
+// reported latency never moves under CPU pressure.
+int BTZAudioProcessor::getAlignedLatency(int mode) const {
+    const int aligned = juce::jmax(getPathLatency(mode), getPathLatency(getRequestedQualityMode()));
+    if (preparedRenderQuality > 0)
+        return juce::jmax(aligned, getPathLatency(renderQualityMode));
+    return aligned;
+}
+
+// The limiter runs after the mix on the summed signal, so its lookahead adds on top.
+int BTZAudioProcessor::getReportedLatency(int mode) const {
+    return getAlignedLatency(mode) + (isLimiterLatencyActive() ? limiter.getLatencySamples() : 0);
+}
+
+// Bypass does not count: a bypassed limiter keeps its delay so bypassing never moves the latency.
+bool BTZAudioProcessor::isLimiterLatencyActive() const {
+    return param(BTZParams::fixedLatency) > 0.5f || param(BTZParams::limiter) > 0.0f;
+}
+
+// The gate lookahead and the Motion centre delay are only in the path while their
+// stage is in use, or always with Fixed Latency.
+bool BTZAudioProcessor::wantsGateLookahead() const {
+    return param(BTZParams::fixedLatency) > 0.5f || param(BTZParams::gateRange) > 0.0f;
+}
+
+bool BTZAudioProcessor::wantsMotionDelay() const {
+    return param(BTZParams::fixedLatency) > 0.5f || param(BTZParams::motion) > 0.0f;
+}
+
+bool BTZAudioProcessor::latencyStagesPending() const {
+    return wantsGateLookahead() != gateLookaheadOn || wantsMotionDelay() != motionDelayOn;
+}
+
+void BTZAudioProcessor::applyLatencyStages(bool gateLookahead, bool motionDelay) {
+    gateLookaheadOn = gateLookahead;
+    motionDelayOn = motionDelay;
+    gate.setLookaheadEnabled(gateLookahead);
+    wowFlutter.setCentreEnabled(motionDelay);
+}
+
 void BTZAudioProcessor::updateLatencyFromQuality(int mode) {
-    int latency = 0;
-    if (mode == 1 && os2x != nullptr)
-        latency = (int) std::ceil(os2x->getLatencyInSamples());
-    else if (mode >= 2 && os4x != nullptr)
-        latency = (int) std::ceil(os4x->getLatencyInSamples());
+    const int pathLatency = getPathLatency(mode);
+    const int aligned = getAlignedLatency(mode);
+    const int latency = getReportedLatency(mode);
+
+    wetPadL.setDelay(aligned - pathLatency);
+    wetPadR.setDelay(aligned - pathLatency);
+    dryDelayL.setDelay(aligned);
+    dryDelayR.setDelay(aligned);
 
     if (latency != getLatencySamples())
         setLatencySamples(latency);
 }
 
-void BTZAudioProcessor::updateTargetsFromAPVTS() {
-    sPunch.setTarget(*apvts.getRawParameterValue("punch"));
-    sWarmth.setTarget(*apvts.getRawParameterValue("warmth"));
-    sBoom.setTarget(*apvts.getRawParameterValue("boom"));
-    sGlue.setTarget(*apvts.getRawParameterValue("glue"));
-    sAir.setTarget(*apvts.getRawParameterValue("air"));
-    sWidth.setTarget(*apvts.getRawParameterValue("width"));
-    sDensity.setTarget(*apvts.getRawParameterValue("density"));
-    sMotion.setTarget(*apvts.getRawParameterValue("motion"));
-    sEra.setTarget(*apvts.getRawParameterValue("vintageModern"));
-    sMix.setTarget(*apvts.getRawParameterValue("mix"));
-    sDrive.setTarget(*apvts.getRawParameterValue("drive"));
-    sMaster.setTarget(*apvts.getRawParameterValue("masterIntensity"));
-    sSparkCeil.setTarget(*apvts.getRawParameterValue("sparkCeiling"));
-    sSparkMix.setTarget(*apvts.getRawParameterValue("sparkMix"));
-    sShine.setTarget(*apvts.getRawParameterValue("shineAmount"));
-    sShineMix.setTarget(*apvts.getRawParameterValue("shineMix"));
-}
-
-void BTZAudioProcessor::processCore(float* dataL, float* dataR, int numSamples, float osFactor) {
+// Targets are set by the stage that consumes them, once per block; the adaptive
+// offsets come from the analysis worker's features read in beginStages().
+void BTZAudioProcessor::updateInputTargets() {
+    sidechain.setGateBandPass(param(BTZParams::gateKey));
+    gate.setParameters(param(BTZParams::gateThreshold), param(BTZParams::gateRange), param(BTZParams::gateAttack),
+                       param(BTZParams::gateHold), param(BTZParams::gateRelease));
+}
+
+void BTZAudioProcessor::updateCoreTargets(const AdaptiveBias& bias) {
+    for (const auto& p : BTZParams::table)
+        if (p.smoothing == BTZParams::Smoothing::core)
+            smoothers[(size_t) p.index].setTarget(param(p.index));
+
+    sPunch.setTarget(juce::jlimit(0.0f, 1.0f, param(BTZParams::punch) + bias.punch));
+    sBoom.setTarget(juce::jlimit(0.0f, 1.0f, param(BTZParams::boom) + bias.boom));
+    sGlue.setTarget(juce::jlimit(0.0f, 1.0f, param(BTZParams::glue) + bias.glue));
+    glueComp.setLink(param(BTZParams::glueLink));
+    glueComp.setSidechainHighPass(param(BTZParams::glueScHpf));
+}
+
+void BTZAudioProcessor::updateOutputTargets(const AdaptiveBias& bias) {
+    for (const auto& p : BTZParams::table)
+        if (p.smoothing == BTZParams::Smoothing::host)
+            smoothers[(size_t) p.index].setTarget(param(p.index));
+
+    boomAmount = juce::jlimit(0.0f, 1.0f, param(BTZParams::boom) + bias.boom);
+}
+
+// A stage is skipped for a block only when its smoother cannot cross the
+// per-sample threshold anywhere in the block: SmoothParam moves monotonically
+// from current to target, so the larger of the two bounds every value, and the
+// master scale is bounded the same way. Skipped stages give the same output as
+// the per-sample checks in the generic kernel.
+unsigned BTZAudioProcessor::getSkippableStages() const {
+    auto upper = [](const SmoothParam& p) { return juce::jmax(p.current, p.target); };
+    const float masterScale = juce::jlimit(0.25f, 1.25f, 0.7f + upper(sMaster) * 0.6f);
+
+    unsigned skipped = 0;
+    if (upper(sDrive) <= 0.0f)
+        skipped |= stageDrive;
+    if (upper(sWarmth) <= 0.0f)
+        skipped |= stageWarmth;
+    if (upper(sWarmth) <= 0.0f && upper(sDensity) <= 0.0f)
+        skipped |= stageSaturation;
+    if (upper(sTape) <= 0.001f)
+        skipped |= stageTape;
+    if (upper(sPunch) * masterScale * 0.25f <= 0.0005f)
+        skipped |= stageHarmonics;
+    if (upper(sGlue) * masterScale <= 0.01f)
+        skipped |= stageGlue;
+    if (upper(sAir) * masterScale + upper(sShine) * upper(sShineMix) * 0.15f <= 0.001f)
+        skipped |= stageAir;
+    if (upper(sBoom) * masterScale <= 0.01f)
+        skipped |= stageBoom;
+    if (upper(sDensity) * masterScale <= 0.001f)
+        skipped |= stageDensity;
+    if (upper(sMotion) <= 0.01f)
+        skipped |= stageMotion;
+    return skipped;
+}
+
+// Kernels exist for a few stage sets, most skipped first: everything off, the
+// default preset's (Drive and Tape at zero) with and without Motion, and the
+// generic kernel, which keeps every per-sample check and takes any other mix.
+// There is no oversampling-factor dimension: nothing in the per-sample loop reads
+// the factor (rates are folded into coefficients when the core is configured, and
+// Glue counts its own control interval), so per-factor copies would be identical.
+template <bool singleLane>
+void BTZAudioProcessor::dispatchCore(const StageBlock& block, unsigned skipped) {
+    constexpr unsigned defaultOff = stageDrive | stageTape;
+    constexpr unsigned defaultStill = defaultOff | stageMotion;
+
+    if ((skipped & allCoreStages) == allCoreStages)
+        processCore<singleLane, allCoreStages>(block);
+    else if ((skipped & defaultStill) == defaultStill)
+        processCore<singleLane, defaultStill>(block);
+    else if ((skipped & defaultOff) == defaultOff)
+        processCore<singleLane, defaultOff>(block);
+    else
+        processCore<singleLane, 0u>(block);
+}
+
+// coreR == nullptr runs the single-lane kernel, which the input stage only picks
+// while Motion is at rest.
+void BTZAudioProcessor::runCore(const StageBlock& block) {
+    const unsigned skipped = getSkippableStages();
+    if (block.coreR == nullptr)
+        dispatchCore<true>(block, skipped | stageMotion);
+    else
+        dispatchCore<false>(block, skipped);
+}
+
+// Stages in `skipped` are compiled out; the rest keep their per-sample threshold checks.
+template <bool singleLane, unsigned skipped>
+void BTZAudioProcessor::processCore(const StageBlock& block) {
+    constexpr bool runDrive = (skipped & stageDrive) == 0;
+    constexpr bool runWarmth = (skipped & stageWarmth) == 0;
+    constexpr bool runSaturation = (skipped & stageSaturation) == 0;
+    constexpr bool runTape = (skipped & stageTape) == 0;
+    constexpr bool runHarmonics = (skipped & stageHarmonics) == 0;
+    constexpr bool runGlue = (skipped & stageGlue) == 0;
+    constexpr bool runAir = (skipped & stageAir) == 0;
+    constexpr bool runBoom = (skipped & stageBoom) == 0;
+    constexpr bool runDensity = (skipped & stageDensity) == 0;
+    constexpr bool runMotion = (skipped & stageMotion) == 0;
+
+    if constexpr (! runGlue)
+        glueComp.setThresholdAndRatio(-8.0f, 1.0f);
+
+    float* dataL = block.coreL;
+    float* dataR = block.coreR;
+    const int numSamples = block.coreSamples;
+
     for (int n = 0; n < numSamples; ++n) {
         float punch = sPunch.next();
         float warmth = sWarmth.next();
@@ -215,21 +553,23 @@ void BTZAudioProcessor::processCore(float* dataL, float* dataR, int numSamples,
         float density = sDensity.next();
         float motion = sMotion.next();
         float era = sEra.next();
-        float mix = sMix.next();
         float drive = sDrive.next();
         float master = sMaster.next();
         float ceilDb = sSparkCeil.next();
         float sparkMix = sSparkMix.next();
         float shine = sShine.next();
         float shineMix = sShineMix.next();
+        const float tapeAmt = sTape.next();
 
+        // Single lane: the right lane sees the same input, so the SIMD-paired stages
+        // keep its state current at no extra cost.
         float L = dataL[n];
-        float R = dataR[n];
+        float R = singleLane ? L : dataR[n];
 
         L = safetyPre.processSample(L, safetyPre.dcL, safetyPre.dcPrevL);
         R = safetyPre.processSample(R, safetyPre.dcR, safetyPre.dcPrevR);
 
-        if (drive > 0.0f) {
+        if (runDrive && drive > 0.0f) {
             const float inGain = std::pow(10.0f, drive / 20.0f);
             L *= inGain;
             R *= inGain;
@@ -239,24 +579,41 @@ void BTZAudioProcessor::processCore(float* dataL, float* dataR, int numSamples,
         punch *= masterScale; warmth *= masterScale; boom *= masterScale;
         glue *= masterScale; air *= masterScale; density *= masterScale;
 
-        {
+        if constexpr (runWarmth) {
             const float drv = 1.0f + warmth * 2.8f;
             const float bias = warmth * 0.05f;
             const float eraScale = juce::jmax(0.55f, 1.0f + era * 0.30f);
 
-            auto preamp = [&](float x) {
-                const float xb = x + bias;
-                float y = fastTanh(xb * drv / eraScale);
-                y -= fastTanh(bias * drv / eraScale);
-                return x + (y - x) * warmth;
-            };
-            L = preamp(L);
-            R = preamp(R);
+            const float k = drv / eraScale;
+            const float offset = fastTanh(bias * k);
+            float shaped[4], dry[4];
+            adaaPre.alignDry(Vec4::set(L, R, 0.0f, 0.0f), adaaOrder).store(dry);
+            adaaPre.process(Vec4::set((L + bias) * k, (R + bias) * k, 0.0f, 0.0f), adaaOrder).store(shaped);
+            L = dry[0] + (shaped[0] - offset - dry[0]) * warmth;
+            R = dry[1] + (shaped[1] - offset - dry[1]) * warmth;
+        } else {
+            const float k = 1.0f / juce::jmax(0.55f, 1.0f + era * 0.30f);
+            float dry[4];
+            adaaPre.alignDry(Vec4::set(L, R, 0.0f, 0.0f), adaaOrder).store(dry);
+            adaaPre.skip(Vec4::set(L * k, R * k, 0.0f, 0.0f));
+            L = dry[0];
+            R = dry[1];
         }
 
         L = slewL.process(L);
         R = slewR.process(R);
 
+        if (runTape && tapeAmt > 0.001f) {
+            // The drive follows the smoothed amount, so automation never steps it.
+            tape.setDrive(tapeDrive(tapeAmt));
+            float tL = L, tR = R;
+            tape.process(tL, tR);
+            L += (tL - L) * tapeAmt;
+            R += (tR - R) * tapeAmt;
+        } else {
+            tape.skip(L, R);
+        }
+
         {
             xoverLowL += xoverCoeff * (L - xoverLowL);
             xoverLowR += xoverCoeff * (R - xoverLowR);
@@ -267,50 +624,61 @@ void BTZAudioProcessor::processCore(float* dataL, float* dataR, int numSamples,
             const float highDrv = 1.0f + warmth * 1.75f;
             const float satAmt = juce::jlimit(0.0f, 1.0f, warmth * 0.65f + density * 0.35f);
 
-            const float satLowL = fastTanh(xoverLowL * lowDrv) / lowDrv;
-            const float satLowR = fastTanh(xoverLowR * lowDrv) / lowDrv;
-            const float satHiL = fastTanh(highL * highDrv) / highDrv;
-            const float satHiR = fastTanh(highR * highDrv) / highDrv;
-
-            L = xoverLowL + (satLowL - xoverLowL) * satAmt + highL + (satHiL - highL) * satAmt;
-            R = xoverLowR + (satLowR - xoverLowR) * satAmt + highR + (satHiR - highR) * satAmt;
+            const Vec4 satIn = Vec4::set(xoverLowL * lowDrv, xoverLowR * lowDrv, highL * highDrv, highR * highDrv);
+            float dry[4];
+            adaaXover.alignDry(Vec4::set(xoverLowL, xoverLowR, highL, highR), adaaOrder).store(dry);
+            if constexpr (runSaturation) {
+                float sat[4];
+                adaaXover.process(satIn, adaaOrder).store(sat);
+                const float satLowL = sat[0] / lowDrv;
+                const float satLowR = sat[1] / lowDrv;
+                const float satHiL = sat[2] / highDrv;
+                const float satHiR = sat[3] / highDrv;
+
+                L = dry[0] + (satLowL - dry[0]) * satAmt + dry[2] + (satHiL - dry[2]) * satAmt;
+                R = dry[1] + (satLowR - dry[1]) * satAmt + dry[3] + (satHiR - dry[3]) * satAmt;
+            } else {
+                adaaXover.skip(satIn);
+                juce::ignoreUnused(satAmt);
+                L = dry[0] + dry[2];
+                R = dry[1] + dry[3];
+            }
         }
 
+        punchShaper.process(L, R, punch);
+
         {
+            // The envelopes run either way so re-enabling the stage is seamless.
             const float peakL = peakEnvL.process(std::abs(L));
-            const float rmsL = std::sqrt(rmsEnvL.process(L * L) + 1.0e-12f);
-            const float crest = peakL / juce::jmax(1.0e-5f, rmsL);
-            const float harmonicBias = juce::jlimit(0.8f, 1.3f, 1.0f + (crest - 3.0f) * 0.06f);
+            const float rmsSqL = rmsEnvL.process(L * L);
             const float amount = punch * 0.25f;
-            if (amount > 0.0005f) {
-                const float drv = 1.0f + punch * 2.0f;
-                const float oddL = fastTanh(drv * L);
-                const float evenL = fastTanh(drv * L + 0.25f) - fastTanh(0.25f);
-                const float oddR = fastTanh(drv * R);
-                const float evenR = fastTanh(drv * R + 0.25f) - fastTanh(0.25f);
+            const float drv = 1.0f + punch * 2.0f;
+            const Vec4 punchIn = Vec4::set(drv * L, drv * R, drv * L + 0.25f, drv * R + 0.25f);
+            float dry[4];
+            adaaPunch.alignDry(Vec4::set(L, R, 0.0f, 0.0f), adaaOrder).store(dry);
+            L = dry[0];
+            R = dry[1];
+            if (runHarmonics && amount > 0.0005f) {
+                const float rmsL = std::sqrt(rmsSqL + 1.0e-12f);
+                const float crest = peakL / juce::jmax(1.0e-5f, rmsL);
+                const float harmonicBias = juce::jlimit(0.8f, 1.3f, 1.0f + (crest - 3.0f) * 0.06f);
+                float h[4];
+                adaaPunch.process(punchIn, adaaOrder).store(h);
+                const float evenOffset = fastTanh(0.25f);
+                const float oddL = h[0], oddR = h[1];
+                const float evenL = h[2] - evenOffset;
+                const float evenR = h[3] - evenOffset;
                 L = L + ((oddL * harmonicBias + evenL * (2.0f - harmonicBias)) - L) * amount;
                 R = R + ((oddR * harmonicBias + evenR * (2.0f - harmonicBias)) - R) * amount;
+            } else {
+                adaaPunch.skip(punchIn);
             }
         }
 
-        if (glue > 0.01f) {
-            const float threshold = juce::Decibels::decibelsToGain(-8.0f - glue * 10.0f);
-            const float ratio = 2.0f + glue * 5.0f;
-            const float sidechain = juce::jmax(std::abs(L), std::abs(R));
-            const float envVal = glueEnv.process(sidechain);
-
-            float gainReduction = 1.0f;
-            if (envVal > threshold) {
-                const float overDb = juce::Decibels::gainToDecibels(envVal / threshold, -100.0f);
-                const float reducedDb = overDb * (1.0f - 1.0f / ratio);
-                gainReduction = juce::Decibels::decibelsToGain(-reducedDb);
-            }
-
-            const float smoothCoeff = gainReduction < glueGain ? 0.02f : 0.002f;
-            glueGain += smoothCoeff * (gainReduction - glueGain);
-            L *= glueGain;
-            R *= glueGain;
-        }
+        // Below the Glue threshold the ratio relaxes to 1:1 so the gain releases smoothly.
+        if constexpr (runGlue)
+            glueComp.setThresholdAndRatio(-8.0f - glue * 10.0f, glue > 0.01f ? 2.0f + glue * 5.0f : 1.0f);
+        glueComp.process(L, R);
 
         {
             const float mid = 0.5f * (L + R);
@@ -327,10 +695,11 @@ void BTZAudioProcessor::processCore(float* dataL, float* dataR, int numSamples,
             R = mid - sideOut;
         }
 
-        {
+        if constexpr (runAir) {
             const float airAmount = air + shine * shineMix * 0.15f;
             if (airAmount > 0.001f) {
-                const float hpCoeff = juce::jlimit(0.70f, 0.995f, 0.95f - airAmount * 0.12f);
+                const float baseCoeff = juce::jlimit(0.70f, 0.995f, 0.95f - airAmount * 0.12f);
+                const float hpCoeff = juce::jmax(0.0f, 1.0f - (1.0f - baseCoeff) * airRateScale);
                 const float hfL = L - hpStateL; hpStateL = L * (1.0f - hpCoeff) + hpStateL * hpCoeff;
                 const float hfR = R - hpStateR; hpStateR = R * (1.0f - hpCoeff) + hpStateR * hpCoeff;
                 L += hfL * airAmount * 0.45f;
@@ -338,15 +707,26 @@ void BTZAudioProcessor::processCore(float* dataL, float* dataR, int numSamples,
             }
         }
 
-        if (boom > 0.01f) {
+        if (runBoom && boom > 0.01f) {
             L += xoverLowL * boom * 0.28f;
             R += xoverLowR * boom * 0.28f;
         }
 
-        if (density > 0.001f) {
+        {
             const float drv = 1.0f + density * 3.0f;
-            L = fastTanh(L * drv) / drv;
-            R = fastTanh(R * drv) / drv;
+            const Vec4 densityIn = Vec4::set(L * drv, R * drv, 0.0f, 0.0f);
+            float dry[4];
+            adaaDensity.alignDry(Vec4::set(L, R, 0.0f, 0.0f), adaaOrder).store(dry);
+            if (runDensity && density > 0.001f) {
+                float d[4];
+                adaaDensity.process(densityIn, adaaOrder).store(d);
+                L = d[0] / drv;
+                R = d[1] / drv;
+            } else {
+                adaaDensity.skip(densityIn);
+                L = dry[0];
+                R = dry[1];
+            }
         }
 
         float sparkGrInst = 0.0f;
@@ -369,14 +749,15 @@ void BTZAudioProcessor::processCore(float* dataL, float* dataR, int numSamples,
         const float sparkCoeff = sparkGrInst > sparkGrEnvelope ? sparkAttackCoeff : sparkReleaseCoeff;
         sparkGrEnvelope += sparkCoeff * (sparkGrInst - sparkGrEnvelope);
 
-        if (motion > 0.01f) {
-            noiseSeed = 1664525u * noiseSeed + 1013904223u;
-            float white = (float) ((noiseSeed >> 9) & 0x7FFFFF) / 8388608.0f - 0.5f;
-            const float noiseLevel = 1.0e-6f * motion * 8.0f / juce::jmax(1.0f, osFactor);
-            L += white * noiseLevel;
-            noiseSeed = 1664525u * noiseSeed + 1013904223u;
-            white = (float) ((noiseSeed >> 9) & 0x7FFFFF) / 8388608.0f - 0.5f;
-            R += white * noiseLevel;
+        if constexpr (singleLane) {
+            jassert(motion <= 0.01f);
+            wowFlutter.processMonoStill(L);
+            R = L;
+        } else {
+            if constexpr (runMotion)
+                wowFlutter.process(L, R, motion);
+            else
+                wowFlutter.processStill(L, R);
         }
 
         L = safetyPost.processSample(L, safetyPost.dcL, safetyPost.dcPrevL);
@@ -386,171 +767,459 @@ void BTZAudioProcessor::processCore(float* dataL, float* dataR, int numSamples,
         L *= neutralComp;
         R *= neutralComp;
 
-        if (n < maxPreparedBlockSize) {
-            const float dryL = dryBuffer.getSample(0, n);
-            const float dryR = dryBuffer.getSample(1, n);
-            L = dryL + (L - dryL) * mix;
-            R = dryR + (R - dryR) * mix;
-        }
-
         dataL[n] = L;
-        dataR[n] = R;
+        if constexpr (! singleLane)
+            dataR[n] = R;
     }
 }
 
 void BTZAudioProcessor::updateMeters(const float* inL, const float* inR, const float* outL, const float* outR, int n, float sparkGRDb) {
-    float inPkL = 0.0f, inPkR = 0.0f, outPkL = 0.0f, outPkR = 0.0f;
-    float inSqL = 0.0f, inSqR = 0.0f, outSqL = 0.0f, outSqR = 0.0f;
-    float corrNum = 0.0f, corrDenL = 0.0f, corrDenR = 0.0f;
-    float lufsSq = 0.0f;
-    bool clipIn = false, clipOut = false;
-
-    for (int i = 0; i < n; ++i) {
-        const float iL = inL[i], iR = inR[i], oL = outL[i], oR = outR[i];
-        inPkL = juce::jmax(inPkL, std::abs(iL));
-        inPkR = juce::jmax(inPkR, std::abs(iR));
-        outPkL = juce::jmax(outPkL, std::abs(oL));
-        outPkR = juce::jmax(outPkR, std::abs(oR));
-        inSqL += iL * iL; inSqR += iR * iR;
-        outSqL += oL * oL; outSqR += oR * oR;
-        corrNum += oL * oR;
-        corrDenL += oL * oL;
-        corrDenR += oR * oR;
-        lufsSq += oL * oL + oR * oR;
-        clipIn = clipIn || (std::abs(iL) >= 0.999f || std::abs(iR) >= 0.999f);
-        clipOut = clipOut || (std::abs(oL) >= 0.999f || std::abs(oR) >= 0.999f);
-    }
+    auto& mb = meterBallistics;
+    mb.setBlockLength(n);
+
+    MeterSums sums;
+    const float* streams[4] = { inL, inR, outL, outR };
+    DspKernels::get().meter(streams, n, 0.999f, sums);
 
     const float invN = 1.0f / juce::jmax(1, n);
-    const float inRmsL = std::sqrt(inSqL * invN + 1.0e-20f);
-    const float inRmsR = std::sqrt(inSqR * invN + 1.0e-20f);
-    const float outRmsL = std::sqrt(outSqL * invN + 1.0e-20f);
-    const float outRmsR = std::sqrt(outSqR * invN + 1.0e-20f);
-
-    meterBallistics.inPeakHoldL = juce::jmax(inPkL, meterBallistics.inPeakHoldL * meterBallistics.holdDecay);
-    meterBallistics.inPeakHoldR = juce::jmax(inPkR, meterBallistics.inPeakHoldR * meterBallistics.holdDecay);
-    meterBallistics.outPeakHoldL = juce::jmax(outPkL, meterBallistics.outPeakHoldL * meterBallistics.holdDecay);
-    meterBallistics.outPeakHoldR = juce::jmax(outPkR, meterBallistics.outPeakHoldR * meterBallistics.holdDecay);
-    meterBallistics.inRmsL += meterBallistics.rmsCoeff * (inRmsL - meterBallistics.inRmsL);
-    meterBallistics.inRmsR += meterBallistics.rmsCoeff * (inRmsR - meterBallistics.inRmsR);
-    meterBallistics.outRmsL += meterBallistics.rmsCoeff * (outRmsL - meterBallistics.outRmsL);
-    meterBallistics.outRmsR += meterBallistics.rmsCoeff * (outRmsR - meterBallistics.outRmsR);
-    meterBallistics.sparkGR += 0.2f * (sparkGRDb - meterBallistics.sparkGR);
-    meterBallistics.clipHoldIn = juce::jmax(clipIn ? 1.0f : 0.0f, meterBallistics.clipHoldIn * 0.92f);
-    meterBallistics.clipHoldOut = juce::jmax(clipOut ? 1.0f : 0.0f, meterBallistics.clipHoldOut * 0.92f);
-
-    const float corrDen = std::sqrt(corrDenL * corrDenR) + 1.0e-12f;
-    const float correlation = juce::jlimit(-1.0f, 1.0f, corrNum / corrDen);
-
-    const float lufsRms = std::sqrt((lufsSq * 0.5f) * invN + 1.0e-20f);
-
-    meters.inputPeakL.store(juce::Decibels::gainToDecibels(meterBallistics.inPeakHoldL, -100.0f), std::memory_order_relaxed);
-    meters.inputPeakR.store(juce::Decibels::gainToDecibels(meterBallistics.inPeakHoldR, -100.0f), std::memory_order_relaxed);
-    meters.inputRmsL.store(juce::Decibels::gainToDecibels(meterBallistics.inRmsL, -100.0f), std::memory_order_relaxed);
-    meters.inputRmsR.store(juce::Decibels::gainToDecibels(meterBallistics.inRmsR, -100.0f), std::memory_order_relaxed);
-    meters.outputPeakL.store(juce::Decibels::gainToDecibels(meterBallistics.outPeakHoldL, -100.0f), std::memory_order_relaxed);
-    meters.outputPeakR.store(juce::Decibels::gainToDecibels(meterBallistics.outPeakHoldR, -100.0f), std::memory_order_relaxed);
-    meters.outputRmsL.store(juce::Decibels::gainToDecibels(meterBallistics.outRmsL, -100.0f), std::memory_order_relaxed);
-    meters.outputRmsR.store(juce::Decibels::gainToDecibels(meterBallistics.outRmsR, -100.0f), std::memory_order_relaxed);
-    meters.sparkGainReductionDb.store(juce::jmax(0.0f, meterBallistics.sparkGR), std::memory_order_relaxed);
-    meters.lufs.store(juce::Decibels::gainToDecibels(lufsRms, -100.0f), std::memory_order_relaxed);
-    meters.inputClip.store(meterBallistics.clipHoldIn, std::memory_order_relaxed);
-    meters.outputClip.store(meterBallistics.clipHoldOut, std::memory_order_relaxed);
+    for (size_t s = 0; s < 4; ++s) {
+        mb.peakHold[s] = juce::jmax(sums.peak[s], mb.peakHold[s] * mb.peakDecay);
+        mb.meanSquare[s] += mb.rmsCoeff * (sums.sumSquares[s] * invN - mb.meanSquare[s]);
+    }
+    mb.sparkGR += mb.sparkCoeff * (sparkGRDb - mb.sparkGR);
+    mb.clipHoldIn = juce::jmax(sums.clips[0] + sums.clips[1] > 0.0f ? 1.0f : 0.0f, mb.clipHoldIn * mb.clipDecay);
+    mb.clipHoldOut = juce::jmax(sums.clips[2] + sums.clips[3] > 0.0f ? 1.0f : 0.0f, mb.clipHoldOut * mb.clipDecay);
+
+    // Correlation and loudness integrate the block sums over their own windows.
+    mb.cross += mb.correlationCoeff * (sums.cross * invN - mb.cross);
+    mb.corrSquareL += mb.correlationCoeff * (sums.sumSquares[2] * invN - mb.corrSquareL);
+    mb.corrSquareR += mb.correlationCoeff * (sums.sumSquares[3] * invN - mb.corrSquareR);
+    mb.loudness += mb.loudnessCoeff * ((sums.sumSquares[2] + sums.sumSquares[3]) * 0.5f * invN - mb.loudness);
+
+    const float corrDen = std::sqrt(mb.corrSquareL * mb.corrSquareR) + 1.0e-12f;
+    const float correlation = juce::jlimit(-1.0f, 1.0f, mb.cross / corrDen);
+
+    auto peakDb = [&](size_t s) { return juce::Decibels::gainToDecibels(mb.peakHold[s], -100.0f); };
+    auto rmsDb = [&](size_t s) { return juce::Decibels::gainToDecibels(std::sqrt(mb.meanSquare[s] + 1.0e-20f), -100.0f); };
+    meters.inputPeakL.store(peakDb(0), std::memory_order_relaxed);
+    meters.inputPeakR.store(peakDb(1), std::memory_order_relaxed);
+    meters.inputRmsL.store(rmsDb(0), std::memory_order_relaxed);
+    meters.inputRmsR.store(rmsDb(1), std::memory_order_relaxed);
+    meters.outputPeakL.store(peakDb(2), std::memory_order_relaxed);
+    meters.outputPeakR.store(peakDb(3), std::memory_order_relaxed);
+    meters.outputRmsL.store(rmsDb(2), std::memory_order_relaxed);
+    meters.outputRmsR.store(rmsDb(3), std::memory_order_relaxed);
+    meters.sparkGainReductionDb.store(juce::jmax(0.0f, mb.sparkGR), std::memory_order_relaxed);
+    meters.lufs.store(juce::Decibels::gainToDecibels(std::sqrt(mb.loudness + 1.0e-20f), -100.0f), std::memory_order_relaxed);
+    meters.inputClip.store(mb.clipHoldIn, std::memory_order_relaxed);
+    meters.outputClip.store(mb.clipHoldOut, std::memory_order_relaxed);
     meters.correlation.store(correlation, std::memory_order_relaxed);
 }
 
-void BTZAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer&) {
-    juce::ScopedNoDenormals noDenormals;
-
-    const int numSamples = buffer.getNumSamples();
-    const int totalNumInputChannels = getTotalNumInputChannels();
-    const int totalNumOutputChannels = getTotalNumOutputChannels();
+// Dry copy, analysis and the per-block targets of the input stage. The dual-mono
+// crossfade this block will apply is taken now and the live state advanced past
+// it, so the crossfade can run later without touching dualMono.
+void BTZAudioProcessor::beginStages(StageBlock& block, bool bypassed) {
+    const int numSamples = block.numSamples;
+
+    // Motion gives each channel its own wow, flutter and hiss, so identical input
+    // only counts as dual mono once Motion has rested long enough (six smoother
+    // time constants) for its smoother to have settled under the stage threshold.
+    motionRestSamples = param(BTZParams::motion) <= 0.005f ? motionRestSamples + numSamples : 0;
+    const bool identical = std::memcmp(block.dataL, block.dataR, sizeof(float) * (size_t) numSamples) == 0;
+    dualMono.update(identical && motionRestSamples >= motionSettleSamples
+                        && dualMonoFastPath.load(std::memory_order_relaxed), numSamples);
+
+    jassert(numSamples <= maxPreparedBlockSize);
+    juce::FloatVectorOperations::copy(block.dryL, block.dataL, numSamples);
+    juce::FloatVectorOperations::copy(block.dryR, block.dataR, numSamples);
+    dryDelayL.process(block.dryL, numSamples);
+    dryDelayR.process(block.dryR, numSamples);
+
+    if (! bypassed && param(BTZParams::adaptive) > 0.0f)
+        analysis.push(block.dataL, block.dataR, numSamples);
+    // Program-adaptive offsets from the analysis worker, read once per block.
+    block.bias = AdaptiveBias::fromFeatures(analysis.getFeatures(), param(BTZParams::adaptive));
+    updateInputTargets();
+
+    block.singleLane = dualMono.singleLane();
+    block.dualMono = dualMono;
+    if (! bypassed && (dualMono.wantsSingleLane() || dualMono.rightOwn < 1.0f)) {
+        for (int n = 0; n < numSamples; ++n)
+            dualMono.next();
+    }
+}
 
-    for (int ch = totalNumInputChannels; ch < totalNumOutputChannels; ++ch)
-        buffer.clear(ch, 0, numSamples);
+void BTZAudioProcessor::upsampleStage(StageBlock& block) {
+    const int numSamples = block.numSamples;
+
+    // The gate and its key run here at host rate, ahead of the oversampler.
+    sidechain.process(block.dataL, block.dataR, numSamples);
+    gate.process(block.dataL, block.dataR, sidechain.getGateKey(), numSamples);
+    block.gateGrDb = gate.getGainReductionDb();
+
+    // Dual-mono input runs the oversampler and core on the left lane only.
+    if (auto* os = engines.get(activeQualityMode)) {
+        float* lanes[] = { block.dataL, block.dataR };
+        juce::dsp::AudioBlock<float> laneBlock(lanes, block.singleLane ? 1u : 2u, (size_t) numSamples);
+        auto upBlock = os->processSamplesUp(laneBlock);
+        block.coreL = upBlock.getChannelPointer(0);
+        block.coreR = block.singleLane ? nullptr : upBlock.getChannelPointer(1);
+        block.coreSamples = (int) upBlock.getNumSamples();
+    } else {
+        block.coreL = block.dataL;
+        block.coreR = block.singleLane ? nullptr : block.dataR;
+        block.coreSamples = numSamples;
+    }
+}
 
-    if (numSamples <= 0 || buffer.getNumChannels() < 2)
-        return;
+void BTZAudioProcessor::coreStage(StageBlock& block) {
+    adaaOrder = getShaperOrder(activeQualityMode);
+    configureTapeSolver(activeQualityMode);
+    configureMotionInterpolation(activeQualityMode);
+    updateCoreTargets(block.bias);
+    runCore(block);
+    block.sparkGrDb = sparkGrEnvelope;
+}
 
-    const int copyCount = juce::jmin(numSamples, maxPreparedBlockSize);
-    dryBuffer.copyFrom(0, 0, buffer, 0, 0, copyCount);
-    dryBuffer.copyFrom(1, 0, buffer, 1, 0, copyCount);
+void BTZAudioProcessor::downsampleStage(StageBlock& block) {
+    const int numSamples = block.numSamples;
+    float* dataL = block.dataL;
+    float* dataR = block.dataR;
 
-    const float* dryReadL = dryBuffer.getReadPointer(0);
-    const float* dryReadR = dryBuffer.getReadPointer(1);
+    if (auto* os = engines.get(activeQualityMode)) {
+        float* lanes[] = { dataL, dataR };
+        juce::dsp::AudioBlock<float> laneBlock(lanes, block.singleLane ? 1u : 2u, (size_t) numSamples);
+        os->processSamplesDown(laneBlock);
+    }
+    if (block.singleLane)
+        juce::FloatVectorOperations::copy(dataR, dataL, numSamples);
 
-    updateTargetsFromAPVTS();
-    const bool bypassed = *apvts.getRawParameterValue("bypass") > 0.5f;
-    const float autoGain = *apvts.getRawParameterValue("autogain");
-    const int requestedQuality = getRequestedQualityMode();
+    wetPadL.process(dataL, numSamples);
+    wetPadR.process(dataR, numSamples);
 
-    if (requestedQuality != activeQualityMode) {
-        activeQualityMode = requestedQuality;
-        updateLatencyFromQuality(activeQualityMode);
+    auto& fade = block.dualMono;
+    if (fade.wantsSingleLane() || fade.rightOwn < 1.0f) {
+        for (int n = 0; n < numSamples; ++n)
+            dataR[n] = dataL[n] + (dataR[n] - dataL[n]) * fade.next();
     }
+}
 
-    float* dataL = buffer.getWritePointer(0);
-    float* dataR = buffer.getWritePointer(1);
+void BTZAudioProcessor::outputStage(StageBlock& block, bool bypassed) {
+    const int numSamples = block.numSamples;
+    float* dataL = block.dataL;
+    float* dataR = block.dataR;
 
     if (! bypassed) {
-        if (activeQualityMode == 1 && os2x != nullptr) {
-            juce::dsp::AudioBlock<float> block(buffer);
-            auto stereoBlock = block.getSubsetChannelBlock(0, 2).getSubBlock(0, (size_t) numSamples);
-            auto upBlock = os2x->processSamplesUp(stereoBlock);
-            processCore(upBlock.getChannelPointer(0), upBlock.getChannelPointer(1), (int) upBlock.getNumSamples(), 2.0f);
-            os2x->processSamplesDown(stereoBlock);
-        } else if (activeQualityMode >= 2 && os4x != nullptr) {
-            juce::dsp::AudioBlock<float> block(buffer);
-            auto stereoBlock = block.getSubsetChannelBlock(0, 2).getSubBlock(0, (size_t) numSamples);
-            auto upBlock = os4x->processSamplesUp(stereoBlock);
-            processCore(upBlock.getChannelPointer(0), upBlock.getChannelPointer(1), (int) upBlock.getNumSamples(), 4.0f);
-            os4x->processSamplesDown(stereoBlock);
-        } else {
-            processCore(dataL, dataR, numSamples, 1.0f);
-        }
+        updateOutputTargets(block.bias);
+        boomSub.process(dataL, dataR, numSamples, boomAmount);
+        texture.setParameters(param(BTZParams::textureSize), param(BTZParams::textureDensity),
+                              param(BTZParams::textureJitter));
+        texture.process(dataL, dataR, numSamples, param(BTZParams::texture));
+        room.process(dataL, dataR, numSamples, param(BTZParams::room));
+        match.process(dataL, dataR, numSamples, param(BTZParams::match));
+
+        // The Punch shaper's band sum is an allpass of the core input; the dry side
+        // gets the same allpass so a parallel mix does not notch at the crossovers.
+        // The meters and Autogain keep reading the untouched dry block.
+        float* phasedL = mixDry.getWritePointer(0);
+        float* phasedR = mixDry.getWritePointer(1);
+        juce::FloatVectorOperations::copy(phasedL, block.dryL, numSamples);
+        juce::FloatVectorOperations::copy(phasedR, block.dryR, numSamples);
+        mixDryPhase.process(phasedL, phasedR, numSamples);
+
+        float* gains = mixGains.data();
+        for (int n = 0; n < numSamples; ++n)
+            gains[n] = sMix.next() * modeFade.next();
+        DspKernels::get().mixToDry(dataL, phasedL, gains, numSamples);
+        DspKernels::get().mixToDry(dataR, phasedR, gains, numSamples);
+    } else {
+        juce::FloatVectorOperations::copy(dataL, block.dryL, numSamples);
+        juce::FloatVectorOperations::copy(dataR, block.dryR, numSamples);
     }
 
-    if (autoGain > 0.5f && ! bypassed) {
-        float inRmsSq = 0.0f, outRmsSq = 0.0f;
-        for (int n = 0; n < numSamples; ++n) {
-            const float iL = dryReadL[n];
-            const float iR = dryReadR[n];
-            inRmsSq += iL * iL + iR * iR;
-            outRmsSq += dataL[n] * dataL[n] + dataR[n] * dataR[n];
-        }
+    if (param(BTZParams::autogain) > 0.5f && ! bypassed) {
+        const auto& kernels = DspKernels::get();
+        float peak = 0.0f, inRmsSq = 0.0f, outRmsSq = 0.0f;
+        kernels.peakAndEnergy(block.dryL, numSamples, peak, inRmsSq);
+        kernels.peakAndEnergy(block.dryR, numSamples, peak, inRmsSq);
+        kernels.peakAndEnergy(dataL, numSamples, peak, outRmsSq);
+        kernels.peakAndEnergy(dataR, numSamples, peak, outRmsSq);
         const float inRms = std::sqrt(inRmsSq / juce::jmax(1, numSamples * 2) + 1.0e-20f);
         const float outRms = std::sqrt(outRmsSq / juce::jmax(1, numSamples * 2) + 1.0e-20f);
         if (inRms > 1.0e-6f && outRms > 1.0e-6f) {
             const float gainDb = juce::jlimit(-4.0f, 4.0f, juce::Decibels::gainToDecibels(inRms / outRms, 0.0f));
             const float gain = juce::Decibels::decibelsToGain(gainDb);
-            for (int n = 0; n < numSamples; ++n) {
-                dataL[n] *= gain;
-                dataR[n] *= gain;
+            kernels.applyGain(dataL, gain, numSamples);
+            kernels.applyGain(dataR, gain, numSamples);
+        }
+    }
+
+    // Drive output stage. It also runs while bypassed (amount 0 with the latency kept
+    // is a plain delay of the same length), so bypass never moves the reported latency.
+    limiter.process(dataL, dataR, numSamples, bypassed ? 0.0f : param(BTZParams::limiter),
+                    param(BTZParams::sparkCeiling), isLimiterLatencyActive());
+    meters.limiterGrLowDb.store(limiter.getBandGainReductionDb(0), std::memory_order_relaxed);
+    meters.limiterGrMidDb.store(limiter.getBandGainReductionDb(1), std::memory_order_relaxed);
+    meters.limiterGrHighDb.store(limiter.getBandGainReductionDb(2), std::memory_order_relaxed);
+}
+
+void BTZAudioProcessor::meterStage(const StageBlock& block) {
+    meters.gateGrDb.store(block.gateGrDb, std::memory_order_relaxed);
+    updateMeters(block.dryL, block.dryR, block.dataL, block.dataR, block.numSamples, block.sparkGrDb);
+}
+
+void BTZAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer&) {
+    juce::ScopedNoDenormals noDenormals;
+
+    const int numSamples = buffer.getNumSamples();
+    const int totalNumInputChannels = getTotalNumInputChannels();
+    const int totalNumOutputChannels = getTotalNumOutputChannels();
+
+    for (int ch = totalNumInputChannels; ch < totalNumOutputChannels; ++ch)
+        buffer.clear(ch, 0, numSamples);
+
+    if (numSamples <= 0 || buffer.getNumChannels() < 1)
+        return;
+
+    if (buffer.getNumChannels() >= 2 && totalNumInputChannels == 1)
+        buffer.copyFrom(1, 0, buffer, 0, 0, numSamples);
+
+    const bool governed = param(BTZParams::qualityGovernor) > 0.5f && ! isNonRealtime();
+    const auto blockStart = std::chrono::steady_clock::now();
+
+    // Blocks above the prepared size (some hosts exceed it) run in prepared-size
+    // pieces, so no buffer is ever resized on the audio thread. Offline with the
+    // render pipeline on, the pieces are pipeline units whether or not this block
+    // can be pipelined, so a bounce renders the same on any number of cores.
+    const bool pipelineOn = isNonRealtime() && param(BTZParams::renderPipeline) > 0.5f;
+    const int chunkSize = pipelineOn ? juce::jmin(pipelineUnitSamples, juce::jmax(1, maxPreparedBlockSize))
+                                     : juce::jmax(1, maxPreparedBlockSize);
+    if (pipelineOn && buffer.getNumChannels() >= 2 && canRunPipeline(numSamples, chunkSize)) {
+        processPipelined(buffer, chunkSize);
+    } else {
+        for (int start = 0; start < numSamples; start += chunkSize) {
+            const int n = juce::jmin(chunkSize, numSamples - start);
+
+            // Mono input is processed as dual mono. Mono out folds the stereo stages back down.
+            if (buffer.getNumChannels() < 2) {
+                monoWork.copyFrom(0, 0, buffer, 0, start, n);
+                monoWork.copyFrom(1, 0, buffer, 0, start, n);
+                juce::AudioBuffer<float> work(monoWork.getArrayOfWritePointers(), 2, n);
+                processStereo(work);
+                buffer.copyFrom(0, start, monoWork, 0, 0, n);
+                buffer.addFrom(0, start, monoWork, 1, 0, n);
+                buffer.applyGain(0, start, n, 0.5f);
+            } else {
+                juce::AudioBuffer<float> part(buffer.getArrayOfWritePointers(), 2, start, n);
+                processStereo(part);
             }
         }
     }
 
-    if (bypassed) {
-        meterBallistics.sparkGR *= 0.9f;
-        sparkGrEnvelope *= 0.9f;
+    // The new cap takes effect through the usual mode fade on the next block.
+    const int requested = getRequestedQualityMode();
+    if (governed && activeQualityMode != renderQualityMode) {
+        const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - blockStart).count();
+        governor.update(elapsed, numSamples / currentSampleRate, activeQualityMode, requested);
+    } else if (! governed) {
+        governor.reset();
     }
 
-    updateMeters(dryReadL, dryReadR, dataL, dataR, numSamples, sparkGrEnvelope);
+    meters.qualityMode.store(activeQualityMode, std::memory_order_relaxed);
+    meters.qualityGoverned.store(governed && governor.cap < requested, std::memory_order_relaxed);
+    meters.governorLoad.store(governor.load, std::memory_order_relaxed);
+    meters.governorStepDowns.store(governor.stepDowns, std::memory_order_relaxed);
+}
+
+void BTZAudioProcessor::processStereo(juce::AudioBuffer<float>& buffer) {
+    const int numSamples = buffer.getNumSamples();
+    const bool bypassed = param(BTZParams::bypass) > 0.5f;
+
+    StageBlock block;
+    block.dataL = buffer.getWritePointer(0);
+    block.dataR = buffer.getWritePointer(1);
+    block.dryL = dryBuffer.getWritePointer(0);
+    block.dryR = dryBuffer.getWritePointer(1);
+    block.numSamples = numSamples;
+    beginStages(block, bypassed);
+
+    // Quality and render switches go through a short fade to the aligned dry signal
+    // so the oversampler swap never lands on an audible discontinuity.
+    // A mode whose engine is still being built keeps the current one until it is ready.
+    const int requestedQuality = getEffectiveQualityMode();
+    if (requestedQuality != activeQualityMode && engines.acquire(requestedQuality)) {
+        modeFade.request(requestedQuality);
+        if (bypassed)
+            modeFade.gain = 0.0f;
+        if (modeFade.readyToSwitch()) {
+            switchQualityMode(requestedQuality);
+            engines.retireUnused(requestedQuality, getStandbyQualityMode(requestedQuality));
+            modeFade.pendingMode = -1;
+        }
+    } else if (latencyStagesPending()) {
+        // Switching the gate lookahead or the Motion centre delay moves the path
+        // latency: the same fade, with the swap done while the wet path is silent.
+        modeFade.request(activeQualityMode);
+        if (bypassed)
+            modeFade.gain = 0.0f;
+        if (modeFade.readyToSwitch()) {
+            applyLatencyStages(wantsGateLookahead(), wantsMotionDelay());
+            updateLatencyFromQuality(activeQualityMode);
+            modeFade.pendingMode = -1;
+        }
+    } else {
+        modeFade.pendingMode = -1;
+        // While the governor holds the running mode the selection can still change;
+        // the reported latency follows the selection.
+        if (requestedQuality == activeQualityMode && getReportedLatency(activeQualityMode) != getLatencySamples())
+            updateLatencyFromQuality(activeQualityMode);
+    }
+
+    if (! bypassed) {
+        upsampleStage(block);
+        coreStage(block);
+        downsampleStage(block);
+    } else {
+        // Nothing drives the Spark envelope while bypassed; let it fall on its own clock.
+        meterBallistics.setBlockLength(numSamples);
+        sparkGrEnvelope *= meterBallistics.bypassDecay;
+        block.sparkGrDb = sparkGrEnvelope;
+    }
+    outputStage(block, bypassed);
+    meterStage(block);
+}
+
+// The pipeline takes a block only when the serial path would run every unit of
+// it without a decision that spans stages: not bypassed, no quality switch, fade
+// or latency change pending, and at least two units to overlap.
+bool BTZAudioProcessor::canRunPipeline(int numSamples, int unitSamples) const {
+    if (! pipelineReady.load(std::memory_order_acquire) || pipeline.getNumWorkers() == 0 || numSamples <= unitSamples)
+        return false;
+    if (param(BTZParams::bypass) > 0.5f || activeQualityMode != getEffectiveQualityMode())
+        return false;
+    if (modeFade.pendingMode >= 0 || modeFade.gain < 1.0f || getReportedLatency(activeQualityMode) != getLatencySamples())
+        return false;
+    if (latencyStagesPending())
+        return false;
+    return activeQualityMode == 0 || engines.get(activeQualityMode) != nullptr;
+}
+
+// Offline blocks as a software pipeline over pipelineSlotCount units in flight:
+// input (dry, sidechain, gate, upsampling), core, downsampling, output (mix,
+// autogain, limiter) and meters. Each stage sees its units in order with the
+// same calls as processStereo(), so the result is bit-identical to the serial
+// units. The up and down passes share the oversampler's buffers, so with an
+// oversampler those two stages take turns and each unit's core data lives in
+// its slot in between.
+void BTZAudioProcessor::processPipelined(juce::AudioBuffer<float>& buffer, int unitSamples) {
+    const int numSamples = buffer.getNumSamples();
+    const int numUnits = (numSamples + unitSamples - 1) / unitSamples;
+    float* const* channels = buffer.getArrayOfWritePointers();
+    auto* os = engines.get(activeQualityMode);
+
+    pipeline.setExclusionGroup(pipeInput, os != nullptr ? 0 : -1);
+    pipeline.setExclusionGroup(pipeDown, os != nullptr ? 0 : -1);
+    pipeline.run(numUnits, [&](int stage, int unit, int slotIndex) {
+        // Workers get the audio thread's floating-point mode.
+        juce::ScopedNoDenormals noDenormals;
+        auto& slot = pipelineSlots[(size_t) slotIndex];
+        auto& block = slot.block;
+
+        switch (stage) {
+            case pipeInput: {
+                const int start = unit * unitSamples;
+                block = {};
+                block.dataL = channels[0] + start;
+                block.dataR = channels[1] + start;
+                block.dryL = slot.dry.getWritePointer(0);
+                block.dryR = slot.dry.getWritePointer(1);
+                block.numSamples = juce::jmin(unitSamples, numSamples - start);
+                beginStages(block, false);
+                upsampleStage(block);
+
+                // The oversampler reuses its buffer for the next unit.
+                if (os != nullptr) {
+                    slot.osTop[0] = block.coreL;
+                    slot.osTop[1] = block.coreR;
+                    block.coreL = slot.core.getWritePointer(0);
+                    juce::FloatVectorOperations::copy(block.coreL, slot.osTop[0], block.coreSamples);
+                    if (slot.osTop[1] != nullptr) {
+                        block.coreR = slot.core.getWritePointer(1);
+                        juce::FloatVectorOperations::copy(block.coreR, slot.osTop[1], block.coreSamples);
+                    }
+                }
+                break;
+            }
+            case pipeCore:
+                coreStage(block);
+                break;
+            case pipeDown:
+                if (os != nullptr) {
+                    juce::FloatVectorOperations::copy(slot.osTop[0], block.coreL, block.coreSamples);
+                    if (slot.osTop[1] != nullptr)
+                        juce::FloatVectorOperations::copy(slot.osTop[1], block.coreR, block.coreSamples);
+                }
+                downsampleStage(block);
+                break;
+            case pipeOutput:
+                outputStage(block, false);
+                break;
+            default:
+                meterStage(block);
+                break;
+        }
+    });
 }
 
 void BTZAudioProcessor::getStateInformation(juce::MemoryBlock& destData) {
-    const auto state = apvts.copyState();
+    // The match curve only goes into the copy: the host may ask for the state off
+    // the message thread, so the live tree (and its listeners) is left alone.
+    juce::StringArray curve;
+    for (float db : match.getCurve())
+        curve.add(juce::String(db, 2));
+    auto state = apvts.copyState();
+    state.setProperty("matchCurve", curve.joinIntoString(" "), nullptr);
     std::unique_ptr<juce::XmlElement> xml(state.createXml());
     copyXmlToBinary(*xml, destData);
 }
 
 void BTZAudioProcessor::setStateInformation(const void* data, int sizeInBytes) {
     std::unique_ptr<juce::XmlElement> xml(getXmlFromBinary(data, sizeInBytes));
-    if (xml && xml->hasTagName(apvts.state.getType()))
-        apvts.replaceState(juce::ValueTree::fromXml(*xml));
+    juce::String curveText;
+    if (xml && xml->hasTagName(apvts.state.getType())) {
+        auto state = juce::ValueTree::fromXml(*xml);
+        curveText = state.getProperty("matchCurve").toString();
+        state.removeProperty("matchCurve", nullptr);
+        apvts.replaceState(state);
+    }
 
-    activeQualityMode = getRequestedQualityMode();
-    updateLatencyFromQuality(activeQualityMode);
+    const auto irPath = apvts.state.getProperty("roomIR").toString();
+    room.setImpulseResponse(juce::File::isAbsolutePath(irPath) ? juce::File(irPath) : juce::File());
+
+    // The match curve is restored as saved; the reference file is reloaded so a new Learn can use it.
+    std::vector<float> curve;
+    for (const auto& token : juce::StringArray::fromTokens(curveText, " ", ""))
+        curve.push_back(token.getFloatValue());
+    match.setCurve(curve);
+    const auto refPath = apvts.state.getProperty("matchRef").toString();
+    if (juce::File::isAbsolutePath(refPath))
+        match.setReferenceFile(juce::File(refPath));
+
+    // The audio thread performs the actual engine switch; only report the new latency here.
+    const int latency = getReportedLatency(getEffectiveQualityMode());
+    if (latency != getLatencySamples())
+        setLatencySamples(latency);
+}
+
+void BTZAudioProcessor::setRoomImpulseResponse(const juce::File& file) {
+    apvts.state.setProperty("roomIR", file.getFullPathName(), nullptr);
+    room.setImpulseResponse(file);
+}
+
+void BTZAudioProcessor::setMatchReference(const juce::File& file) {
+    apvts.state.setProperty("matchRef", file.getFullPathName(), nullptr);
+    match.setReferenceFile(file);
 }
 
 juce::AudioProcessorEditor* BTZAudioProcessor::createEditor() {
@@ -3,11 +3,31 @@
 */
 #pragma once
 
+#include "AdaaShaper.h"
+#include "AnalysisWorker.h"
+#include "BassEnhancer.h"
+#include "ConvolutionRoom.h"
+#include "GlueCompressor.h"
+#include "LimiterNo6.h"
+#include "ParameterTable.h"
+#include "QualityEngines.h"
+#include "RenderPipeline.h"
+#include "SidechainDetector.h"
+#include "GateProcessor.h"
+#include "GranularProcessor.h"
+#include "TapeHysteresis.h"
+#include "TimbralMatch.h"
+#include "WowFlutter.h"
+#include "TransientShaper.h"
 #include <JuceHeader.h>
+#include <array>
 #include <atomic>
+#include <chrono>
 #include <cmath>
 #include <cstdint>
+#include <cstring>
 #include <memory>
+#include <vector>
 
 struct BTZMeterState {
     std::atomic<float> inputPeakL { -100.0f };
@@ -19,10 +39,21 @@ struct BTZMeterState {
     std::atomic<float> outputRmsL  { -100.0f };
     std::atomic<float> outputRmsR  { -100.0f };
     std::atomic<float> sparkGainReductionDb { 0.0f };
+    std::atomic<float> limiterGrLowDb  { 0.0f };
+    std::atomic<float> limiterGrMidDb  { 0.0f };
+    std::atomic<float> limiterGrHighDb { 0.0f };
+    std::atomic<float> gateGrDb { 0.0f };
     std::atomic<float> lufs { -24.0f };
     std::atomic<float> inputClip { 0.0f };
     std::atomic<float> outputClip { 0.0f };
     std::atomic<float> correlation { 1.0f };
+    // Quality telemetry: the mode actually running (3 = render), whether the
+    // governor is holding it below the selected one, its smoothed load
+    // (processBlock time / block duration) and how often it has stepped down.
+    std::atomic<int> qualityMode { 1 };
+    std::atomic<bool> qualityGoverned { false };
+    std::atomic<float> governorLoad { 0.0f };
+    std::atomic<int> governorStepDowns { 0 };
 };
 
 struct SlewLimiter {
@@ -89,15 +120,178 @@ struct SmoothParam {
     void snapTo(float v) { current = target = v; }
 };
 
-class BTZAudioProcessor : public juce::AudioProcessor {
+// Integer-sample delay used to pad every processing path to the reported latency.
+// Given a fade length, a delay change on a running line crossfades from the old
+// tap to the new one instead of jumping.
+struct LatencyDelay {
+    std::vector<float> buffer;
+    int writePos = 0;
+    int delay = 0, previousDelay = 0;
+    float fade = 1.0f, fadeStep = 1.0f;
+    bool running = false;
+    void prepare(int maxDelay, int fadeSamples = 0) {
+        buffer.assign((size_t) juce::jmax(1, maxDelay + 1), 0.0f);
+        writePos = 0;
+        delay = juce::jmin(delay, maxDelay);
+        fadeStep = 1.0f / (float) juce::jmax(1, fadeSamples);
+        fade = 1.0f;
+        running = false;
+    }
+    void setDelay(int d) {
+        d = juce::jlimit(0, (int) buffer.size() - 1, d);
+        if (d != delay && running && fadeStep < 1.0f) {
+            previousDelay = delay;
+            fade = 0.0f;
+        }
+        delay = d;
+    }
+    void reset() { std::fill(buffer.begin(), buffer.end(), 0.0f); writePos = 0; fade = 1.0f; running = false; }
+    size_t getMemoryBytes() const noexcept { return buffer.size() * sizeof(float); }
+    void process(float* data, int n) {
+        // A line that can fade keeps its buffer current even at zero delay.
+        if (delay == 0 && fadeStep >= 1.0f)
+            return;
+        running = true;
+        const int size = (int) buffer.size();
+        for (int i = 0; i < n; ++i) {
+            buffer[(size_t) writePos] = data[i];
+            float y = buffer[(size_t) tap(delay, size)];
+            if (fade < 1.0f) {
+                const float old = buffer[(size_t) tap(previousDelay, size)];
+                y = old + fade * (y - old);
+                fade = juce::jmin(1.0f, fade + fadeStep);
+            }
+            data[i] = y;
+            if (++writePos == size)
+                writePos = 0;
+        }
+    }
+    int tap(int d, int size) const {
+        const int readPos = writePos - d;
+        return readPos < 0 ? readPos + size : readPos;
+    }
+};
+
+// Fades the wet path down to the latency-aligned dry signal, lets the caller swap
+// engines while silent, then fades back up. Used for quality/render switches.
+struct ModeSwitchFade {
+    float gain = 1.0f;
+    float step = 0.001f;
+    int pendingMode = -1;
+    void setTime(float ms, double sr) { step = 1.0f / juce::jmax(1.0f, (float) sr * ms * 0.001f); }
+    void reset() { gain = 1.0f; pendingMode = -1; }
+    void request(int mode) { pendingMode = mode; }
+    bool readyToSwitch() const { return pendingMode >= 0 && gain <= 0.0f; }
+    float next() {
+        if (pendingMode >= 0)
+            gain = juce::jmax(0.0f, gain - step);
+        else if (gain < 1.0f)
+            gain = juce::jmin(1.0f, gain + step);
+        return gain;
+    }
+};
+
+// Dual-mono detection with hysteresis. Bit-identical L/R input for holdSamples
+// selects the single-lane path; the first differing block leaves it. The right
+// output crossfades between its own lane and the copy of the left lane, so the
+// lane is only dropped once fully faded and fades back in from the copy.
+struct DualMonoState {
+    int identicalRun = 0;
+    int holdSamples = 2400;
+    float rightOwn = 1.0f;   // weight of the right lane's own output
+    float step = 0.001f;
+    void setTime(float holdMs, float fadeMs, double sr) {
+        holdSamples = juce::roundToInt((float) sr * holdMs * 0.001f);
+        step = 1.0f / juce::jmax(1.0f, (float) sr * fadeMs * 0.001f);
+    }
+    void reset() { identicalRun = 0; rightOwn = 1.0f; }
+    void update(bool identical, int numSamples) { identicalRun = identical ? identicalRun + numSamples : 0; }
+    bool wantsSingleLane() const { return identicalRun >= holdSamples; }
+    bool singleLane() const { return wantsSingleLane() && rightOwn <= 0.0f; }
+    float next() {
+        rightOwn = wantsSingleLane() ? juce::jmax(0.0f, rightOwn - step) : juce::jmin(1.0f, rightOwn + step);
+        return rightOwn;
+    }
+};
+
+// Realtime quality cap under CPU pressure. Each processBlock's wall time is
+// measured against the block's duration; when the smoothed load stays above
+// stepDownLoad for holdMs the cap drops one tier below the running mode, and
+// when it stays below stepUpLoad for the recovery wait the cap rises one tier.
+// A step up that has to be undone within retryMs doubles the next wait (up to
+// maxRecoverMs), so a session that cannot afford the higher tier settles on
+// the lower one instead of bouncing between them.
+struct QualityGovernor {
+    static constexpr float stepDownLoad = 0.7f, stepUpLoad = 0.3f;
+    static constexpr double smoothingMs = 50.0, holdMs = 150.0;
+    static constexpr double recoverMs = 2000.0, maxRecoverMs = 30000.0, retryMs = 5000.0;
+
+    int cap = 2;        // highest realtime mode allowed
+    float load = 0.0f;
+    double overMs = 0.0, underMs = 0.0, sinceStepUpMs = 0.0, recoverWaitMs = recoverMs;
+    bool probing = false;   // stepped up less than retryMs ago
+    int stepDowns = 0;
+
+    void reset() { *this = {}; }
+    // runningMode: the realtime mode in use; requested: the one selected. True when the cap changed.
+    bool update(double elapsedSeconds, double blockSeconds, int runningMode, int requested) {
+        const double blockMs = blockSeconds * 1000.0;
+        load += (1.0f - (float) std::exp(-blockMs / smoothingMs)) * ((float) (elapsedSeconds / blockSeconds) - load);
+        overMs = load > stepDownLoad ? overMs + blockMs : 0.0;
+        underMs = load < stepUpLoad ? underMs + blockMs : 0.0;
+
+        sinceStepUpMs += blockMs;
+        if (probing && sinceStepUpMs >= retryMs) {
+            probing = false;
+            recoverWaitMs = recoverMs;
+        }
+
+        if (overMs >= holdMs && runningMode > 0) {
+            if (probing)
+                recoverWaitMs = juce::jmin(maxRecoverMs, recoverWaitMs * 2.0);
+            cap = runningMode - 1;
+            probing = false;
+            overMs = underMs = 0.0;
+            ++stepDowns;
+            return true;
+        }
+        if (underMs >= recoverWaitMs && cap < requested) {
+            ++cap;
+            probing = true;
+            sinceStepUpMs = 0.0;
+            overMs = underMs = 0.0;
+            return true;
+        }
+        return false;
+    }
+};
+
+// Heap held by one prepared instance, per owner (see getMemoryReport()).
+struct BTZMemoryReport {
+    struct Item {
+        const char* name;
+        size_t bytes;
+    };
+    std::vector<Item> items;
+
+    size_t getTotalBytes() const {
+        size_t total = 0;
+        for (const auto& item : items)
+            total += item.bytes;
+        return total;
+    }
+};
+
+class BTZAudioProcessor : public juce::AudioProcessor, private juce::Timer {
 public:
     BTZAudioProcessor();
-    ~BTZAudioProcessor() override = default;
+    ~BTZAudioProcessor() override;
 
     void prepareToPlay(double sampleRate, int samplesPerBlock) override;
     void releaseResources() override;
     bool isBusesLayoutSupported(const BusesLayout& layouts) const override;
     void processBlock(juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void setNonRealtime(bool isNonRealtime) noexcept override;
 
     juce::AudioProcessorEditor* createEditor() override;
     bool hasEditor() const override { return true; }
@@ -118,17 +312,64 @@ public:
 
     juce::AudioProcessorValueTreeState& getAPVTS() { return apvts; }
     BTZMeterState& getMeters() { return meters; }
+    // Buffers are sized to the prepared block and only the oversamplers in use
+    // are held; call from the message thread.
+    BTZMemoryReport getMemoryReport() const;
+
+    // Stored with the plugin state; an empty file selects the built-in room.
+    void setRoomImpulseResponse(const juce::File& file);
+    juce::File getRoomImpulseResponse() const { return room.getImpulseResponse(); }
+
+    // Match EQ: the reference file and the resulting curve are stored with the plugin state.
+    void setMatchReference(const juce::File& file);
+    juce::File getMatchReference() const { return match.getReferenceFile(); }
+    void setMatchLearning(TimbralMatch::Learn target) { match.setLearning(target); }
+    TimbralMatch::Learn getMatchLearning() const { return match.getLearning(); }
+
+    // Worker threads for the render pipeline; -1 (the default) picks from the
+    // core count, 0 keeps bounces on the calling thread. Not for the audio thread.
+    void setRenderPipelineWorkers(int numWorkers);
+
+    // Dual-mono input takes the single-lane path (on by default); off always runs
+    // both lanes, which has to give the same output bit for bit.
+    void setDualMonoFastPath(bool enabled) noexcept { dualMonoFastPath.store(enabled, std::memory_order_relaxed); }
 
 private:
+    // Meter time constants in ms. Per-block coefficients follow the length of
+    // the block actually metered, so readings do not depend on the host buffer
+    // size or rate; the first four match the old per-block constants at 512
+    // samples / 48 kHz.
     struct MeterBallistics {
-        float inPeakHoldL = 0.0f, inPeakHoldR = 0.0f;
-        float outPeakHoldL = 0.0f, outPeakHoldR = 0.0f;
-        float inRmsL = 0.0f, inRmsR = 0.0f;
-        float outRmsL = 0.0f, outRmsR = 0.0f;
+        static constexpr double peakReleaseMs = 2130.0, rmsMs = 128.0, clipHoldMs = 128.0, sparkGrMs = 48.0;
+        static constexpr double bypassGrMs = 100.0, correlationMs = 300.0, loudnessMs = 400.0;
+
+        // Index order of MeterSums: in L, in R, out L, out R.
+        std::array<float, 4> peakHold {}, meanSquare {};
         float sparkGR = 0.0f;
         float clipHoldIn = 0.0f, clipHoldOut = 0.0f;
-        float holdDecay = 0.995f;
-        float rmsCoeff = 0.08f;
+        float cross = 0.0f, corrSquareL = 0.0f, corrSquareR = 0.0f;   // output, correlation window
+        float loudness = 0.0f;   // output mean square, loudness window
+
+        double sampleRate = 48000.0;
+        int coeffBlock = 0;
+        float peakDecay = 0.0f, clipDecay = 0.0f, bypassDecay = 0.0f;
+        float rmsCoeff = 0.0f, sparkCoeff = 0.0f, correlationCoeff = 0.0f, loudnessCoeff = 0.0f;
+
+        void prepare(double rate) { *this = {}; sampleRate = rate; }
+        void setBlockLength(int n) {
+            if (n == coeffBlock)
+                return;
+            coeffBlock = n;
+            const double blockMs = 1000.0 * n / sampleRate;
+            auto decay = [blockMs](double ms) { return (float) std::exp(-blockMs / ms); };
+            peakDecay = decay(peakReleaseMs);
+            clipDecay = decay(clipHoldMs);
+            bypassDecay = decay(bypassGrMs);
+            rmsCoeff = 1.0f - decay(rmsMs);
+            sparkCoeff = 1.0f - decay(sparkGrMs);
+            correlationCoeff = 1.0f - decay(correlationMs);
+            loudnessCoeff = 1.0f - decay(loudnessMs);
+        }
     };
 
     juce::AudioProcessorValueTreeState apvts;
@@ -136,36 +377,180 @@ private:
     BTZMeterState meters;
     MeterBallistics meterBallistics;
 
-    SmoothParam sPunch, sWarmth, sBoom, sGlue, sAir, sWidth;
-    SmoothParam sDensity, sMotion, sEra, sMix, sDrive;
-    SmoothParam sMaster, sSparkCeil, sSparkMix, sShine, sShineMix;
+    // Resolved once in the constructor, so reading a parameter is one relaxed load.
+    std::array<std::atomic<float>*, BTZParams::count> paramValues {};
+    float param(BTZParams::Id id) const noexcept { return paramValues[(size_t) id]->load(std::memory_order_relaxed); }
+
+    // One smoother slot per parameter; only those with Smoothing::core/host in
+    // BTZParams::table are configured and run. The names are the processing code's view.
+    std::array<SmoothParam, BTZParams::count> smoothers {};
+    SmoothParam& sPunch = smoothers[BTZParams::punch];
+    SmoothParam& sWarmth = smoothers[BTZParams::warmth];
+    SmoothParam& sBoom = smoothers[BTZParams::boom];
+    SmoothParam& sGlue = smoothers[BTZParams::glue];
+    SmoothParam& sAir = smoothers[BTZParams::air];
+    SmoothParam& sWidth = smoothers[BTZParams::width];
+    SmoothParam& sDensity = smoothers[BTZParams::density];
+    SmoothParam& sMotion = smoothers[BTZParams::motion];
+    SmoothParam& sEra = smoothers[BTZParams::vintageModern];
+    SmoothParam& sMix = smoothers[BTZParams::mix];
+    SmoothParam& sDrive = smoothers[BTZParams::drive];
+    SmoothParam& sMaster = smoothers[BTZParams::masterIntensity];
+    SmoothParam& sSparkCeil = smoothers[BTZParams::sparkCeiling];
+    SmoothParam& sSparkMix = smoothers[BTZParams::sparkMix];
+    SmoothParam& sShine = smoothers[BTZParams::shineAmount];
+    SmoothParam& sShineMix = smoothers[BTZParams::shineMix];
+    SmoothParam& sTape = smoothers[BTZParams::tape];
 
     SafetyLayer safetyPre, safetyPost;
     SlewLimiter slewL, slewR;
     EnvFollower peakEnvL, peakEnvR, rmsEnvL, rmsEnvR;
-    EnvFollower glueEnv;
+    SidechainDetector sidechain;
+    GateProcessor gate;
+    GlueCompressor glueComp;
 
-    float glueGain = 1.0f;
     float xoverLowL = 0.0f, xoverLowR = 0.0f, xoverCoeff = 0.0f;
     float hpStateL = 0.0f, hpStateR = 0.0f;
     float sideLowState = 0.0f, sideLowCoeff = 0.0f;
     float sparkGrEnvelope = 0.0f;
     float sparkAttackCoeff = 0.2f, sparkReleaseCoeff = 0.01f;
+    float airRateScale = 1.0f;
 
     double currentSampleRate = 44100.0;
     int maxPreparedBlockSize = 0;
-    uint32_t noiseSeed = 12345u;
+    int motionDelaySamples = 0, gateLookaheadSamples = 0;
+    // Whether the gate lookahead and the Motion centre delay are in the path; only
+    // changed at a mode-fade swap.
+    bool gateLookaheadOn = true, motionDelayOn = true;
 
-    juce::AudioBuffer<float> dryBuffer;
-    std::unique_ptr<juce::dsp::Oversampling<float>> os2x;
-    std::unique_ptr<juce::dsp::Oversampling<float>> os4x;
+    juce::AudioBuffer<float> dryBuffer, mixDry;
+    std::vector<float> mixGains;
+    CrossoverAllpass3 mixDryPhase;     // the Punch shaper's allpass, on the Mix dry side
+    QualityEngines engines;
     int activeQualityMode = 1;
+    int preparedRenderQuality = 0;
+
+    // Mode 3 is the offline render path (8x/16x linear-phase), only entered while
+    // the host reports isNonRealtime() and the renderQuality setting is enabled.
+    static constexpr int renderQualityMode = 3;
+
+    // One block on its way through the stages of processStereo(). Each stage owns
+    // the processor state it touches; whatever a later stage needs from an earlier
+    // one travels here, so the render pipeline can run the stages of different
+    // blocks at once with a StageBlock per block in flight.
+    struct StageBlock {
+        float* dataL = nullptr;
+        float* dataR = nullptr;
+        float* dryL = nullptr;
+        float* dryR = nullptr;
+        int numSamples = 0;
+        bool singleLane = false;
+        DualMonoState dualMono;     // the right lane's crossfade for this block
+        AdaptiveBias bias;
+        float* coreL = nullptr;     // the core's (oversampled) block; coreR is null on a single lane
+        float* coreR = nullptr;
+        int coreSamples = 0;
+        float sparkGrDb = 0.0f, gateGrDb = 0.0f;
+    };
+
+    // Render pipeline stages, in chain order; blocks are pipelineUnitSamples long.
+    enum PipelineStage { pipeInput, pipeCore, pipeDown, pipeOutput, pipeMeter, numPipelineStages };
+    static constexpr int pipelineUnitSamples = 512, pipelineSlotCount = 8;
+
+    // Hand-off buffers for one block in flight: the oversampler reuses its buffer
+    // for the next block, so the pipeline copies out what it needs.
+    struct PipelineSlot {
+        StageBlock block;
+        juce::AudioBuffer<float> dry, core;
+        float* osTop[2] {};     // the oversampler's buffer this block's core data returns to
+    };
+
+    // Offline only (see processPipelined()); ready once the slots and workers exist.
+    RenderPipeline pipeline;
+    std::array<PipelineSlot, pipelineSlotCount> pipelineSlots;
+    std::atomic<bool> pipelineReady { false };
+    int pipelineWorkers = -1;
+
+    LatencyDelay wetPadL, wetPadR, dryDelayL, dryDelayR;
+    ModeSwitchFade modeFade;
+    QualityGovernor governor;
+    DualMonoState dualMono;
+    std::atomic<bool> dualMonoFastPath { true };
+    int motionRestSamples = 0, motionSettleSamples = 0;
+    juce::AudioBuffer<float> monoWork;
+    ConvolutionRoom room;
+    TimbralMatch match;
+    LimiterNo6 limiter;
+    MultibandTransientShaper punchShaper;
+
+    // Core stages that a block can skip when their amount stays below the
+    // per-sample threshold for the whole block (see getSkippableStages()).
+    enum CoreStage : unsigned {
+        stageDrive = 1u << 0,
+        stageWarmth = 1u << 1,
+        stageSaturation = 1u << 2,
+        stageTape = 1u << 3,
+        stageHarmonics = 1u << 4,
+        stageGlue = 1u << 5,
+        stageAir = 1u << 6,
+        stageBoom = 1u << 7,
+        stageDensity = 1u << 8,
+        stageMotion = 1u << 9,
+        allCoreStages = (1u << 10) - 1u
+    };
+
+    // Anti-aliased shapers for the core nonlinearities, one lane group per stage.
+    AdaaTanh4 adaaPre, adaaXover, adaaPunch, adaaDensity;
+    int adaaOrder = AdaaTanh4::off;
+    TapeHysteresis tape;
+    WowFlutter wowFlutter;
+    BassEnhancer boomSub;
+    float boomAmount = 0.0f;
+    GranularProcessor texture;
+    AnalysisWorker analysis;
 
     void initSmoothers(double sampleRate);
-    void updateTargetsFromAPVTS();
-    void processCore(float* dataL, float* dataR, int numSamples, float osFactor);
+    void configureCoreForRate(double processingRate);
+    void updateInputTargets();
+    void updateCoreTargets(const AdaptiveBias& bias);
+    void updateOutputTargets(const AdaptiveBias& bias);
+    unsigned getSkippableStages() const;
+    void runCore(const StageBlock& block);
+    template <bool singleLane> void dispatchCore(const StageBlock& block, unsigned skipped);
+    template <bool singleLane, unsigned skipped> void processCore(const StageBlock& block);
+    void beginStages(StageBlock& block, bool bypassed);
+    void upsampleStage(StageBlock& block);
+    void coreStage(StageBlock& block);
+    void downsampleStage(StageBlock& block);
+    void outputStage(StageBlock& block, bool bypassed);
+    void meterStage(const StageBlock& block);
+    void processStereo(juce::AudioBuffer<float>& buffer);
+    bool canRunPipeline(int numSamples, int unitSamples) const;
+    void processPipelined(juce::AudioBuffer<float>& buffer, int unitSamples);
+    void preparePipeline();
+    void releasePipeline();
+    void timerCallback() override;
     void updateMeters(const float* inL, const float* inR, const float* outL, const float* outR, int n, float sparkGRDb);
     int getRequestedQualityMode() const;
+    int getRequestedRenderQuality() const;
+    int getEffectiveQualityMode() const;
+    int getStandbyQualityMode(int mode) const;
+    int getOversamplingFactor(int mode) const;
+    int getRenderStages() const;
+    int getPathLatency(int mode) const;
+    int getAlignedLatency(int mode) const;
+    int getReportedLatency(int mode) const;
+    bool isLimiterLatencyActive() const;
+    bool wantsGateLookahead() const;
+    bool wantsMotionDelay() const;
+    bool latencyStagesPending() const;
+    void applyLatencyStages(bool gateLookahead, bool motionDelay);
+    void switchQualityMode(int mode);
+    int getShaperOrder(int mode) const;
+    int getShaperDelay(int mode, int order) const;
+    void configureTapeSolver(int mode);
+    void configureMotionInterpolation(int mode);
+    void resetShapers();
     void updateLatencyFromQuality(int mode);
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(BTZAudioProcessor)
@@ -0,0 +1,165 @@
+/*
+  Box Tone Zone (BTZ) - QualityEngines.cpp
+*/
+#include "QualityEngines.h"
+
+namespace {
+constexpr int numChannels = 2;
+
+std::unique_ptr<QualityEngines::Engine> createEngine(int slot, int renderStages, int maxBlockSize) {
+    using Engine = QualityEngines::Engine;
+    std::unique_ptr<Engine> engine;
+    if (slot == 0 || slot == 1)
+        engine = std::make_unique<Engine>(numChannels, (size_t) (slot + 1), Engine::filterHalfBandPolyphaseIIR, true, false);
+    else if (renderStages > 0)
+        // Linear-phase FIR half-band stages (maxQuality) for offline bounces only.
+        engine = std::make_unique<Engine>(numChannels, (size_t) renderStages, Engine::filterHalfBandFIREquiripple, true, true);
+    if (engine == nullptr)
+        return nullptr;
+    engine->setUsingIntegerLatency(true);
+    engine->initProcessing((size_t) juce::jmax(1, maxBlockSize));
+    engine->reset();
+    return engine;
+}
+}
+
+QualityEngines::~QualityEngines() {
+    release();
+}
+
+void QualityEngines::prepare(int maxBlockSize, int newRenderStages, int activeMode) {
+    const juce::ScopedLock sl(buildLock);
+    release();
+    maxBlock = juce::jmax(1, maxBlockSize);
+    renderStages = newRenderStages;
+
+    const int slot = slotFor(activeMode);
+    if (slot >= 0) {
+        active[(size_t) slot] = makeEngine(slot);
+        if (active[(size_t) slot] != nullptr)
+            state[(size_t) slot].store(owned);
+    }
+}
+
+void QualityEngines::release() {
+    for (int s = 0; s < numSlots; ++s) {
+        active[(size_t) s].reset();
+        delete handoff[(size_t) s].exchange(nullptr);
+        delete retired[(size_t) s].exchange(nullptr);
+        state[(size_t) s].store(none);
+    }
+    maxBlock = 0;
+}
+
+std::unique_ptr<QualityEngines::Engine> QualityEngines::makeEngine(int slot) const {
+    return createEngine(slot, renderStages, maxBlock);
+}
+
+void QualityEngines::build(int mode) {
+    const int slot = slotFor(mode);
+    if (slot < 0 || maxBlock <= 0)
+        return;
+
+    const juce::ScopedLock sl(buildLock);
+    // Only none -> requested can happen concurrently (audio thread), and built covers both.
+    const int s = state[(size_t) slot].load(std::memory_order_acquire);
+    if (s != none && s != requested)
+        return;
+    auto engine = makeEngine(slot);
+    if (engine == nullptr)
+        return;
+    handoff[(size_t) slot].store(engine.release(), std::memory_order_release);
+    state[(size_t) slot].store(built, std::memory_order_release);
+}
+
+void QualityEngines::service() {
+    for (int s = 0; s < numSlots; ++s) {
+        delete retired[(size_t) s].exchange(nullptr);
+        if (state[(size_t) s].load(std::memory_order_acquire) == requested)
+            build(s + 1);
+    }
+}
+
+bool QualityEngines::acquire(int mode) noexcept {
+    const int slot = slotFor(mode);
+    if (slot < 0)
+        return true;
+
+    auto& st = state[(size_t) slot];
+    int s = st.load(std::memory_order_acquire);
+    if (s == owned)
+        return true;
+    if (s == built) {
+        active[(size_t) slot].reset(handoff[(size_t) slot].exchange(nullptr, std::memory_order_acquire));
+        st.store(owned, std::memory_order_release);
+        return true;
+    }
+    if (s == none)
+        st.compare_exchange_strong(s, requested);
+    return false;
+}
+
+QualityEngines::Engine* QualityEngines::get(int mode) const noexcept {
+    const int slot = slotFor(mode);
+    return slot >= 0 ? active[(size_t) slot].get() : nullptr;
+}
+
+void QualityEngines::retireUnused(int activeMode, int standbyMode) noexcept {
+    const int keep = slotFor(activeMode);
+    const int standby = slotFor(standbyMode);
+    for (int s = 0; s < numSlots; ++s) {
+        if (s == keep || s == standby || (activeMode == renderMode && s != slotFor(renderMode)))
+            continue;
+        // A slot whose last engine is still waiting for deletion keeps this one for now.
+        if (retired[(size_t) s].load(std::memory_order_acquire) != nullptr)
+            continue;
+
+        auto& st = state[(size_t) s];
+        const int current = st.load(std::memory_order_acquire);
+        if (current == owned) {
+            retired[(size_t) s].store(active[(size_t) s].release(), std::memory_order_release);
+            st.store(none, std::memory_order_release);
+        } else if (current == built) {
+            retired[(size_t) s].store(handoff[(size_t) s].exchange(nullptr), std::memory_order_release);
+            st.store(none, std::memory_order_release);
+        }
+    }
+}
+
+int QualityEngines::getLatency(int mode, int stages) {
+    // [2x, 4x, 8x render, 16x render], measured on throwaway engines once per process.
+    static const std::array<int, 4> latencies = [] {
+        std::array<int, 4> result {};
+        for (int i = 0; i < 4; ++i) {
+            auto engine = createEngine(juce::jmin(i, 2), i < 2 ? 0 : i + 1, 1);
+            result[(size_t) i] = engine != nullptr ? (int) std::ceil(engine->getLatencyInSamples()) : 0;
+        }
+        return result;
+    }();
+
+    if (mode == 1 || mode == 2)
+        return latencies[(size_t) (mode - 1)];
+    if (mode == renderMode && stages > 0)
+        return latencies[stages >= 4 ? 3 : 2];
+    return 0;
+}
+
+size_t QualityEngines::estimateBytes(int slot) const noexcept {
+    const int stages = slot < 2 ? slot + 1 : renderStages;
+    size_t samples = 0;
+    for (int i = 1; i <= stages; ++i)
+        samples += (size_t) maxBlock << i;
+    return samples * numChannels * sizeof(float);
+}
+
+size_t QualityEngines::getMemoryBytes() const noexcept {
+    size_t bytes = 0;
+    for (int s = 0; s < numSlots; ++s) {
+        const int st = state[(size_t) s].load(std::memory_order_relaxed);
+        if (st == built || st == owned)
+            bytes += estimateBytes(s);
+        if (retired[(size_t) s].load(std::memory_order_relaxed) != nullptr)
+            bytes += estimateBytes(s);
+    }
+    return bytes;
+}
@@ -0,0 +1,71 @@
+/*
+  Box Tone Zone (BTZ) - QualityEngines.h
+*/
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <memory>
+
+// The oversamplers behind the quality modes: 2x and 4x polyphase IIR for
+// realtime, 8x/16x linear-phase FIR for offline render. An instance only holds
+// the engines it is using. prepare() builds the one for the active mode; when
+// the audio thread asks for another, acquire() flags it and returns false until
+// service() (message thread) or build() (any non-audio thread) has made it, and
+// engines the audio thread has switched away from are handed back through
+// retireUnused() and freed by service(). Each slot moves through
+// none -> requested -> built -> owned -> none, and every transition has exactly
+// one thread allowed to make it, so no locks touch the audio thread.
+//
+// Latencies do not depend on the rate or block size, so they are measured once
+// per process and can be reported for engines that were never built.
+class QualityEngines {
+public:
+    using Engine = juce::dsp::Oversampling<float>;
+
+    // Quality modes as used by the processor: 0 = Eco (no engine), 1 = 2x, 2 = 4x, 3 = render.
+    static constexpr int renderMode = 3;
+
+    ~QualityEngines();
+
+    // Not concurrent with the audio thread. renderStages: 0 = no render engine, 3 = 8x, 4 = 16x.
+    void prepare(int maxBlockSize, int renderStages, int activeMode);
+    void release();
+
+    // Any thread except the audio thread: builds the engine for mode now if it is missing.
+    void build(int mode);
+    // Message thread: builds requested engines and frees retired ones.
+    void service();
+
+    // Audio thread. True when mode can run now (Eco always can).
+    bool acquire(int mode) noexcept;
+    Engine* get(int mode) const noexcept;
+    // Audio thread, after switching to activeMode. Realtime engines stay while
+    // rendering so the return to realtime is immediate, and standbyMode's engine
+    // stays so a switch to it is too.
+    void retireUnused(int activeMode, int standbyMode = -1) noexcept;
+
+    static int getLatency(int mode, int renderStages);
+    int getRenderStages() const noexcept { return renderStages; }
+    // Estimated heap held by built engines (their per-stage block buffers).
+    size_t getMemoryBytes() const noexcept;
+
+private:
+    enum State { none, requested, built, owned };
+    static constexpr int numSlots = 3;
+
+    static int slotFor(int mode) noexcept { return mode >= 1 && mode <= renderMode ? mode - 1 : -1; }
+    std::unique_ptr<Engine> makeEngine(int slot) const;
+    size_t estimateBytes(int slot) const noexcept;
+
+    int maxBlock = 0;
+    int renderStages = 0;
+
+    std::array<std::atomic<int>, numSlots> state {};
+    std::array<std::atomic<Engine*>, numSlots> handoff {};   // built: message -> audio
+    std::array<std::atomic<Engine*>, numSlots> retired {};   // audio -> message, for deletion
+    std::array<std::unique_ptr<Engine>, numSlots> active;    // owned by the audio thread
+
+    juce::CriticalSection buildLock;   // builders only, never the audio thread
+};
@@ -0,0 +1,108 @@
+/*
+  Box Tone Zone (BTZ) - RenderPipeline.cpp
+*/
+#include "RenderPipeline.h"
+
+RenderPipeline::~RenderPipeline() {
+    release();
+}
+
+void RenderPipeline::prepare(int numStages, int numSlots, int numWorkers) {
+    if (numStages != getNumStages() || numWorkers != getNumWorkers())
+        release();
+
+    slots = juce::jmax(1, numSlots);
+    done.assign((size_t) numStages, 0);
+    running.assign((size_t) numStages, 0);
+    exclusionGroup.assign((size_t) numStages, -1);
+
+    if (workers.empty()) {
+        stopping = false;
+        for (int i = 0; i < numWorkers; ++i)
+            workers.emplace_back([this] { workerLoop(); });
+    }
+}
+
+void RenderPipeline::release() {
+    {
+        const std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    changed.notify_all();
+    for (auto& w : workers)
+        w.join();
+    workers.clear();
+}
+
+void RenderPipeline::run(int units, const Task& taskToRun) {
+    std::unique_lock<std::mutex> lock(mutex);
+    task = &taskToRun;
+    numUnits = units;
+    std::fill(done.begin(), done.end(), 0);
+    std::fill(running.begin(), running.end(), 0);
+    ++generation;
+    changed.notify_all();
+
+    work(lock);
+    // Workers that joined late leave as soon as they see the run is complete.
+    changed.wait(lock, [this] { return activeWorkers == 0; });
+    task = nullptr;
+}
+
+void RenderPipeline::workerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    unsigned seen = generation;
+    for (;;) {
+        changed.wait(lock, [this, seen] { return stopping || generation != seen; });
+        if (stopping)
+            return;
+        seen = generation;
+        ++activeWorkers;
+        work(lock);
+        --activeWorkers;
+        changed.notify_all();
+    }
+}
+
+void RenderPipeline::work(std::unique_lock<std::mutex>& lock) {
+    const int lastStage = getNumStages() - 1;
+    while (done[(size_t) lastStage] < numUnits) {
+        const int stage = findReadyStage();
+        if (stage < 0) {
+            changed.wait(lock);
+            continue;
+        }
+
+        const int unit = done[(size_t) stage];
+        running[(size_t) stage] = 1;
+        lock.unlock();
+        (*task)(stage, unit, unit % slots);
+        lock.lock();
+        running[(size_t) stage] = 0;
+        ++done[(size_t) stage];
+        changed.notify_all();
+    }
+}
+
+// Later stages first, so units drain and free their slots before new ones enter.
+int RenderPipeline::findReadyStage() const noexcept {
+    const int lastStage = getNumStages() - 1;
+    for (int s = lastStage; s >= 0; --s) {
+        const int next = done[(size_t) s];
+        if (running[(size_t) s] || next >= numUnits)
+            continue;
+        const bool inputReady = s == 0 ? next - done[(size_t) lastStage] < slots : done[(size_t) s - 1] > next;
+        if (inputReady && ! isGroupBusy(exclusionGroup[(size_t) s]))
+            return s;
+    }
+    return -1;
+}
+
+bool RenderPipeline::isGroupBusy(int group) const noexcept {
+    if (group < 0)
+        return false;
+    for (size_t s = 0; s < running.size(); ++s)
+        if (running[s] && exclusionGroup[s] == group)
+            return true;
+    return false;
+}
@@ -0,0 +1,63 @@
+/*
+  Box Tone Zone (BTZ) - RenderPipeline.h
+*/
+#pragma once
+
+#include <JuceHeader.h>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Software pipeline for large offline blocks. A block is cut into units that
+// flow through a fixed chain of stages; each stage takes its units strictly in
+// order, one at a time, on whichever thread is free. A stage's state is therefore
+// only ever touched by one thread at a time and sees exactly the calls a serial
+// run would make, so the output matches running every stage of every unit in
+// sequence. At most numSlots units are in flight (the bounded queue between the
+// stages), and stages in the same exclusion group never run at once, for stages
+// that share an object. The workers persist between blocks and the calling
+// thread works too. Scheduling takes a lock, so this is for offline rendering only.
+class RenderPipeline {
+public:
+    // stage, unit index within the block, slot (unit % numSlots) holding its hand-off data.
+    using Task = std::function<void(int stage, int unit, int slot)>;
+
+    ~RenderPipeline();
+
+    // Not concurrent with run(). Sizes the bookkeeping and (re)starts the workers.
+    void prepare(int numStages, int numSlots, int numWorkers);
+    void release();
+
+    int getNumStages() const noexcept { return (int) done.size(); }
+    int getNumSlots() const noexcept { return slots; }
+    int getNumWorkers() const noexcept { return (int) workers.size(); }
+
+    // Not concurrent with run(). group < 0: the stage excludes nothing.
+    void setExclusionGroup(int stage, int group) noexcept { exclusionGroup[(size_t) stage] = group; }
+
+    // Runs every stage of units [0, numUnits) and returns when all are through.
+    void run(int numUnits, const Task& task);
+
+private:
+    void workerLoop();
+    // Called with the lock held; returns when the current run is complete.
+    void work(std::unique_lock<std::mutex>& lock);
+    int findReadyStage() const noexcept;
+    bool isGroupBusy(int group) const noexcept;
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable changed;
+
+    // Guarded by mutex.
+    const Task* task = nullptr;
+    int numUnits = 0, slots = 1;
+    std::vector<int> done;          // units finished per stage
+    std::vector<char> running;      // per stage
+    std::vector<int> exclusionGroup;
+    unsigned generation = 0;
+    int activeWorkers = 0;
+    bool stopping = false;
+};
@@ -0,0 +1,46 @@
+/*
+  Box Tone Zone (BTZ) - SidechainDetector.cpp
+*/
+#include "SidechainDetector.h"
+
+namespace {
+constexpr float gateKeyQ = 1.2f;
+constexpr float gateKeyReleaseMs = 10.0f;
+}
+
+void SidechainDetector::prepare(double sampleRate, int maxBlockSize) {
+    rate = juce::jmax(1.0, sampleRate);
+    gateKey.assign((size_t) juce::jmax(1, maxBlockSize), 0.0f);
+    release = Vec4::broadcast(std::exp(-1.0f / ((float) rate * gateKeyReleaseMs * 0.001f)));
+
+    const float gate = gateHz > 0.0f ? gateHz : 120.0f;
+    gateHz = 0.0f;
+    setGateBandPass(gate);
+    reset();
+}
+
+void SidechainDetector::reset() {
+    filter.reset();
+    envelope = Vec4::zero();
+    numProcessed = 0;
+}
+
+void SidechainDetector::setGateBandPass(float hz) noexcept {
+    if (std::abs(hz - gateHz) < 0.01f)
+        return;
+    gateHz = hz;
+    for (int lane = 0; lane < 4; ++lane)
+        filter.setLane(lane, hz, rate, gateKeyQ, SvfLanes::bandPass);
+}
+
+void SidechainDetector::process(const float* dataL, const float* dataR, int numSamples) noexcept {
+    numProcessed = juce::jmin(numSamples, (int) gateKey.size());
+    for (int n = 0; n < numProcessed; ++n) {
+        const Vec4 rectified = Vec4::abs(filter.process(Vec4::set(dataL[n], dataR[n], 0.0f, 0.0f)));
+        envelope = Vec4::max(rectified, envelope * release);
+
+        float e[4];
+        envelope.store(e);
+        gateKey[(size_t) n] = juce::jmax(e[0], e[1]);
+    }
+}
@@ -0,0 +1,35 @@
+/*
+  Box Tone Zone (BTZ) - SidechainDetector.h
+*/
+#pragma once
+
+#include "CrossoverBank.h"
+#include <vector>
+
+// Gate key, run once per host block ahead of the gate. One SVF tick per sample
+// band-passes [L, R] in two lanes, rectifies them and runs a peak envelope, so
+// the whole detector stays in one register with no per-lane branches. (Glue keys
+// from the signal at its own point in the core, see GlueCompressor.)
+class SidechainDetector {
+public:
+    void prepare(double sampleRate, int maxBlockSize);
+    void reset();
+    size_t getMemoryBytes() const noexcept { return gateKey.size() * sizeof(float); }
+
+    void setGateBandPass(float hz) noexcept;
+
+    void process(const float* dataL, const float* dataR, int numSamples) noexcept;
+
+    // Valid for the last processed block, indexed by host sample.
+    int getNumSamples() const noexcept { return numProcessed; }
+    const float* getGateKey() const noexcept { return gateKey.data(); }
+
+private:
+    SvfLanes filter;
+    double rate = 48000.0;
+    float gateHz = 0.0f;
+
+    Vec4 envelope = Vec4::zero(), release = Vec4::zero();
+    std::vector<float> gateKey;
+    int numProcessed = 0;
+};
@@ -0,0 +1,81 @@
+/*
+  Box Tone Zone (BTZ) - SimdVec.h
+*/
+#pragma once
+
+// Four-lane float vector for the hand-vectorised DSP kernels. Maps to SSE2 on
+// x86-64, NEON on ARM64 and a plain struct elsewhere, so kernels are written once.
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+ #include <emmintrin.h>
+ #define BTZ_SIMD_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+ #include <arm_neon.h>
+ #define BTZ_SIMD_NEON 1
+#endif
+
+#include <cmath>
+
+struct Vec4 {
+#if BTZ_SIMD_SSE2
+    __m128 v;
+    static Vec4 load(const float* p) { return { _mm_loadu_ps(p) }; }
+    static Vec4 broadcast(float x) { return { _mm_set1_ps(x) }; }
+    static Vec4 zero() { return { _mm_setzero_ps() }; }
+    static Vec4 set(float a, float b, float c, float d) { return { _mm_setr_ps(a, b, c, d) }; }
+    void store(float* p) const { _mm_storeu_ps(p, v); }
+    friend Vec4 operator+(Vec4 a, Vec4 b) { return { _mm_add_ps(a.v, b.v) }; }
+    friend Vec4 operator-(Vec4 a, Vec4 b) { return { _mm_sub_ps(a.v, b.v) }; }
+    friend Vec4 operator*(Vec4 a, Vec4 b) { return { _mm_mul_ps(a.v, b.v) }; }
+    friend Vec4 operator/(Vec4 a, Vec4 b) { return { _mm_div_ps(a.v, b.v) }; }
+    static Vec4 max(Vec4 a, Vec4 b) { return { _mm_max_ps(a.v, b.v) }; }
+    static Vec4 min(Vec4 a, Vec4 b) { return { _mm_min_ps(a.v, b.v) }; }
+    static Vec4 abs(Vec4 a) { return { _mm_and_ps(a.v, _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF))) }; }
+    // Lane-wise select: mask lanes are all-ones where the comparison held.
+    static Vec4 greaterThan(Vec4 a, Vec4 b) { return { _mm_cmpgt_ps(a.v, b.v) }; }
+    static Vec4 select(Vec4 mask, Vec4 a, Vec4 b) { return { _mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v)) }; }
+    float sum() const {
+        __m128 s = _mm_add_ps(v, _mm_movehl_ps(v, v));
+        s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+        return _mm_cvtss_f32(s);
+    }
+#elif BTZ_SIMD_NEON
+    float32x4_t v;
+    static Vec4 load(const float* p) { return { vld1q_f32(p) }; }
+    static Vec4 broadcast(float x) { return { vdupq_n_f32(x) }; }
+    static Vec4 zero() { return { vdupq_n_f32(0.0f) }; }
+    static Vec4 set(float a, float b, float c, float d) { const float t[4] = { a, b, c, d }; return load(t); }
+    void store(float* p) const { vst1q_f32(p, v); }
+    friend Vec4 operator+(Vec4 a, Vec4 b) { return { vaddq_f32(a.v, b.v) }; }
+    friend Vec4 operator-(Vec4 a, Vec4 b) { return { vsubq_f32(a.v, b.v) }; }
+    friend Vec4 operator*(Vec4 a, Vec4 b) { return { vmulq_f32(a.v, b.v) }; }
+    friend Vec4 operator/(Vec4 a, Vec4 b) { return { vdivq_f32(a.v, b.v) }; }
+    static Vec4 max(Vec4 a, Vec4 b) { return { vmaxq_f32(a.v, b.v) }; }
+    static Vec4 min(Vec4 a, Vec4 b) { return { vminq_f32(a.v, b.v) }; }
+    static Vec4 abs(Vec4 a) { return { vabsq_f32(a.v) }; }
+    static Vec4 greaterThan(Vec4 a, Vec4 b) { return { vreinterpretq_f32_u32(vcgtq_f32(a.v, b.v)) }; }
+    static Vec4 select(Vec4 mask, Vec4 a, Vec4 b) { return { vbslq_f32(vreinterpretq_u32_f32(mask.v), a.v, b.v) }; }
+    float sum() const { return vaddvq_f32(v); }
+#else
+    float v[4];
+    static Vec4 load(const float* p) { return { { p[0], p[1], p[2], p[3] } }; }
+    static Vec4 broadcast(float x) { return { { x, x, x, x } }; }
+    static Vec4 zero() { return broadcast(0.0f); }
+    static Vec4 set(float a, float b, float c, float d) { return { { a, b, c, d } }; }
+    void store(float* p) const { for (int i = 0; i < 4; ++i) p[i] = v[i]; }
+    template <typename Op> static Vec4 map(Vec4 a, Vec4 b, Op op) { Vec4 r; for (int i = 0; i < 4; ++i) r.v[i] = op(a.v[i], b.v[i]); return r; }
+    friend Vec4 operator+(Vec4 a, Vec4 b) { return map(a, b, [](float x, float y) { return x + y; }); }
+    friend Vec4 operator-(Vec4 a, Vec4 b) { return map(a, b, [](float x, float y) { return x - y; }); }
+    friend Vec4 operator*(Vec4 a, Vec4 b) { return map(a, b, [](float x, float y) { return x * y; }); }
+    friend Vec4 operator/(Vec4 a, Vec4 b) { return map(a, b, [](float x, float y) { return x / y; }); }
+    static Vec4 max(Vec4 a, Vec4 b) { return map(a, b, [](float x, float y) { return x > y ? x : y; }); }
+    static Vec4 min(Vec4 a, Vec4 b) { return map(a, b, [](float x, float y) { return x < y ? x : y; }); }
+    static Vec4 abs(Vec4 a) { return map(a, a, [](float x, float) { return std::abs(x); }); }
+    static Vec4 greaterThan(Vec4 a, Vec4 b) { return map(a, b, [](float x, float y) { return x > y ? 1.0f : 0.0f; }); }
+    static Vec4 select(Vec4 mask, Vec4 a, Vec4 b) { Vec4 r; for (int i = 0; i < 4; ++i) r.v[i] = mask.v[i] != 0.0f ? a.v[i] : b.v[i]; return r; }
+    float sum() const { return v[0] + v[1] + v[2] + v[3]; }
+#endif
+
+    static Vec4 mulAdd(Vec4 acc, Vec4 a, Vec4 b) { return acc + a * b; }
+    static Vec4 clamp(Vec4 x, Vec4 lo, Vec4 hi) { return min(max(x, lo), hi); }
+    float lane(int i) const { float t[4]; store(t); return t[i]; }
+};
@@ -0,0 +1,221 @@
+/*
+  Box Tone Zone (BTZ) - TapeHysteresis.cpp
+*/
+#include "TapeHysteresis.h"
+
+namespace {
+constexpr float seriesLimit = 0.3f;
+constexpr float tableMax = 16.0f;
+constexpr int tableResolution = 64;
+constexpr int tableSize = (int) tableMax * tableResolution + 2;
+constexpr float differentiatorDamping = 0.75f;
+constexpr int activeLanes = 2;   // L/R; lanes 2-3 stay at zero
+
+struct LangevinValues {
+    float l, dl, ddl;
+};
+
+static inline LangevinValues langevin(float x) noexcept {
+    if (std::abs(x) < seriesLimit) {
+        const float x2 = x * x;
+        return { x * (1.0f / 3.0f - x2 / 45.0f), 1.0f / 3.0f - x2 / 15.0f, x * (-2.0f / 15.0f + x2 * (4.0f / 189.0f)) };
+    }
+    const float ct = 1.0f / std::tanh(x);
+    const float inv = 1.0f / x;
+    return { ct - inv, inv * inv - ct * ct + 1.0f, 2.0f * ct * (ct * ct - 1.0f) - 2.0f * inv * inv * inv };
+}
+
+// Odd/even/odd symmetric, so only x >= 0 is stored.
+std::vector<LangevinValues>& langevinTable() {
+    static std::vector<LangevinValues> table;
+    return table;
+}
+}
+
+void LangevinExact::eval(Vec4 x, Vec4& l, Vec4& dl, Vec4& ddl) noexcept {
+    float xs[4], ls[4] = {}, dls[4] = { 0.0f, 0.0f, 1.0f / 3.0f, 1.0f / 3.0f }, ddls[4] = {};
+    x.store(xs);
+    for (int i = 0; i < activeLanes; ++i) {
+        const auto v = langevin(xs[i]);
+        ls[i] = v.l;
+        dls[i] = v.dl;
+        ddls[i] = v.ddl;
+    }
+    l = Vec4::load(ls);
+    dl = Vec4::load(dls);
+    ddl = Vec4::load(ddls);
+}
+
+void LangevinTable::ensureTable() {
+    // Thread-safe one-time build; called from prepare(), never from the audio thread.
+    static const bool built = [] {
+        auto& table = langevinTable();
+        table.resize((size_t) tableSize);
+        for (int i = 0; i < tableSize; ++i)
+            table[(size_t) i] = langevin((float) i / (float) tableResolution);
+        return true;
+    }();
+    juce::ignoreUnused(built);
+}
+
+void LangevinTable::eval(Vec4 x, Vec4& l, Vec4& dl, Vec4& ddl) noexcept {
+    const auto& table = langevinTable();
+    float xs[4], ls[4] = {}, dls[4] = { 0.0f, 0.0f, 1.0f / 3.0f, 1.0f / 3.0f }, ddls[4] = {};
+    x.store(xs);
+    for (int i = 0; i < activeLanes; ++i) {
+        const float ax = std::abs(xs[i]);
+        const float sign = xs[i] < 0.0f ? -1.0f : 1.0f;
+        if (ax >= tableMax) {
+            // coth(x) == 1 to float precision out here.
+            const float inv = 1.0f / ax;
+            ls[i] = sign * (1.0f - inv);
+            dls[i] = inv * inv;
+            ddls[i] = -sign * 2.0f * inv * inv * inv;
+            continue;
+        }
+        const float pos = ax * (float) tableResolution;
+        const int idx = (int) pos;
+        const float frac = pos - (float) idx;
+        const auto& p0 = table[(size_t) idx];
+        const auto& p1 = table[(size_t) idx + 1];
+        ls[i] = sign * (p0.l + frac * (p1.l - p0.l));
+        dls[i] = p0.dl + frac * (p1.dl - p0.dl);
+        ddls[i] = sign * (p0.ddl + frac * (p1.ddl - p0.ddl));
+    }
+    l = Vec4::load(ls);
+    dl = Vec4::load(dls);
+    ddl = Vec4::load(ddls);
+}
+
+//==============================================================================
+TapeHysteresis::TapeHysteresis() {
+    LangevinTable::ensureTable();
+    setParameters(0.5f, 0.5f);
+}
+
+void TapeHysteresis::prepare(double sampleRate) {
+    LangevinTable::ensureTable();
+    T = (float) (1.0 / juce::jmax(1.0, sampleRate));
+    diffGain = (1.0f + differentiatorDamping) / T;
+    reset();
+}
+
+void TapeHysteresis::reset() {
+    m = hPrev = hdPrev = fPrev = Vec4::zero();
+}
+
+void TapeHysteresis::setParameters(float newDrive, float width) {
+    c = juce::jlimit(0.05f, 0.95f, std::sqrt(1.0f - juce::jlimit(0.0f, 1.0f, width)) - 0.01f);
+    updateDrive(newDrive);
+}
+
+void TapeHysteresis::updateDrive(float newDrive) noexcept {
+    drive = newDrive;
+    a = ms / (0.01f + 6.0f * juce::jlimit(0.0f, 1.0f, newDrive));
+    // Inverse small-signal gain: anhysteretic susceptibility (L'(0) = 1/3) times the
+    // measured ~-3 dB of the irreversible lag, so low levels pass at unity.
+    makeup = 1.41f * (3.0f * a - alpha * ms) / ms;
+}
+
+void TapeHysteresis::setSolver(Solver newSolver, int newtonIterations) noexcept {
+    if (newSolver != solver)
+        fPrev = Vec4::zero();
+    solver = newSolver;
+    iterations = juce::jlimit(1, 16, newtonIterations);
+}
+
+// f(M) = dM/dH * dH/dt and, for the Newton solver, df/dM.
+template <typename Langevin, bool withDerivative>
+Vec4 TapeHysteresis::slope(Vec4 mag, Vec4 h, Vec4 hd, Vec4* dSlopeDm) const noexcept {
+    const Vec4 one = Vec4::broadcast(1.0f);
+    const Vec4 zero = Vec4::zero();
+    const Vec4 msV = Vec4::broadcast(ms), alphaV = Vec4::broadcast(alpha);
+    const Vec4 invA = Vec4::broadcast(1.0f / a);
+    const Vec4 oneMinusC = Vec4::broadcast(1.0f - c);
+    const Vec4 revScale = Vec4::broadcast(c * ms / a);
+
+    Vec4 l, dl, ddl;
+    Langevin::eval((h + alphaV * mag) * invA, l, dl, ddl);
+
+    const Vec4 diff = msV * l - mag;
+    const Vec4 delta = Vec4::select(Vec4::greaterThan(hd, zero), one, Vec4::broadcast(-1.0f));
+    const Vec4 deltaM = Vec4::select(Vec4::greaterThan(delta * diff, zero), one, zero);
+
+    // Keep the irreversible denominator away from zero without flipping its sign.
+    Vec4 denIrr = oneMinusC * delta * Vec4::broadcast(k) - alphaV * diff;
+    const Vec4 eps = Vec4::broadcast(1.0e-4f);
+    denIrr = Vec4::select(Vec4::greaterThan(Vec4::abs(denIrr), eps), denIrr, Vec4::select(Vec4::greaterThan(denIrr, zero), eps, zero - eps));
+
+    const Vec4 irr = oneMinusC * deltaM * diff / denIrr;
+    const Vec4 num = irr + revScale * dl;
+    const Vec4 den = one - revScale * alphaV * dl;
+    const Vec4 dMdH = num / den;
+
+    if constexpr (withDerivative) {
+        const Vec4 dq = alphaV * invA;                       // dQ/dM
+        const Vec4 dDiff = msV * dl * dq - one;
+        const Vec4 dDenIrr = zero - alphaV * dDiff;
+        const Vec4 dIrr = oneMinusC * deltaM * (dDiff * denIrr - diff * dDenIrr) / (denIrr * denIrr);
+        const Vec4 dNum = dIrr + revScale * ddl * dq;
+        const Vec4 dDen = zero - revScale * alphaV * ddl * dq;
+        *dSlopeDm = (dNum * den - num * dDen) / (den * den) * hd;
+    } else {
+        juce::ignoreUnused(ddl, dSlopeDm);
+    }
+    return dMdH * hd;
+}
+
+template <typename Langevin>
+Vec4 TapeHysteresis::stepRK2(Vec4 h, Vec4 hd) noexcept {
+    const Vec4 t = Vec4::broadcast(T), half = Vec4::broadcast(0.5f);
+    const Vec4 k1 = t * slope<Langevin, false>(m, hPrev, hdPrev);
+    const Vec4 k2 = t * slope<Langevin, false>(m + half * k1, half * (h + hPrev), half * (hd + hdPrev));
+    return m + k2;
+}
+
+template <typename Langevin>
+Vec4 TapeHysteresis::stepRK4(Vec4 h, Vec4 hd) noexcept {
+    const Vec4 t = Vec4::broadcast(T), half = Vec4::broadcast(0.5f);
+    const Vec4 hMid = half * (h + hPrev), hdMid = half * (hd + hdPrev);
+    const Vec4 k1 = t * slope<Langevin, false>(m, hPrev, hdPrev);
+    const Vec4 k2 = t * slope<Langevin, false>(m + half * k1, hMid, hdMid);
+    const Vec4 k3 = t * slope<Langevin, false>(m + half * k2, hMid, hdMid);
+    const Vec4 k4 = t * slope<Langevin, false>(m + k3, h, hd);
+    return m + (k1 + Vec4::broadcast(2.0f) * (k2 + k3) + k4) * Vec4::broadcast(1.0f / 6.0f);
+}
+
+// Implicit trapezoidal rule: solve g(M) = M - M[n-1] - T/2 (f[n-1] + f(M)) = 0.
+template <typename Langevin>
+Vec4 TapeHysteresis::stepNewton(Vec4 h, Vec4 hd) noexcept {
+    const Vec4 halfT = Vec4::broadcast(0.5f * T);
+    const Vec4 one = Vec4::broadcast(1.0f), minDg = Vec4::broadcast(0.1f);
+    Vec4 mag = m + Vec4::broadcast(T) * fPrev;
+    Vec4 f = fPrev;
+    for (int i = 0; i < iterations; ++i) {
+        Vec4 df;
+        f = slope<Langevin, true>(mag, h, hd, &df);
+        const Vec4 g = mag - m - halfT * (fPrev + f);
+        const Vec4 dg = Vec4::max(one - halfT * df, minDg);
+        mag = mag - g / dg;
+    }
+    fPrev = f;
+    return mag;
+}
+
+Vec4 TapeHysteresis::processLanes(Vec4 h) noexcept {
+    const Vec4 hd = Vec4::broadcast(diffGain) * (h - hPrev) - Vec4::broadcast(differentiatorDamping) * hdPrev;
+
+    Vec4 next;
+    switch (solver) {
+        case rk4:           next = useTable ? stepRK4<LangevinTable>(h, hd) : stepRK4<LangevinExact>(h, hd); break;
+        case newtonRaphson: next = useTable ? stepNewton<LangevinTable>(h, hd) : stepNewton<LangevinExact>(h, hd); break;
+        case rk2:
+        default:            next = useTable ? stepRK2<LangevinTable>(h, hd) : stepRK2<LangevinExact>(h, hd); break;
+    }
+
+    // |M| <= Ms physically; the clamp also bounds a runaway step.
+    m = Vec4::clamp(next, Vec4::broadcast(-ms), Vec4::broadcast(ms));
+    hPrev = h;
+    hdPrev = hd;
+    return m * Vec4::broadcast(makeup);
+}
@@ -0,0 +1,460 @@
+/*
+  Box Tone Zone (BTZ) - TimbralMatch.cpp
+*/
+#include "TimbralMatch.h"
+
+namespace {
+constexpr double gridLowHz = 20.0, gridHighHz = 20000.0;
+constexpr double bandHalfWidth = 1.122462048;   // 2^(1/6): third-octave bands
+constexpr float maxCurveDb = 12.0f;
+constexpr float normaliseLowHz = 60.0f, normaliseHighHz = 12000.0f;
+constexpr double maxReferenceSeconds = 120.0;
+constexpr double crossfadeSeconds = 0.03;
+constexpr double designIntervalSeconds = 1.0;
+
+// One Hann window per size, shared by every instance.
+template <int size>
+const float* hannWindow() {
+    static const std::vector<float> table = [] {
+        std::vector<float> t((size_t) size);
+        juce::dsp::WindowingFunction<float>::fillWindowingTables(t.data(), (size_t) size,
+                                                                juce::dsp::WindowingFunction<float>::hann, false);
+        return t;
+    }();
+    return table.data();
+}
+
+static int fftOrderFor(int size) {
+    int order = 0;
+    while ((1 << order) < size)
+        ++order;
+    return order;
+}
+}
+
+float TimbralMatch::gridHz(int point) {
+    return (float) (gridLowHz * std::pow(gridHighHz / gridLowHz, (double) point / (curvePoints - 1)));
+}
+
+void TimbralMatch::assertNotAudioThread() const noexcept {
+#if JUCE_DEBUG
+    jassert(audioThread.load(std::memory_order_relaxed) != juce::Thread::getCurrentThreadId());
+#endif
+}
+
+TimbralMatch::TimbralMatch() : juce::Thread("BTZ Timbral Match") {}
+
+TimbralMatch::~TimbralMatch() {
+    release();
+    delete pending.exchange(nullptr);
+    delete retired.exchange(nullptr);
+}
+
+void TimbralMatch::prepare(double sampleRate, int maxBlockSize) {
+    release();
+#if JUCE_DEBUG
+    audioThread.store(nullptr, std::memory_order_relaxed);
+#endif
+
+    // The analysis side is only needed once the worker runs.
+    if (analysisFft == nullptr) {
+        analysisFft = std::make_unique<juce::dsp::FFT>(fftOrderFor(frameSize));
+        fifoData.assign((size_t) fifoSize, 0.0f);
+        frame.assign((size_t) frameSize, 0.0f);
+        fftData.assign((size_t) (2 * frameSize), 0.0f);
+        window = hannWindow<frameSize>();
+    }
+
+    preparedRate = sampleRate;
+    // About 40 ms of FIR (2048 taps at 48 kHz): ~23 Hz resolution, ample for a third-octave curve.
+    firLength = juce::nextPowerOfTwo(juce::roundToInt(0.04 * sampleRate));
+    wetBuffer.setSize(2, juce::jmax(1, maxBlockSize), false, false, true);
+    incomingBuffer.setSize(2, juce::jmax(1, maxBlockSize), false, false, true);
+    fadeLength = juce::jmax(1, (int) (crossfadeSeconds * sampleRate));
+    fadePos = 0;
+
+    // Not playing here: engines built for another rate are dropped and redesigned.
+    active.reset();
+    incoming.reset();
+    parked.reset();
+    delete pending.exchange(nullptr);
+    delete retired.exchange(nullptr);
+    fifo.reset();
+    frameFill = 0;
+    designedAmount = -1.0f;
+    curveChanged = hasCurve();
+
+    startThread(juce::Thread::Priority::low);
+}
+
+void TimbralMatch::release() {
+    stopThread(2000);
+}
+
+size_t TimbralMatch::getMemoryBytes() const noexcept {
+    size_t bytes = (fifoData.size() + frame.size() + fftData.size()) * sizeof(float);
+    bytes += (size_t) (wetBuffer.getNumChannels() * wetBuffer.getNumSamples()
+                     + incomingBuffer.getNumChannels() * incomingBuffer.getNumSamples()) * sizeof(float);
+    for (auto* convolver : { active.get(), incoming.get(), parked.get() })
+        if (convolver != nullptr)
+            bytes += convolver->getMemoryBytes();
+    return bytes;
+}
+
+void TimbralMatch::reset() {
+    if (active != nullptr)
+        active->reset();
+    if (incoming != nullptr)
+        incoming->reset();
+}
+
+void TimbralMatch::setReferenceFile(const juce::File& file) {
+    {
+        const juce::ScopedLock sl(curveLock);
+        referenceFile = file;
+    }
+    referenceRequested = true;
+}
+
+juce::File TimbralMatch::getReferenceFile() const {
+    const juce::ScopedLock sl(curveLock);
+    return referenceFile;
+}
+
+void TimbralMatch::setLearning(Learn target) {
+    learning = target;
+}
+
+bool TimbralMatch::hasCurve() const {
+    const juce::ScopedLock sl(curveLock);
+    return curveValid;
+}
+
+// The lock only covers the fixed-size copy; the vector is built outside it.
+std::vector<float> TimbralMatch::getCurve() const {
+    assertNotAudioThread();
+    Curve copy;
+    bool valid;
+    {
+        const juce::ScopedLock sl(curveLock);
+        copy = curve;
+        valid = curveValid;
+    }
+    return valid ? std::vector<float>(copy.begin(), copy.end()) : std::vector<float>();
+}
+
+void TimbralMatch::setCurve(const std::vector<float>& curveDb) {
+    assertNotAudioThread();
+    const bool valid = (int) curveDb.size() == curvePoints;
+    Curve limited {};
+    if (valid)
+        for (int p = 0; p < curvePoints; ++p)
+            limited[(size_t) p] = juce::jlimit(-maxCurveDb, maxCurveDb, curveDb[(size_t) p]);
+    {
+        const juce::ScopedLock sl(curveLock);
+        curve = limited;
+        curveValid = valid;
+    }
+    curveChanged = true;
+}
+
+//==============================================================================
+void TimbralMatch::pushLearning(const float* left, const float* right, int numSamples) noexcept {
+    // If the worker is behind, drop this block rather than wait for space.
+    if (fifo.getFreeSpace() < numSamples)
+        return;
+
+    int start1, size1, start2, size2;
+    fifo.prepareToWrite(numSamples, start1, size1, start2, size2);
+    for (int i = 0; i < size1; ++i)
+        fifoData[(size_t) (start1 + i)] = 0.5f * (left[i] + right[i]);
+    for (int i = 0; i < size2; ++i)
+        fifoData[(size_t) (start2 + i)] = 0.5f * (left[size1 + i] + right[size1 + i]);
+    fifo.finishedWrite(size1 + size2);
+}
+
+void TimbralMatch::run() {
+    Learn lastLearning = Learn::off;
+    while (! threadShouldExit()) {
+        delete retired.exchange(nullptr);
+
+        if (referenceRequested.exchange(false) && loadReference(getReferenceFile()))
+            updateCurve();
+
+        // A new learn pass starts that spectrum from scratch.
+        const Learn target = learning.load();
+        if (target != lastLearning) {
+            if (target == Learn::source) {
+                sourceFrames = 0;
+                sourceBands.fill(0.0);
+            } else if (target == Learn::reference) {
+                referenceFrames = 0;
+                referenceBands.fill(0.0);
+            }
+            if (lastLearning != Learn::off)
+                updateCurve();
+            lastLearning = target;
+            frameFill = 0;
+            framesSinceDesign = 0;
+        }
+
+        int ready = fifo.getNumReady();
+        while (ready > 0 && ! threadShouldExit()) {
+            const int take = juce::jmin(ready, frameSize - frameFill);
+            int start1, size1, start2, size2;
+            fifo.prepareToRead(take, start1, size1, start2, size2);
+            std::copy(fifoData.data() + start1, fifoData.data() + start1 + size1, frame.data() + frameFill);
+            std::copy(fifoData.data() + start2, fifoData.data() + start2 + size2, frame.data() + frameFill + size1);
+            fifo.finishedRead(size1 + size2);
+            frameFill += size1 + size2;
+            ready -= size1 + size2;
+
+            if (frameFill == frameSize) {
+                if (target != Learn::off)
+                    analyseFrame();
+                std::copy(frame.begin() + hopSize, frame.end(), frame.begin());
+                frameFill = frameSize - hopSize;
+            }
+        }
+
+        // Refresh the match about once a second while learning.
+        if (target != Learn::off && framesSinceDesign >= (int) (designIntervalSeconds * preparedRate / hopSize)) {
+            framesSinceDesign = 0;
+            updateCurve();
+        }
+
+        const float amount = requestedAmount.load();
+        if (curveChanged.exchange(false) || std::abs(amount - designedAmount) > 0.005f)
+            if (hasCurve())
+                design(amount);
+
+        wait(20);
+    }
+}
+
+void TimbralMatch::analyseFrame() {
+    for (int i = 0; i < frameSize; ++i)
+        fftData[(size_t) i] = frame[(size_t) i] * window[(size_t) i];
+    std::fill(fftData.begin() + frameSize, fftData.end(), 0.0f);
+    analysisFft->performFrequencyOnlyForwardTransform(fftData.data(), true);
+
+    if (learning.load() == Learn::reference) {
+        addFrameToBands(fftData.data(), frameSize, preparedRate, referenceBands);
+        ++referenceFrames;
+    } else {
+        addFrameToBands(fftData.data(), frameSize, preparedRate, sourceBands);
+        ++sourceFrames;
+    }
+    ++framesSinceDesign;
+}
+
+void TimbralMatch::addFrameToBands(const float* magnitude, int fftSize, double rate, Bands& bands) const {
+    const double binHz = rate / fftSize;
+    const int lastBin = fftSize / 2;
+    for (int p = 0; p < curvePoints; ++p) {
+        const double centre = gridHz(p);
+        int lo = (int) std::ceil(centre / bandHalfWidth / binHz);
+        int hi = (int) std::floor(centre * bandHalfWidth / binHz);
+        if (lo > hi)
+            lo = hi = juce::roundToInt(centre / binHz);   // band narrower than a bin
+        if (lo > lastBin)
+            break;   // above Nyquist: left at zero, filled in by updateCurve()
+        hi = juce::jmin(hi, lastBin);
+
+        double power = 0.0;
+        for (int b = juce::jmax(1, lo); b <= hi; ++b)
+            power += (double) magnitude[b] * magnitude[b];
+        bands[(size_t) p] += power / (double) juce::jmax(1, hi - juce::jmax(1, lo) + 1);
+    }
+}
+
+bool TimbralMatch::loadReference(const juce::File& file) {
+    juce::AudioFormatManager formats;
+    formats.registerBasicFormats();
+    std::unique_ptr<juce::AudioFormatReader> reader(file.existsAsFile() ? formats.createReaderFor(file) : nullptr);
+    if (reader == nullptr || reader->lengthInSamples < frameSize || reader->sampleRate <= 0.0)
+        return false;
+
+    const int channels = juce::jlimit(1, 2, (int) reader->numChannels);
+    const juce::int64 length = juce::jmin<juce::int64>(reader->lengthInSamples, (juce::int64) (reader->sampleRate * maxReferenceSeconds));
+    juce::AudioBuffer<float> block(channels, frameSize);
+    Bands bands {};
+    int frames = 0;
+
+    // The file is analysed at its own rate; the band grid is rate independent.
+    for (juce::int64 pos = 0; pos + frameSize <= length && ! threadShouldExit(); pos += hopSize) {
+        reader->read(&block, 0, frameSize, pos, true, channels > 1);
+        for (int i = 0; i < frameSize; ++i) {
+            const float mono = channels > 1 ? 0.5f * (block.getSample(0, i) + block.getSample(1, i)) : block.getSample(0, i);
+            fftData[(size_t) i] = mono * window[(size_t) i];
+        }
+        std::fill(fftData.begin() + frameSize, fftData.end(), 0.0f);
+        analysisFft->performFrequencyOnlyForwardTransform(fftData.data(), true);
+        addFrameToBands(fftData.data(), frameSize, reader->sampleRate, bands);
+        ++frames;
+    }
+
+    if (frames == 0)
+        return false;
+    referenceBands = bands;
+    referenceFrames = frames;
+    return true;
+}
+
+void TimbralMatch::updateCurve() {
+    if (sourceFrames == 0 || referenceFrames == 0)
+        return;
+
+    // Per-band level difference; bands one side could not measure repeat the one below.
+    std::vector<float> diff((size_t) curvePoints, 0.0f);
+    float last = 0.0f;
+    for (int p = 0; p < curvePoints; ++p) {
+        const double src = sourceBands[(size_t) p] / sourceFrames;
+        const double ref = referenceBands[(size_t) p] / referenceFrames;
+        if (src > 1.0e-20 && ref > 1.0e-20)
+            last = (float) (10.0 * std::log10(ref / src));
+        diff[(size_t) p] = last;
+    }
+
+    // Only the tonal shape is matched: remove the mean level over the main band.
+    double sum = 0.0;
+    int count = 0;
+    for (int p = 0; p < curvePoints; ++p) {
+        if (gridHz(p) >= normaliseLowHz && gridHz(p) <= normaliseHighHz) {
+            sum += diff[(size_t) p];
+            ++count;
+        }
+    }
+    const float mean = (float) (sum / juce::jmax(1, count));
+
+    Curve smoothed;
+    for (int p = 0; p < curvePoints; ++p) {
+        const float a = diff[(size_t) juce::jmax(0, p - 1)], b = diff[(size_t) p], c = diff[(size_t) juce::jmin(curvePoints - 1, p + 1)];
+        smoothed[(size_t) p] = juce::jlimit(-maxCurveDb, maxCurveDb, 0.25f * a + 0.5f * b + 0.25f * c - mean);
+    }
+
+    {
+        const juce::ScopedLock sl(curveLock);
+        curve = smoothed;
+        curveValid = true;
+    }
+    curveChanged = true;
+}
+
+void TimbralMatch::design(float amount) {
+    Curve target;
+    {
+        const juce::ScopedLock sl(curveLock);
+        target = curve;
+    }
+    designedAmount = amount;
+
+    // Log-magnitude on a grid four times the FIR length, then the real cepstrum
+    // folded onto positive quefrencies gives the minimum-phase spectrum.
+    const int size = 4 * firLength;
+    juce::dsp::FFT fft(fftOrderFor(size));
+    std::vector<float> buffer((size_t) (2 * size), 0.0f);
+    const double logGrid = std::log(gridHighHz / gridLowHz);
+    const float dbToNeper = std::log(10.0f) / 20.0f;
+
+    for (int k = 0; k <= size / 2; ++k) {
+        const double hz = juce::jmax(gridLowHz, (double) k * preparedRate / size);
+        const double pos = juce::jlimit(0.0, (double) (curvePoints - 1), std::log(hz / gridLowHz) / logGrid * (curvePoints - 1));
+        const int i = juce::jmin(curvePoints - 2, (int) pos);
+        const float frac = (float) (pos - i);
+        const float db = target[(size_t) i] + frac * (target[(size_t) (i + 1)] - target[(size_t) i]);
+        buffer[(size_t) (2 * k)] = amount * db * dbToNeper;
+        buffer[(size_t) (2 * k + 1)] = 0.0f;
+    }
+    fft.performRealOnlyInverseTransform(buffer.data());
+
+    for (int n = 1; n < size / 2; ++n)
+        buffer[(size_t) n] *= 2.0f;
+    std::fill(buffer.begin() + size / 2 + 1, buffer.end(), 0.0f);
+    fft.performRealOnlyForwardTransform(buffer.data());
+
+    for (int k = 0; k <= size / 2; ++k) {
+        const float mag = std::exp(buffer[(size_t) (2 * k)]);
+        const float phase = buffer[(size_t) (2 * k + 1)];
+        buffer[(size_t) (2 * k)] = mag * std::cos(phase);
+        buffer[(size_t) (2 * k + 1)] = mag * std::sin(phase);
+    }
+    fft.performRealOnlyInverseTransform(buffer.data());
+
+    // Minimum phase puts the energy up front; taper the last quarter to zero.
+    juce::AudioBuffer<float> ir(1, firLength);
+    const int taper = firLength / 4;
+    for (int n = 0; n < firLength; ++n) {
+        const int fromEnd = firLength - n;
+        const float w = fromEnd > taper ? 1.0f
+                                        : 0.5f - 0.5f * std::cos(juce::MathConstants<float>::pi * (float) fromEnd / (float) taper);
+        ir.setSample(0, n, buffer[(size_t) n] * w);
+    }
+
+    delete pending.exchange(new PartitionedConvolver(ConvolutionKernel::create(ir)));
+}
+
+//==============================================================================
+void TimbralMatch::process(float* dataL, float* dataR, int numSamples, float targetAmount) noexcept {
+#if JUCE_DEBUG
+    audioThread.store(juce::Thread::getCurrentThreadId(), std::memory_order_relaxed);
+#endif
+    if (learning.load(std::memory_order_relaxed) != Learn::off)
+        pushLearning(dataL, dataR, numSamples);
+    requestedAmount.store(targetAmount, std::memory_order_relaxed);
+
+    // The retire slot can still be occupied if a fade finished while the worker was busy.
+    if (parked != nullptr && retired.load() == nullptr)
+        retired.store(parked.release());
+
+    if (incoming == nullptr && parked == nullptr) {
+        if (auto* next = pending.exchange(nullptr)) {
+            incoming.reset(next);
+            fadePos = 0;
+        }
+    }
+
+    if (active == nullptr && incoming == nullptr)
+        return;
+
+    const int maxChunk = wetBuffer.getNumSamples();
+    for (int offset = 0; offset < numSamples; offset += maxChunk) {
+        const int n = juce::jmin(maxChunk, numSamples - offset);
+        float* outL = dataL + offset;
+        float* outR = dataR + offset;
+
+        // Without an active filter the fade starts from the unfiltered signal.
+        float* wet[2] = { wetBuffer.getWritePointer(0), wetBuffer.getWritePointer(1) };
+        std::copy(outL, outL + n, wet[0]);
+        std::copy(outR, outR + n, wet[1]);
+        if (active != nullptr)
+            active->process(wet, 2, n);
+
+        if (incoming != nullptr) {
+            float* next[2] = { incomingBuffer.getWritePointer(0), incomingBuffer.getWritePointer(1) };
+            std::copy(outL, outL + n, next[0]);
+            std::copy(outR, outR + n, next[1]);
+            incoming->process(next, 2, n);
+
+            const float step = 1.0f / (float) fadeLength;
+            for (int i = 0; i < n; ++i) {
+                const float g = juce::jmin(1.0f, (float) (fadePos + i) * step);
+                wet[0][i] += (next[0][i] - wet[0][i]) * g;
+                wet[1][i] += (next[1][i] - wet[1][i]) * g;
+            }
+
+            fadePos += n;
+            if (fadePos >= fadeLength) {
+                PartitionedConvolver* expected = nullptr;
+                if (active == nullptr || retired.compare_exchange_strong(expected, active.get()))
+                    active.release();
+                else
+                    parked = std::move(active);
+                active = std::move(incoming);
+            }
+        }
+
+        std::copy(wet[0], wet[0] + n, outL);
+        std::copy(wet[1], wet[1] + n, outR);
+    }
+}
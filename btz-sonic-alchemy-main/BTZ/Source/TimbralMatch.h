@@ -0,0 +1,116 @@
+/*
+  Box Tone Zone (BTZ) - TimbralMatch.h
+*/
+#pragma once
+
+#include "PartitionedConvolver.h"
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <vector>
+
+// Match EQ ("Timbral Transfer"): a minimum-phase FIR that moves the long-term
+// spectrum of the signal towards a reference.
+//
+// Both spectra are kept as band powers on a fixed log grid (curvePoints bands
+// from 20 Hz to 20 kHz, each a third of an octave wide), so they are already
+// smoothed and do not depend on the sample rate. The reference comes from an
+// audio file or is learned from the input; the source is learned from the input
+// while Learn is on. On the worker thread the smoothed difference curve
+// (level-normalised, limited to +-12 dB, scaled by the Match amount) becomes a
+// minimum-phase FIR through the real cepstrum, and the finished convolver is
+// handed to the audio thread through an atomic slot and crossfaded in. The
+// audio thread only copies input into a lock-free FIFO while learning and runs
+// the zero-latency partitioned convolver, so its cost per block is fixed.
+//
+// The curve itself never reaches the audio thread: it is a fixed-size array
+// shared by the message thread (state save/restore) and the worker under
+// curveLock, which is held only for a copy of it. Debug builds assert that
+// getCurve()/setCurve() are not called from the thread running process().
+class TimbralMatch : private juce::Thread {
+public:
+    static constexpr int curvePoints = 64;
+    enum class Learn { off, source, reference };
+
+    TimbralMatch();
+    ~TimbralMatch() override;
+
+    // Message thread. (Re)starts the worker for the given host rate.
+    void prepare(double sampleRate, int maxBlockSize);
+    void release();
+    void reset();
+    // Analysis and audio-thread buffers; call when not processing.
+    size_t getMemoryBytes() const noexcept;
+
+    // Message thread.
+    void setReferenceFile(const juce::File& file);
+    juce::File getReferenceFile() const;
+    void setLearning(Learn target);
+    Learn getLearning() const noexcept { return learning.load(); }
+    bool hasCurve() const;
+
+    // The match curve in dB per grid point before the amount is applied; empty
+    // until both spectra exist. setCurve() restores a saved match. Message thread
+    // only (getStateInformation / setStateInformation), never the audio thread.
+    std::vector<float> getCurve() const;
+    void setCurve(const std::vector<float>& curveDb);
+
+    // Audio thread: never blocks or allocates.
+    void process(float* dataL, float* dataR, int numSamples, float targetAmount) noexcept;
+
+private:
+    using Bands = std::array<double, curvePoints>;
+    using Curve = std::array<float, curvePoints>;
+
+    static constexpr int frameSize = 4096;
+    static constexpr int hopSize = 2048;
+    static constexpr int fifoSize = 32768;
+
+    void run() override;
+    void pushLearning(const float* left, const float* right, int numSamples) noexcept;
+    void analyseFrame();
+    void addFrameToBands(const float* magnitude, int fftSize, double rate, Bands& bands) const;
+    bool loadReference(const juce::File& file);
+    void updateCurve();
+    void design(float amount);
+
+    static float gridHz(int point);
+    void assertNotAudioThread() const noexcept;
+
+    double preparedRate = 0.0;
+    int firLength = 2048;
+
+    // Audio -> worker capture while learning.
+    juce::AbstractFifo fifo { fifoSize };
+    std::vector<float> fifoData;
+    std::atomic<Learn> learning { Learn::off };
+
+    // Worker state.
+    std::unique_ptr<juce::dsp::FFT> analysisFft;   // built on first prepare()
+    std::vector<float> frame, fftData;
+    const float* window = nullptr;                  // shared Hann table
+    int frameFill = 0;
+    Bands sourceBands {}, referenceBands {};
+    int sourceFrames = 0, referenceFrames = 0;
+    int framesSinceDesign = 0;
+    float designedAmount = -1.0f;
+    std::atomic<bool> curveChanged { false }, referenceRequested { false };
+
+    // Message thread <-> worker only.
+    mutable juce::CriticalSection curveLock;
+    Curve curve {};
+    bool curveValid = false;
+    juce::File referenceFile;
+#if JUCE_DEBUG
+    std::atomic<juce::Thread::ThreadID> audioThread { nullptr };
+#endif
+
+    // Worker -> audio handoff: one pending convolver, one retired for deletion.
+    std::atomic<PartitionedConvolver*> pending { nullptr }, retired { nullptr };
+    std::atomic<float> requestedAmount { 1.0f };
+    std::unique_ptr<PartitionedConvolver> active, incoming, parked;
+    juce::AudioBuffer<float> wetBuffer, incomingBuffer;
+    int fadePos = 0, fadeLength = 1;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TimbralMatch)
+};
@@ -0,0 +1,58 @@
+/*
+  Box Tone Zone (BTZ) - TransientShaper.cpp
+*/
+#include "TransientShaper.h"
+
+namespace {
+// Per-band voicing of the Punch macro (low, mid, high, unused lane).
+const float attackWeights[4] = { 0.30f, 0.40f, 0.25f, 0.0f };
+const float sustainWeights[4] = { -0.10f, -0.20f, -0.08f, 0.0f };
+
+static inline float coeffForMs(float ms, double sampleRate) {
+    return 1.0f - std::exp(-1.0f / ((float) sampleRate * ms * 0.001f));
+}
+}
+
+void MultibandTransientShaper::prepare(double sampleRate) {
+    bank.prepare(sampleRate, lowMidHz, midHighHz);
+    fastAttack = Vec4::broadcast(coeffForMs(0.5f, sampleRate));
+    slowAttack = Vec4::broadcast(coeffForMs(15.0f, sampleRate));
+    fastRelease = Vec4::broadcast(coeffForMs(50.0f, sampleRate));
+    slowRelease = Vec4::broadcast(coeffForMs(250.0f, sampleRate));
+    reset();
+}
+
+void MultibandTransientShaper::reset() {
+    bank.reset();
+    fastEnv = slowAttackEnv = slowReleaseEnv = Vec4::zero();
+}
+
+void MultibandTransientShaper::process(float& L, float& R, float amount) noexcept {
+    CrossoverBank3::Bands b;
+    bank.process(L, R, b);
+
+    const Vec4 bandsL = Vec4::set(b.low[0], b.mid[0], b.high[0], 0.0f);
+    const Vec4 bandsR = Vec4::set(b.low[1], b.mid[1], b.high[1], 0.0f);
+    const Vec4 level = Vec4::max(Vec4::abs(bandsL), Vec4::abs(bandsR));
+    fastEnv = follow(fastEnv, level, fastAttack, fastRelease);
+    slowAttackEnv = follow(slowAttackEnv, level, slowAttack, fastRelease);
+    slowReleaseEnv = follow(slowReleaseEnv, level, fastAttack, slowRelease);
+
+    if (amount <= 0.0005f) {
+        L = bandsL.sum();
+        R = bandsR.sum();
+        return;
+    }
+
+    const Vec4 one = Vec4::broadcast(1.0f);
+    const Vec4 floor = Vec4::broadcast(1.0e-6f);
+    const Vec4 attackRatio = fastEnv / (slowAttackEnv + floor);    // > 1 while a hit is rising
+    const Vec4 sustainRatio = slowReleaseEnv / (fastEnv + floor);  // > 1 in the decay tail
+    const Vec4 amt = Vec4::broadcast(amount);
+    const Vec4 attackGain = one + amt * Vec4::load(attackWeights) * Vec4::min(attackRatio - one, Vec4::broadcast(8.0f));
+    const Vec4 sustainGain = one + amt * Vec4::load(sustainWeights) * Vec4::min(sustainRatio - one, Vec4::broadcast(8.0f));
+    const Vec4 gain = Vec4::clamp(attackGain * sustainGain, Vec4::broadcast(0.25f), Vec4::broadcast(4.0f));
+
+    L = (gain * bandsL).sum();
+    R = (gain * bandsR).sum();
+}
@@ -0,0 +1,33 @@
+/*
+  Box Tone Zone (BTZ) - TransientShaper.h
+*/
+#pragma once
+
+#include "CrossoverBank.h"
+
+// Three-band transient shaper on the shared LR4 split. Per band (lanes 0-2 =
+// low/mid/high, stereo-linked) three peak followers track the attack (fast vs.
+// slow-attack) and the sustain (slow-release vs. fast). The output is the sum of
+// the bands times their gains, y = sum(g * band), so a uniform gain is flat and
+// neutral settings return the crossover's allpass of the input at every amount.
+// A dry signal mixed against it needs CrossoverAllpass3 at the same points.
+class MultibandTransientShaper {
+public:
+    static constexpr float lowMidHz = 120.0f, midHighHz = 2500.0f;
+
+    void prepare(double sampleRate);
+    void reset();
+
+    // amount is the (master-scaled) Punch macro; 0 leaves every band gain at unity.
+    void process(float& L, float& R, float amount) noexcept;
+
+private:
+    static Vec4 follow(Vec4 env, Vec4 level, Vec4 attack, Vec4 release) noexcept {
+        const Vec4 coeff = Vec4::select(Vec4::greaterThan(level, env), attack, release);
+        return env + coeff * (level - env);
+    }
+
+    CrossoverBank3 bank;
+    Vec4 fastEnv = Vec4::zero(), slowAttackEnv = Vec4::zero(), slowReleaseEnv = Vec4::zero();
+    Vec4 fastAttack = Vec4::zero(), slowAttack = Vec4::zero(), fastRelease = Vec4::zero(), slowRelease = Vec4::zero();
+};
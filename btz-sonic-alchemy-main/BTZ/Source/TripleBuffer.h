@@ -0,0 +1,32 @@
+/*
+  Box Tone Zone (BTZ) - TripleBuffer.h
+*/
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+// Single-writer / single-reader latest-value exchange. The writer fills its
+// private slot and publishes it; the reader always sees the newest complete
+// value. Neither side ever waits, and a slow reader simply skips values.
+template <typename T>
+class TripleBuffer {
+public:
+    // Writer side.
+    T& getWriteSlot() noexcept { return slots[(std::size_t) writeIndex]; }
+    void publish() noexcept { writeIndex = middle.exchange(writeIndex | dirtyFlag, std::memory_order_acq_rel) & indexMask; }
+
+    // Reader side. Returns the last published value (default-constructed until the first publish).
+    const T& read() noexcept {
+        if ((middle.load(std::memory_order_relaxed) & dirtyFlag) != 0)
+            readIndex = middle.exchange(readIndex, std::memory_order_acq_rel) & indexMask;
+        return slots[(std::size_t) readIndex];
+    }
+
+private:
+    static constexpr int dirtyFlag = 4, indexMask = 3;
+    std::array<T, 3> slots {};
+    std::atomic<int> middle { 1 };
+    int writeIndex = 0, readIndex = 2;
+};
@@ -0,0 +1,115 @@
+/*
+  Box Tone Zone (BTZ) - WowFlutter.cpp
+*/
+#include "WowFlutter.h"
+
+namespace {
+constexpr double wowHz = 0.6, flutterHz = 7.5;
+constexpr double wowSpeed = 0.0025, flutterSpeed = 0.0006;   // peak speed deviation at Motion 1
+constexpr double driftHz = 1.2, scrapeHz = 40.0;
+constexpr double driftMs = 0.10, scrapeMs = 0.004;          // RMS delay deviation at Motion 1
+constexpr double maxExcursionMs = 1.2;
+constexpr float hissPerOsFactor = 8.0e-6f;
+
+// RMS gain of two cascaded one-poles y += a (x - y) driven by white noise.
+static double twoPoleRms(double a) {
+    const double r2 = (1.0 - a) * (1.0 - a);
+    return std::sqrt(a * a * a * a * (1.0 + r2) / std::pow(1.0 - r2, 3.0));
+}
+}
+
+void CounterNoise::fill(float* out, int numValues) noexcept {
+    for (int i = 0; i < numValues; ++i) {
+        uint32_t x = key + counter + (uint32_t) i;
+        x ^= x >> 16;
+        x *= 0x7FEB352Du;
+        x ^= x >> 15;
+        x *= 0x846CA68Bu;
+        x ^= x >> 16;
+        out[i] = (float) (int32_t) (x >> 8) * (1.0f / 16777216.0f) - 0.5f;
+    }
+    counter += (uint32_t) numValues;
+}
+
+//==============================================================================
+void WowFlutter::allocate(double maxProcessingRate) {
+    const int needed = (int) std::ceil((centreDelayMs + maxExcursionMs) * 0.001 * maxProcessingRate) + guard + 4;
+    size = juce::nextPowerOfTwo(juce::jmax(64, needed));
+    mask = size - 1;
+    bufL.assign((size_t) (size + guard), 0.0f);
+    bufR.assign((size_t) (size + guard), 0.0f);
+    maxDelay = (float) (size - guard - 2);
+    reset();
+}
+
+void WowFlutter::prepare(double hostRate, int osFactor) {
+    const double rate = hostRate * juce::jmax(1, osFactor);
+    centreSamples = juce::jmin(getCentreDelaySamples(hostRate) * juce::jmax(1, osFactor), (int) maxDelay);
+    centre = centreEnabled ? centreSamples : 0;
+
+    const double twoPi = juce::MathConstants<double>::twoPi;
+    const double wWow = twoPi * wowHz / rate, wFlutter = twoPi * flutterHz / rate;
+    rotCos = Vec4::set((float) std::cos(wWow), (float) std::cos(wWow), (float) std::cos(wFlutter), (float) std::cos(wFlutter));
+    rotSin = Vec4::set((float) std::sin(wWow), (float) std::sin(wWow), (float) std::sin(wFlutter), (float) std::sin(wFlutter));
+
+    // Peak speed deviation s at f Hz is a delay excursion of s / (2 pi f) seconds.
+    const float wowDepth = (float) (wowSpeed / (twoPi * wowHz) * rate);
+    const float flutterDepth = (float) (flutterSpeed / (twoPi * flutterHz) * rate);
+    depth = Vec4::set(wowDepth, wowDepth, flutterDepth, flutterDepth);
+
+    // Uniform noise has an RMS of 1/sqrt(12); normalise each filter to the target RMS.
+    const double aDrift = 1.0 - std::exp(-twoPi * driftHz / rate);
+    const double aScrape = 1.0 - std::exp(-twoPi * scrapeHz / rate);
+    const float driftGain = (float) (driftMs * 0.001 * rate * std::sqrt(12.0) / twoPoleRms(aDrift));
+    const float scrapeGain = (float) (scrapeMs * 0.001 * rate * std::sqrt(12.0) / twoPoleRms(aScrape));
+    noiseCoeff = Vec4::set((float) aDrift, (float) aDrift, (float) aScrape, (float) aScrape);
+    noiseGain = Vec4::set(driftGain, driftGain, scrapeGain, scrapeGain);
+
+    hissLevel = hissPerOsFactor / (float) juce::jmax(1, osFactor);
+    reset();
+}
+
+void WowFlutter::setCentreEnabled(bool enabled) noexcept {
+    centreEnabled = enabled;
+    centre = enabled ? centreSamples : 0;
+}
+
+void WowFlutter::reset() {
+    std::fill(bufL.begin(), bufL.end(), 0.0f);
+    std::fill(bufR.begin(), bufR.end(), 0.0f);
+    writePos = 0;
+    allpassL = allpassR = 0.0f;
+
+    // The right channel leads slightly, like a small azimuth error on one transport.
+    cosState = Vec4::set(1.0f, std::cos(0.05f), 1.0f, std::cos(0.2f));
+    sinState = Vec4::set(0.0f, std::sin(0.05f), 0.0f, std::sin(0.2f));
+    drift1 = drift2 = Vec4::zero();
+    noise.reset(0x5EEDu);
+    chunkPos = chunkSize;
+}
+
+void WowFlutter::generateChunk() noexcept {
+    noise.fill(noiseBuffer, 4 * chunkSize);
+
+    for (int i = 0; i < chunkSize; ++i) {
+        const Vec4 c = cosState * rotCos - sinState * rotSin;
+        sinState = sinState * rotCos + cosState * rotSin;
+        cosState = c;
+
+        // Drift and scrape are shared by both channels (one tape transport).
+        const float* n = noiseBuffer + 4 * i;
+        drift1 = drift1 + noiseCoeff * (Vec4::set(n[0], n[0], n[1], n[1]) - drift1);
+        drift2 = drift2 + noiseCoeff * (drift1 - drift2);
+
+        float m[4];
+        (sinState * depth + drift2 * noiseGain).store(m);
+        modulation[2 * i] = m[0] + m[2];
+        modulation[2 * i + 1] = m[1] + m[3];
+    }
+
+    // Keep the rotation on the unit circle (first-order correction per chunk).
+    const Vec4 g = Vec4::broadcast(1.5f) - Vec4::broadcast(0.5f) * (cosState * cosState + sinState * sinState);
+    cosState = cosState * g;
+    sinState = sinState * g;
+    chunkPos = 0;
+}
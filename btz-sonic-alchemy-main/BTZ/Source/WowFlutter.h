@@ -0,0 +1,157 @@
+/*
+  Box Tone Zone (BTZ) - WowFlutter.h
+*/
+#pragma once
+
+#include "SimdVec.h"
+#include <JuceHeader.h>
+#include <cstdint>
+#include <vector>
+
+// Counter-based uniform noise (lowbias32 hash of key + index). Every value depends
+// only on its index, so filling a block is a dependency-free loop the compiler
+// vectorises, unlike a chained LCG.
+class CounterNoise {
+public:
+    void reset(uint32_t seed) noexcept { key = seed * 0x9E3779B9u; counter = 0; }
+
+    // Uniform values in [-0.5, 0.5).
+    void fill(float* out, int numValues) noexcept;
+
+private:
+    uint32_t key = 0, counter = 0;
+};
+
+// Tape transport modulation for the Motion macro: a stereo circular delay whose
+// read position moves with wow (0.6 Hz), flutter (7.5 Hz) and filtered random
+// drift, plus a little hiss. The modulation is generated in chunks of 32 samples
+// with the oscillators and drift filters in Vec4 lanes [wow L, wow R, flutter L,
+// flutter R] (slow drift rides on the wow lanes, capstan scrape on the flutter
+// lanes); per sample only the fractional read remains. The delay sits on a
+// fixed centre (getCentreDelaySamples() host samples) so the path latency never
+// depends on the Motion amount; with the centre switched out the line is a plain
+// pass-through and adds no latency.
+class WowFlutter {
+public:
+    enum Interpolation { linear, lagrange3, thiran };
+
+    static constexpr float centreDelayMs = 1.5f;
+    static int getCentreDelaySamples(double hostRate) { return juce::roundToInt(centreDelayMs * 0.001 * hostRate); }
+
+    // Allocates for the highest processing rate; call off the audio thread.
+    void allocate(double maxProcessingRate);
+    // No allocation: safe from a quality switch on the audio thread.
+    void prepare(double hostRate, int osFactor);
+    void reset();
+    size_t getMemoryBytes() const noexcept { return (bufL.size() + bufR.size()) * sizeof(float); }
+
+    void setInterpolation(Interpolation newInterpolation) noexcept { interpolation = newInterpolation; }
+    // Without the centre delay the modulation has nothing to swing around, so
+    // process() falls back to the still path.
+    void setCentreEnabled(bool enabled) noexcept;
+
+    // amount 0..1 scales the modulation depth and the hiss.
+    void process(float& L, float& R, float amount) noexcept {
+        if (amount <= 0.01f || centre == 0) {
+            processStill(L, R);
+            return;
+        }
+        write(L, R);
+
+        if (chunkPos == chunkSize)
+            generateChunk();
+        const float* mod = modulation + 2 * chunkPos;
+        const float* hiss = noiseBuffer + 4 * chunkPos;
+        ++chunkPos;
+
+        L = read(bufL, (float) centre + amount * mod[0], allpassL) + hiss[2] * amount * hissLevel;
+        R = read(bufR, (float) centre + amount * mod[1], allpassR) + hiss[3] * amount * hissLevel;
+    }
+
+    // Motion off: the plain centre delay, which process() also falls back to.
+    void processStill(float& L, float& R) noexcept {
+        write(L, R);
+        L = readInteger(bufL, centre);
+        R = readInteger(bufR, centre);
+        allpassL = L;
+        allpassR = R;
+    }
+
+    // Dual-mono input (only with Motion at rest): one read; the right buffer stays
+    // current for a switch back to stereo.
+    void processMonoStill(float& x) noexcept {
+        write(x, x);
+        x = readInteger(bufL, centre);
+        allpassL = allpassR = x;
+    }
+
+private:
+    static constexpr int chunkSize = 32;
+    static constexpr int guard = 4;
+
+    void generateChunk() noexcept;
+
+    void write(float L, float R) noexcept {
+        writePos = (writePos + 1) & mask;
+        bufL[(size_t) writePos] = L;
+        bufR[(size_t) writePos] = R;
+        if (writePos < guard) {
+            bufL[(size_t) (writePos + size)] = L;
+            bufR[(size_t) (writePos + size)] = R;
+        }
+    }
+
+    float readInteger(const std::vector<float>& buf, int delay) const noexcept {
+        return buf[(size_t) ((writePos - delay) & mask)];
+    }
+
+    float read(const std::vector<float>& buf, float delay, float& allpassState) const noexcept {
+        delay = juce::jlimit(2.0f, maxDelay, delay);
+        switch (interpolation) {
+            case lagrange3: {
+                const int i = (int) delay;
+                const float f = delay - (float) i;
+                // Taps at delays i + 2, i + 1, i, i - 1 are consecutive in memory.
+                const float fm1 = f - 1.0f, fm2 = f - 2.0f, fp1 = f + 1.0f;
+                const Vec4 h = Vec4::set(fp1 * f * fm1 * (1.0f / 6.0f), -fp1 * f * fm2 * 0.5f,
+                                         fp1 * fm1 * fm2 * 0.5f, -f * fm1 * fm2 * (1.0f / 6.0f));
+                return (Vec4::load(buf.data() + ((writePos - i - 2) & mask)) * h).sum();
+            }
+            case thiran: {
+                // First-order allpass on an integer delay, fractional part kept in [0.5, 1.5).
+                const int i = (int) (delay - 0.5f);
+                const float d = delay - (float) i;
+                const float a = (1.0f - d) / (1.0f + d);
+                const float y = a * readInteger(buf, i) + readInteger(buf, i + 1) - a * allpassState;
+                allpassState = y;
+                return y;
+            }
+            case linear:
+            default: {
+                const int i = (int) delay;
+                const float f = delay - (float) i;
+                const float a = readInteger(buf, i);
+                return a + f * (readInteger(buf, i + 1) - a);
+            }
+        }
+    }
+
+    std::vector<float> bufL, bufR;
+    int size = 0, mask = 0, writePos = 0, centre = 0, centreSamples = 0;
+    bool centreEnabled = true;
+    float maxDelay = 2.0f;
+    Interpolation interpolation = lagrange3;
+    float allpassL = 0.0f, allpassR = 0.0f;
+
+    CounterNoise noise;
+    Vec4 cosState = Vec4::broadcast(1.0f), sinState = Vec4::zero();
+    Vec4 rotCos = Vec4::broadcast(1.0f), rotSin = Vec4::zero();
+    Vec4 depth = Vec4::zero();
+    Vec4 drift1 = Vec4::zero(), drift2 = Vec4::zero();
+    Vec4 noiseCoeff = Vec4::zero(), noiseGain = Vec4::zero();
+    float hissLevel = 0.0f;
+
+    alignas(16) float noiseBuffer[4 * chunkSize] = {};
+    alignas(16) float modulation[2 * chunkSize] = {};
+    int chunkPos = chunkSize;
+};
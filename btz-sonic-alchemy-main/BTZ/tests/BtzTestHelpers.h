@@ -0,0 +1,86 @@
+/*
+  Box Tone Zone (BTZ) - BtzTestHelpers.h
+
+  Shared setup for the behaviour tests: parameters are set through the public
+  APVTS like a host would, and audio runs through processBlock in fixed blocks.
+*/
+#pragma once
+
+#include "../Source/PluginProcessor.h"
+#include <JuceHeader.h>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+namespace BtzTest {
+
+inline void setParam(BTZAudioProcessor& proc, BTZParams::Id id, float value) {
+    if (auto* param = proc.getAPVTS().getParameter(BTZParams::spec(id).id))
+        param->setValueNotifyingHost(param->convertTo0to1(value));
+}
+
+inline void prepare(BTZAudioProcessor& proc, double sampleRate, int blockSize, bool offline = false) {
+    proc.setNonRealtime(offline);
+    proc.setPlayConfigDetails(2, 2, sampleRate, blockSize);
+    proc.prepareToPlay(sampleRate, blockSize);
+}
+
+inline juce::AudioBuffer<float> noise(int numSamples, float level, int seed) {
+    juce::AudioBuffer<float> buffer(2, numSamples);
+    juce::Random random(seed);
+    for (int ch = 0; ch < 2; ++ch)
+        for (int i = 0; i < numSamples; ++i)
+            buffer.setSample(ch, i, (random.nextFloat() * 2.0f - 1.0f) * level);
+    return buffer;
+}
+
+inline juce::AudioBuffer<float> impulse(int numSamples, int position, float level) {
+    juce::AudioBuffer<float> buffer(2, numSamples);
+    buffer.clear();
+    for (int ch = 0; ch < 2; ++ch)
+        buffer.setSample(ch, position, level);
+    return buffer;
+}
+
+// Runs input through the processor in blockSize pieces (the last one may be shorter).
+inline juce::AudioBuffer<float> render(BTZAudioProcessor& proc, const juce::AudioBuffer<float>& input, int blockSize) {
+    juce::AudioBuffer<float> output(input);
+    juce::MidiBuffer midi;
+    for (int pos = 0; pos < output.getNumSamples(); pos += blockSize) {
+        const int n = juce::jmin(blockSize, output.getNumSamples() - pos);
+        juce::AudioBuffer<float> block(output.getArrayOfWritePointers(), 2, pos, n);
+        proc.processBlock(block, midi);
+    }
+    return output;
+}
+
+inline int peakIndex(const juce::AudioBuffer<float>& buffer, int channel) {
+    const float* data = buffer.getReadPointer(channel);
+    int best = 0;
+    for (int i = 1; i < buffer.getNumSamples(); ++i)
+        if (std::abs(data[i]) > std::abs(data[best]))
+            best = i;
+    return best;
+}
+
+inline float maxDifference(const juce::AudioBuffer<float>& a, const juce::AudioBuffer<float>& b,
+                           int start = 0, int end = -1) {
+    if (end < 0)
+        end = juce::jmin(a.getNumSamples(), b.getNumSamples());
+    float worst = 0.0f;
+    for (int ch = 0; ch < 2; ++ch)
+        for (int i = start; i < end; ++i)
+            worst = juce::jmax(worst, std::abs(a.getSample(ch, i) - b.getSample(ch, i)));
+    return worst;
+}
+
+inline bool bitIdentical(const juce::AudioBuffer<float>& a, const juce::AudioBuffer<float>& b) {
+    if (a.getNumSamples() != b.getNumSamples())
+        return false;
+    for (int ch = 0; ch < 2; ++ch)
+        if (std::memcmp(a.getReadPointer(ch), b.getReadPointer(ch), sizeof(float) * (size_t) a.getNumSamples()) != 0)
+            return false;
+    return true;
+}
+
+}
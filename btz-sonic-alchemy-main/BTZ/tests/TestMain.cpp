@@ -0,0 +1,13 @@
+/*
+  Box Tone Zone (BTZ) - TestMain.cpp
+
+  gtest entry point for btz_tests; the processor needs JUCE initialised.
+*/
+#include <JuceHeader.h>
+#include <gtest/gtest.h>
+
+int main(int argc, char* argv[]) {
+    juce::ScopedJuceInitialiser_GUI juceInit;
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,117 @@
+/*
+  Box Tone Zone (BTZ) - test_adaa.cpp
+
+  AdaaTanh4: settles on the plain shaper, matches its declared dry delay and
+  aliases less with each order.
+*/
+#include "../Source/AdaaShaper.h"
+#include <JuceHeader.h>
+#include <gtest/gtest.h>
+#include <cmath>
+#include <vector>
+
+namespace {
+constexpr int orders[] = { AdaaTanh4::off, AdaaTanh4::first, AdaaTanh4::second };
+
+float lane0(Vec4 v) {
+    float out[4];
+    v.store(out);
+    return out[0];
+}
+
+// Shapes a sine of `cycles` periods per `length` samples (after one period of
+// settling) and returns the output.
+std::vector<float> shapeSine(int order, int length, int cycles, float amplitude) {
+    AdaaTanh4 shaper;
+    shaper.reset();
+    std::vector<float> out((size_t) length);
+    for (int i = -length; i < length; ++i) {
+        const float x = amplitude * (float) std::sin(juce::MathConstants<double>::twoPi * cycles * i / length);
+        const float y = lane0(shaper.process(Vec4::broadcast(x), order));
+        if (i >= 0)
+            out[(size_t) i] = y;
+    }
+    return out;
+}
+
+double binPower(const std::vector<float>& x, int bin) {
+    double re = 0.0, im = 0.0;
+    const double w = juce::MathConstants<double>::twoPi * bin / (double) x.size();
+    for (size_t i = 0; i < x.size(); ++i) {
+        re += x[i] * std::cos(w * (double) i);
+        im -= x[i] * std::sin(w * (double) i);
+    }
+    return re * re + im * im;
+}
+}
+
+TEST(AdaaTest, ConstantInputSettlesOnThePlainShaper) {
+    for (int order : orders) {
+        for (float x : { -3.0f, -0.5f, 0.0f, 0.7f, 2.5f }) {
+            AdaaTanh4 shaper;
+            shaper.reset();
+            Vec4 y;
+            for (int i = 0; i < 4; ++i)
+                y = shaper.process(Vec4::broadcast(x), order);
+            EXPECT_NEAR(lane0(y), lane0(AdaaTanh4::shape(Vec4::broadcast(x))), 1.0e-5f) << "order " << order << ", x " << x;
+        }
+    }
+}
+
+// At low level the shaper is close to linear, so its output must line up with the
+// dry side alignDry() produces for the same order; a wrong dry delay would comb-filter
+// every shaper blend.
+TEST(AdaaTest, AlignedDryMatchesTheShaperDelay) {
+    for (int order : orders) {
+        AdaaTanh4 shaper;
+        shaper.reset();
+        float worst = 0.0f;
+        for (int i = 0; i < 4800; ++i) {
+            const float x = 1.0e-3f * (float) std::sin(juce::MathConstants<double>::twoPi * 1000.0 * i / 48000.0);
+            const float wet = lane0(shaper.process(Vec4::broadcast(x), order));
+            const float dry = lane0(shaper.alignDry(Vec4::broadcast(x), order));
+            if (i >= 8)
+                worst = juce::jmax(worst, std::abs(wet - dry));
+        }
+        EXPECT_LT(worst, 1.0e-5f) << "order " << order;
+    }
+}
+
+// A 5 kHz sine at 48 kHz (bin 427 of 4096) driven hard: harmonics 5 to 15 lie above
+// Nyquist and fold back to known bins. Each order must cut their total power.
+TEST(AdaaTest, AliasingDropsWithEachOrder) {
+    constexpr int length = 4096, bin = 427;
+    double aliasDb[3] = {};
+    for (int order : orders) {
+        const auto y = shapeSine(order, length, bin, 4.0f);
+        double alias = 0.0;
+        for (int harmonic = 5; harmonic <= 15; harmonic += 2) {
+            int folded = (harmonic * bin) % length;
+            if (folded > length / 2)
+                folded = length - folded;
+            alias += binPower(y, folded);
+        }
+        aliasDb[order] = 10.0 * std::log10(alias / binPower(y, bin));
+    }
+    EXPECT_LT(aliasDb[AdaaTanh4::first], aliasDb[AdaaTanh4::off] - 4.0);
+    EXPECT_LT(aliasDb[AdaaTanh4::second], aliasDb[AdaaTanh4::first] - 4.0);
+}
+
+// skip() keeps the history, so a stage that was bypassed resumes exactly where a
+// stage that never stopped would be.
+TEST(AdaaTest, SkippedStageResumesSeamlessly) {
+    for (int order : { (int) AdaaTanh4::first, (int) AdaaTanh4::second }) {
+        AdaaTanh4 running, skipped;
+        running.reset();
+        skipped.reset();
+        for (int i = 0; i < 256; ++i) {
+            const float x = 2.0f * (float) std::sin(0.05 * i) + 0.3f * (float) std::sin(1.3 * i);
+            const float expected = lane0(running.process(Vec4::broadcast(x), order));
+            if (i < 100) {
+                skipped.skip(Vec4::broadcast(x));
+                continue;
+            }
+            EXPECT_FLOAT_EQ(lane0(skipped.process(Vec4::broadcast(x), order)), expected) << "order " << order << ", sample " << i;
+        }
+    }
+}
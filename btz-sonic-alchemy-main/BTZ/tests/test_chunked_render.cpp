@@ -0,0 +1,107 @@
+/*
+  Box Tone Zone (BTZ) - test_chunked_render.cpp
+
+  ChunkedRenderer against a plain serial bounce of the same file.
+*/
+#include "../Source/ChunkedRenderer.h"
+#include "BtzTestHelpers.h"
+#include <gtest/gtest.h>
+
+namespace {
+constexpr double sampleRate = 48000.0;
+constexpr int blockSize = 512;
+
+ChunkedRenderer::ProcessorFactory factory() {
+    return [] { return std::make_unique<BTZAudioProcessor>(); };
+}
+
+// One offline instance over the whole file, shifted by its latency like the renderer's output.
+juce::AudioBuffer<float> serialRender(const juce::AudioBuffer<float>& input) {
+    BTZAudioProcessor proc;
+    BtzTest::prepare(proc, sampleRate, blockSize, true);
+    const int latency = proc.getLatencySamples();
+
+    juce::AudioBuffer<float> padded(2, input.getNumSamples() + latency);
+    padded.clear();
+    for (int ch = 0; ch < 2; ++ch)
+        padded.copyFrom(ch, 0, input, ch, 0, input.getNumSamples());
+    const auto rendered = BtzTest::render(proc, padded, blockSize);
+
+    juce::AudioBuffer<float> out(2, input.getNumSamples());
+    for (int ch = 0; ch < 2; ++ch)
+        out.copyFrom(ch, 0, rendered, ch, latency, input.getNumSamples());
+    return out;
+}
+
+ChunkedRenderer::Settings settings(int numChunks, double prerollSeconds = 1.0) {
+    ChunkedRenderer::Settings s;
+    s.numChunks = numChunks;
+    s.blockSize = blockSize;
+    s.prerollSeconds = prerollSeconds;
+    s.seamToleranceDb = -90.0f;
+    return s;
+}
+}
+
+TEST(ChunkedRenderTest, SingleChunkIsBitIdenticalToASerialBounce) {
+    const auto input = BtzTest::noise(72000, 0.3f, 21);
+    ChunkedRenderer renderer(factory(), settings(1));
+    juce::AudioBuffer<float> output;
+    const auto report = renderer.render(input, output, sampleRate);
+    EXPECT_EQ(report.numChunks, 1);
+    EXPECT_TRUE(BtzTest::bitIdentical(output, serialRender(input)));
+}
+
+// The first chunk starts with the file, so it must match bit for bit; after each seam
+// the pre-roll has to bring the output within the tolerance, which is checked here
+// against an independent serial bounce rather than the renderer's own report.
+TEST(ChunkedRenderTest, SeamsStayWithinToleranceOfASerialBounce) {
+    const auto input = BtzTest::noise(144000, 0.3f, 22);
+    const auto serial = serialRender(input);
+    ChunkedRenderer renderer(factory(), settings(4));
+    juce::AudioBuffer<float> output;
+    const auto report = renderer.render(input, output, sampleRate);
+
+    ASSERT_EQ(report.numChunks, 4);
+    ASSERT_EQ(report.seams.size(), (size_t) 3);
+    EXPECT_TRUE(report.withinTolerance) << report.toText().toStdString();
+
+    const int firstSeam = (int) report.seams.front().position;
+    EXPECT_EQ(BtzTest::maxDifference(output, serial, 0, firstSeam), 0.0f);
+    EXPECT_LE(BtzTest::maxDifference(output, serial), juce::Decibels::decibelsToGain(-90.0f));
+}
+
+// A pre-roll far too short for the slow stages: the check with twice the pre-roll has
+// to catch it and the retries have to bring the seams within the tolerance of a real
+// serial bounce, without the renderer ever running one.
+TEST(ChunkedRenderTest, ShortPrerollIsCaughtAndRetried) {
+    const auto input = BtzTest::noise(144000, 0.3f, 23);
+    auto s = settings(4, 0.02);
+    s.maxRetries = 8;
+    ChunkedRenderer renderer(factory(), s);
+    juce::AudioBuffer<float> output;
+    const auto report = renderer.render(input, output, sampleRate);
+
+    EXPECT_TRUE(report.withinTolerance) << report.toText().toStdString();
+    EXPECT_EQ(report.serialSeconds, 0.0);
+    bool retried = false;
+    for (const auto& seam : report.seams)
+        retried = retried || seam.attempts > 1;
+    EXPECT_TRUE(retried) << report.toText().toStdString();
+    EXPECT_LE(BtzTest::maxDifference(output, serialRender(input)), juce::Decibels::decibelsToGain(-90.0f));
+}
+
+// The opt-in serial reference times its own pass and measures the whole file.
+TEST(ChunkedRenderTest, SerialReferenceReportsTimeAndFileDeviation) {
+    const auto input = BtzTest::noise(96000, 0.3f, 24);
+    auto s = settings(3);
+    s.serialReference = true;
+    ChunkedRenderer renderer(factory(), s);
+    juce::AudioBuffer<float> output;
+    const auto report = renderer.render(input, output, sampleRate);
+
+    EXPECT_TRUE(report.withinTolerance) << report.toText().toStdString();
+    EXPECT_GT(report.serialSeconds, 0.0);
+    EXPECT_GT(report.wallSeconds, 0.0);
+    EXPECT_EQ(report.maxFileDeviation, BtzTest::maxDifference(output, serialRender(input)));
+}
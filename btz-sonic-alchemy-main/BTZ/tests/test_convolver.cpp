@@ -0,0 +1,131 @@
+/*
+  Box Tone Zone (BTZ) - test_convolver.cpp
+
+  PartitionedConvolver against direct convolution: the zero-latency head and
+  every segment boundary (64, 1024, 8192), at host block sizes that do and do
+  not divide the partition sizes.
+*/
+#include "../Source/PartitionedConvolver.h"
+#include <JuceHeader.h>
+#include <gtest/gtest.h>
+#include <cmath>
+#include <vector>
+
+namespace {
+constexpr int irLength = 20000;    // two full 4096-pt partitions and a partial third
+constexpr float tolerance = 1.0e-5f;    // -100 dB of the IR / output peak: float FFT rounding, not a misplaced partition
+
+// Host block sizes: one sample, primes, powers of two and some just off them.
+const std::vector<int>& blockSizes() {
+    static const std::vector<int> sizes { 1, 37, 64, 100, 480, 511, 513, 4097 };
+    return sizes;
+}
+
+// Exponentially decaying noise, a different tail per channel, peak near 1.
+juce::AudioBuffer<float> makeIr(int seed) {
+    juce::AudioBuffer<float> ir(2, irLength);
+    juce::Random random(seed);
+    for (int ch = 0; ch < 2; ++ch)
+        for (int i = 0; i < irLength; ++i)
+            ir.setSample(ch, i, (random.nextFloat() * 2.0f - 1.0f) * std::exp(-3.0f * (float) i / irLength));
+    return ir;
+}
+
+// Streams input through a fresh convolver in host blocks of blockSize.
+juce::AudioBuffer<float> convolve(const std::shared_ptr<const ConvolutionKernel>& kernel,
+                                  const juce::AudioBuffer<float>& input, int blockSize) {
+    PartitionedConvolver convolver(kernel);
+    juce::AudioBuffer<float> output(input);
+    for (int pos = 0; pos < output.getNumSamples(); pos += blockSize) {
+        const int n = juce::jmin(blockSize, output.getNumSamples() - pos);
+        float* channels[] = { output.getWritePointer(0, pos), output.getWritePointer(1, pos) };
+        convolver.process(channels, 2, n);
+    }
+    return output;
+}
+
+// Direct convolution in double precision.
+std::vector<double> direct(const juce::AudioBuffer<float>& ir, const juce::AudioBuffer<float>& input, int channel) {
+    const float* h = ir.getReadPointer(channel);
+    const float* x = input.getReadPointer(channel);
+    std::vector<double> y((size_t) input.getNumSamples(), 0.0);
+    for (int n = 0; n < input.getNumSamples(); ++n) {
+        double acc = 0.0;
+        for (int k = 0; k <= juce::jmin(n, irLength - 1); ++k)
+            acc += (double) h[k] * x[n - k];
+        y[(size_t) n] = acc;
+    }
+    return y;
+}
+}
+
+// An impulse part-way into a block reproduces the IR sample for sample, from the
+// first output sample (no latency) across every segment boundary to the tail.
+TEST(ConvolverTest, ImpulseReproducesTheIr) {
+    constexpr int position = 37;
+    const auto ir = makeIr(1);
+    const auto kernel = ConvolutionKernel::create(ir);
+    juce::AudioBuffer<float> input(2, position + irLength + 256);
+    input.clear();
+    input.setSample(0, position, 1.0f);
+    input.setSample(1, position, 1.0f);
+
+    for (int blockSize : blockSizes()) {
+        const auto output = convolve(kernel, input, blockSize);
+        for (int ch = 0; ch < 2; ++ch) {
+            for (int i = 0; i < position; ++i)
+                ASSERT_EQ(output.getSample(ch, i), 0.0f) << "block " << blockSize << ", sample " << i;
+            for (int t = 0; t < irLength; ++t)
+                ASSERT_NEAR(output.getSample(ch, position + t), ir.getSample(ch, t), tolerance)
+                    << "block " << blockSize << ", channel " << ch << ", tap " << t;
+            for (int i = position + irLength; i < output.getNumSamples(); ++i)
+                ASSERT_NEAR(output.getSample(ch, i), 0.0f, tolerance) << "block " << blockSize << ", sample " << i;
+        }
+    }
+}
+
+// The head and the three segments tile the IR without gaps or overlaps.
+TEST(ConvolverTest, KernelCoversTheIrWithEverySegment) {
+    const auto kernel = ConvolutionKernel::create(makeIr(2));
+    ASSERT_EQ(kernel->segments.size(), (size_t) 3);
+    int covered = kernel->headLength;
+    for (const auto& seg : kernel->segments) {
+        EXPECT_EQ(seg.offset, covered) << seg.partitionSize << "-pt segment";
+        covered = seg.offset + seg.numPartitions * seg.partitionSize;
+    }
+    EXPECT_GE(covered, irLength);
+}
+
+// Noise through the convolver against direct convolution, over the head, the
+// segment boundaries and well into the 4096-pt segment.
+TEST(ConvolverTest, NoiseMatchesDirectConvolution) {
+    const auto ir = makeIr(3);
+    const auto kernel = ConvolutionKernel::create(ir);
+    juce::AudioBuffer<float> input(2, irLength + 4096);
+    juce::Random random(4);
+    for (int ch = 0; ch < 2; ++ch)
+        for (int i = 0; i < input.getNumSamples(); ++i)
+            input.setSample(ch, i, random.nextFloat() - 0.5f);
+
+    const std::vector<double> expected[] = { direct(ir, input, 0), direct(ir, input, 1) };
+    double peak = 0.0;
+    for (const auto& y : expected)
+        for (double v : y)
+            peak = juce::jmax(peak, std::abs(v));
+
+    for (int blockSize : blockSizes()) {
+        const auto output = convolve(kernel, input, blockSize);
+        for (int ch = 0; ch < 2; ++ch) {
+            double worst = 0.0;
+            int worstIndex = 0;
+            for (int i = 0; i < output.getNumSamples(); ++i) {
+                const double error = std::abs(output.getSample(ch, i) - expected[ch][(size_t) i]);
+                if (error > worst) {
+                    worst = error;
+                    worstIndex = i;
+                }
+            }
+            EXPECT_LE(worst, tolerance * peak) << "block " << blockSize << ", channel " << ch << ", sample " << worstIndex;
+        }
+    }
+}
@@ -0,0 +1,85 @@
+/*
+  Box Tone Zone (BTZ) - test_dual_mono.cpp
+
+  The dual-mono single-lane path against the same input run on both lanes: the
+  output has to match bit for bit, with Motion at rest, up or turned down.
+*/
+#include "BtzTestHelpers.h"
+#include <gtest/gtest.h>
+#include <cmath>
+#include <vector>
+
+namespace {
+constexpr double sampleRate = 48000.0;
+constexpr int blockSize = 480;
+
+juce::AudioBuffer<float> dualMonoNoise(int numSamples, int seed) {
+    auto buffer = BtzTest::noise(numSamples, 0.3f, seed);
+    buffer.copyFrom(1, 0, buffer, 0, 0, numSamples);
+    return buffer;
+}
+
+// Renders input with the given Motion value per block (one entry per block, the
+// last one held), with the fast path on or off.
+juce::AudioBuffer<float> render(const juce::AudioBuffer<float>& input, float quality,
+                                const std::vector<float>& motion, bool fastPath) {
+    BTZAudioProcessor proc;
+    BtzTest::setParam(proc, BTZParams::qualityMode, quality);
+    BtzTest::setParam(proc, BTZParams::motion, motion.front());
+    proc.setDualMonoFastPath(fastPath);
+    BtzTest::prepare(proc, sampleRate, blockSize);
+
+    juce::AudioBuffer<float> output(input);
+    juce::MidiBuffer midi;
+    for (int pos = 0, index = 0; pos < output.getNumSamples(); pos += blockSize, ++index) {
+        BtzTest::setParam(proc, BTZParams::motion, motion[(size_t) juce::jmin(index, (int) motion.size() - 1)]);
+        const int n = juce::jmin(blockSize, output.getNumSamples() - pos);
+        juce::AudioBuffer<float> block(output.getArrayOfWritePointers(), 2, pos, n);
+        proc.processBlock(block, midi);
+    }
+    return output;
+}
+}
+
+TEST(DualMonoTest, FastPathIsBitIdenticalWithMotionAtRest) {
+    const auto input = dualMonoNoise(96000, 51);
+    for (float quality : { 0.0f, 1.0f, 2.0f }) {
+        EXPECT_TRUE(BtzTest::bitIdentical(render(input, quality, { 0.0f }, true),
+                                          render(input, quality, { 0.0f }, false)))
+            << "quality " << quality;
+    }
+}
+
+// Motion gives each channel its own wow, flutter and hiss, so dual-mono input has to
+// stay on both lanes while it is up (the default is 0.04), moving or not.
+TEST(DualMonoTest, FastPathIsBitIdenticalWhileMotionIsUp) {
+    const auto input = dualMonoNoise(96000, 52);
+    std::vector<float> motion(200, 0.04f);
+    for (int block = 50; block < 200; ++block)
+        motion[(size_t) block] = block < 120 ? 0.6f : 0.02f;
+
+    for (float quality : { 1.0f, 2.0f }) {
+        const auto fast = render(input, quality, motion, true);
+        EXPECT_TRUE(BtzTest::bitIdentical(fast, render(input, quality, motion, false))) << "quality " << quality;
+
+        float spread = 0.0f;
+        for (int i = 0; i < fast.getNumSamples(); ++i)
+            spread = juce::jmax(spread, std::abs(fast.getSample(0, i) - fast.getSample(1, i)));
+        EXPECT_GT(spread, 0.0f) << "quality " << quality;
+    }
+}
+
+// Turning Motion down hands over to the single lane once its smoother has settled;
+// the lanes agree by then, so the handover itself is exact. (Turning it back up
+// leaves through the same 10 ms crossfade as a stereo difference would.)
+TEST(DualMonoTest, FastPathIsBitIdenticalWhenMotionIsTurnedDown) {
+    const auto input = dualMonoNoise(144000, 53);
+    std::vector<float> motion(300, 0.0f);
+    for (int block = 0; block < 40; ++block)
+        motion[(size_t) block] = 0.5f;
+
+    for (float quality : { 1.0f, 2.0f })
+        EXPECT_TRUE(BtzTest::bitIdentical(render(input, quality, motion, true),
+                                          render(input, quality, motion, false)))
+            << "quality " << quality;
+}
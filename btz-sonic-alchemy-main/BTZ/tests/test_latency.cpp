@@ -0,0 +1,122 @@
+/*
+  Box Tone Zone (BTZ) - test_latency.cpp
+
+  Reported latency against what the paths actually delay, realtime and offline.
+*/
+#include "BtzTestHelpers.h"
+#include <gtest/gtest.h>
+#include <utility>
+
+namespace {
+constexpr double sampleRate = 48000.0;
+constexpr int blockSize = 256;
+
+struct LatencyCase {
+    const char* name;
+    std::vector<std::pair<BTZParams::Id, float>> params;
+    bool offline;
+};
+
+const std::vector<LatencyCase>& latencyCases() {
+    static const std::vector<LatencyCase> cases {
+        { "default", {}, false },
+        { "eco", { { BTZParams::qualityMode, 0.0f } }, false },
+        { "4x", { { BTZParams::qualityMode, 2.0f } }, false },
+        { "gate", { { BTZParams::gateRange, 24.0f } }, false },
+        { "motion off", { { BTZParams::motion, 0.0f } }, false },
+        { "limiter", { { BTZParams::limiter, 0.5f } }, false },
+        { "fixed latency", { { BTZParams::fixedLatency, 1.0f }, { BTZParams::motion, 0.0f } }, false },
+        { "render 8x", { { BTZParams::renderQuality, 1.0f } }, true },
+        { "render 16x", { { BTZParams::renderQuality, 2.0f }, { BTZParams::gateRange, 24.0f } }, true },
+    };
+    return cases;
+}
+
+std::unique_ptr<BTZAudioProcessor> makeProcessor(const LatencyCase& c, float mix) {
+    auto proc = std::make_unique<BTZAudioProcessor>();
+    for (const auto& p : c.params)
+        BtzTest::setParam(*proc, p.first, p.second);
+    BtzTest::setParam(*proc, BTZParams::mix, mix);
+    BtzTest::prepare(*proc, sampleRate, blockSize, c.offline);
+    return proc;
+}
+}
+
+// The Mix dry side passes the Punch crossover's allpass, whose impulse response peaks
+// on its first sample. An engaged limiter sums its bands, the same allpass again, and
+// the two in series peak one sample later.
+TEST(LatencyTest, DryPathIsDelayedByTheReportedLatency) {
+    constexpr int position = 1000;
+    for (const auto& c : latencyCases()) {
+        SCOPED_TRACE(c.name);
+        bool limiterOn = false;
+        for (const auto& p : c.params)
+            limiterOn = limiterOn || (p.first == BTZParams::limiter && p.second > 0.0f);
+        auto proc = makeProcessor(c, 0.0f);
+        const auto out = BtzTest::render(*proc, BtzTest::impulse(8192, position, 0.25f), blockSize);
+        const int expected = position + proc->getLatencySamples() + (limiterOn ? 1 : 0);
+        EXPECT_EQ(BtzTest::peakIndex(out, 0), expected);
+        EXPECT_EQ(BtzTest::peakIndex(out, 1), expected);
+    }
+}
+
+// Motion is held at 0 here because it moves the wet delay around its centre by design
+// (the centre itself stays in the "fixed latency" case). The wet path runs through the
+// Punch crossover's allpass, which the Mix dry side shares, so the wet impulse response
+// is lined up against the Mix 0 output rather than a bare delay. Half-band stages and
+// first-order ADAA leave fractional delays an integer latency cannot express, so the
+// best match may be one sample late.
+TEST(LatencyTest, WetPathLinesUpWithTheDryPath) {
+    constexpr int position = 1000, maxLag = 16;
+    for (const auto& c : latencyCases()) {
+        SCOPED_TRACE(c.name);
+        LatencyCase still = c;
+        still.params.push_back({ BTZParams::motion, 0.0f });
+        auto wetProc = makeProcessor(still, 1.0f);
+        auto dryProc = makeProcessor(still, 0.0f);
+        const auto wet = BtzTest::render(*wetProc, BtzTest::impulse(8192, position, 0.1f), blockSize);
+        const auto dry = BtzTest::render(*dryProc, BtzTest::impulse(8192, position, 0.1f), blockSize);
+
+        int bestLag = 0;
+        double best = -1.0e30;
+        for (int lag = -maxLag; lag <= maxLag; ++lag) {
+            double sum = 0.0;
+            for (int i = maxLag; i < dry.getNumSamples() - maxLag; ++i)
+                sum += (double) wet.getSample(0, i + lag) * dry.getSample(0, i);
+            if (sum > best) {
+                best = sum;
+                bestLag = lag;
+            }
+        }
+        EXPECT_GE(bestLag, 0);
+        EXPECT_LE(bestLag, 1);
+    }
+}
+
+// Render Quality 0 follows the realtime mode, so a bounce must match playback bit for bit.
+TEST(LatencyTest, BounceFollowingTheRealtimeModeNullsAgainstPlayback) {
+    const auto input = BtzTest::noise(24000, 0.2f, 11);
+    const LatencyCase realtime { "realtime", {}, false };
+    const LatencyCase offline { "offline", {}, true };
+    auto playback = makeProcessor(realtime, 1.0f);
+    auto bounce = makeProcessor(offline, 1.0f);
+    EXPECT_EQ(playback->getLatencySamples(), bounce->getLatencySamples());
+    EXPECT_TRUE(BtzTest::bitIdentical(BtzTest::render(*playback, input, blockSize),
+                                      BtzTest::render(*bounce, input, blockSize)));
+}
+
+// With a render path the bounce sounds different but must stay aligned with playback:
+// same reported latency, and the dry path nulls.
+TEST(LatencyTest, RenderPathKeepsThePlaybackLatency) {
+    const auto input = BtzTest::noise(24000, 0.2f, 13);
+    for (float renderQuality : { 1.0f, 2.0f }) {
+        SCOPED_TRACE(renderQuality);
+        const LatencyCase realtime { "realtime", { { BTZParams::renderQuality, renderQuality } }, false };
+        const LatencyCase offline { "offline", { { BTZParams::renderQuality, renderQuality } }, true };
+        auto playback = makeProcessor(realtime, 0.0f);
+        auto bounce = makeProcessor(offline, 0.0f);
+        EXPECT_EQ(playback->getLatencySamples(), bounce->getLatencySamples());
+        EXPECT_TRUE(BtzTest::bitIdentical(BtzTest::render(*playback, input, blockSize),
+                                          BtzTest::render(*bounce, input, blockSize)));
+    }
+}
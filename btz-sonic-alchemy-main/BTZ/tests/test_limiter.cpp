@@ -0,0 +1,169 @@
+/*
+  Box Tone Zone (BTZ) - test_limiter.cpp
+
+  LimiterNo6: output ceiling (sample and inter-sample peaks), a flat response
+  under band gain reduction and the idle paths.
+*/
+#include "../Source/LimiterNo6.h"
+#include <JuceHeader.h>
+#include <gtest/gtest.h>
+#include <cmath>
+#include <vector>
+
+namespace {
+constexpr double sampleRate = 48000.0;
+constexpr int blockSize = 512;
+
+// Drum-like test material: decaying 60 Hz kicks and noise bursts well over full scale.
+std::vector<float> drums(int numSamples, int seed) {
+    std::vector<float> out((size_t) numSamples);
+    juce::Random random(seed);
+    for (int i = 0; i < numSamples; ++i) {
+        const double t = (double) (i % 12000) / sampleRate;
+        const double kick = 1.4 * std::exp(-t * 12.0) * std::sin(juce::MathConstants<double>::twoPi * 60.0 * t);
+        const double hit = 1.2 * std::exp(-t * 40.0) * (random.nextFloat() * 2.0f - 1.0f);
+        out[(size_t) i] = (float) (kick + hit);
+    }
+    return out;
+}
+
+void run(LimiterNo6& limiter, std::vector<float>& left, std::vector<float>& right, float amount, float ceilingDb,
+         bool keepLatency) {
+    for (size_t pos = 0; pos < left.size(); pos += blockSize) {
+        const int n = (int) juce::jmin((size_t) blockSize, left.size() - pos);
+        limiter.process(left.data() + pos, right.data() + pos, n, amount, ceilingDb, keepLatency);
+    }
+}
+
+// Largest inter-sample peak from 8x windowed-sinc interpolation (64 taps per phase).
+float interSamplePeak(const std::vector<float>& x, size_t start) {
+    constexpr int factor = 8, halfTaps = 32;
+    float peak = 0.0f;
+    for (size_t i = start + halfTaps; i + halfTaps < x.size(); ++i) {
+        for (int phase = 0; phase < factor; ++phase) {
+            const double frac = (double) phase / factor;
+            double acc = 0.0;
+            for (int k = -halfTaps + 1; k <= halfTaps; ++k) {
+                const double t = (double) k - frac;
+                const double sinc = std::abs(t) < 1.0e-9 ? 1.0 : std::sin(juce::MathConstants<double>::pi * t) / (juce::MathConstants<double>::pi * t);
+                const double window = 0.5 + 0.5 * std::cos(juce::MathConstants<double>::pi * t / halfTaps);
+                acc += x[i + (size_t) k] * sinc * window;
+            }
+            peak = juce::jmax(peak, (float) std::abs(acc));
+        }
+    }
+    return peak;
+}
+
+// Limiter output for a 0.25 s burst of 50 Hz, 700 Hz and 8 kHz tones at full scale,
+// one per band, so every band is pulled down to the same gain. A quiet probe sine
+// starts 5 ms after the burst, while that gain releases.
+std::vector<float> releaseWithProbe(double probeHz, float probeLevel) {
+    constexpr int burstEnd = 12000, probeStart = burstEnd + 240, length = 24000;
+    std::vector<float> left((size_t) length), right((size_t) length);
+    for (int i = 0; i < length; ++i) {
+        const double t = (double) i / sampleRate;
+        double x = 0.0;
+        if (i < burstEnd)
+            for (double hz : { 50.0, 700.0, 8000.0 })
+                x += std::sin(juce::MathConstants<double>::twoPi * hz * t);
+        if (i >= probeStart)
+            x += probeLevel * std::sin(juce::MathConstants<double>::twoPi * probeHz * t);
+        left[(size_t) i] = right[(size_t) i] = (float) x;
+    }
+    LimiterNo6 limiter;
+    limiter.prepare(sampleRate);
+    run(limiter, left, right, 1.0f, -12.0f, false);
+    return left;
+}
+
+// Amplitude of the hz component over x[start, start + length).
+double amplitudeAt(const std::vector<float>& x, int start, int length, double hz) {
+    double re = 0.0, im = 0.0;
+    for (int i = start; i < start + length; ++i) {
+        const double w = juce::MathConstants<double>::twoPi * hz * i / sampleRate;
+        re += x[(size_t) i] * std::cos(w);
+        im += x[(size_t) i] * std::sin(w);
+    }
+    return 2.0 * std::sqrt(re * re + im * im) / length;
+}
+}
+
+TEST(LimiterTest, SamplePeaksStayUnderTheCeiling) {
+    for (float ceilingDb : { -0.1f, -1.0f, -3.0f }) {
+        LimiterNo6 limiter;
+        limiter.prepare(sampleRate);
+        auto left = drums(96000, 1), right = drums(96000, 2);
+        run(limiter, left, right, 1.0f, ceilingDb, false);
+
+        // Skip the first 0.5 s, while the limiter fades in from the dry input.
+        const float ceiling = juce::Decibels::decibelsToGain(ceilingDb);
+        for (size_t i = 24000; i < left.size(); ++i) {
+            ASSERT_LE(std::abs(left[i]), ceiling) << "ceiling " << ceilingDb << " dB, sample " << i;
+            ASSERT_LE(std::abs(right[i]), ceiling) << "ceiling " << ceilingDb << " dB, sample " << i;
+        }
+    }
+}
+
+// The true-peak stage detects at 4x with a short filter, so inter-sample peaks may
+// pass the ceiling slightly; they must stay within a fraction of a dB.
+TEST(LimiterTest, InterSamplePeaksStayNearTheCeiling) {
+    for (float ceilingDb : { -0.1f, -1.0f }) {
+        LimiterNo6 limiter;
+        limiter.prepare(sampleRate);
+        auto left = drums(48000, 3), right = drums(48000, 4);
+        run(limiter, left, right, 1.0f, ceilingDb, false);
+
+        const float peakDb = juce::Decibels::gainToDecibels(juce::jmax(interSamplePeak(left, 24000), interSamplePeak(right, 24000)));
+        EXPECT_LE(peakDb, ceilingDb + 0.5f) << "ceiling " << ceilingDb << " dB";
+    }
+}
+
+// The probe stays far below the ceiling, so the gains it meets are those the burst
+// left behind, equal in every band; subtracting the burst-only output leaves the
+// probe as the limiter passes it. Its level has to be the same at every frequency,
+// the crossover points included, rather than swinging by several dB the way a
+// (g - 1) * band delta on the input does.
+TEST(LimiterTest, UniformGainReductionIsFlat) {
+    constexpr int start = 12720, length = 4800;    // 10 ms after the burst, 0.1 s of probe
+    const auto burstOnly = releaseWithProbe(0.0, 0.0f);
+
+    double lowest = 1.0e9, highest = -1.0e9;
+    for (double hz : { 60.0, 120.0, 400.0, 1000.0, 2500.0, 6300.0 }) {
+        auto probe = releaseWithProbe(hz, 0.005f);
+        for (size_t i = 0; i < probe.size(); ++i)
+            probe[i] -= burstOnly[i];
+        const double db = 20.0 * std::log10(amplitudeAt(probe, start, length, hz) / 0.005);
+        EXPECT_LT(db, 12.0 - 3.0) << hz << " Hz";    // at least 3 dB under the +12 dB drive
+        lowest = juce::jmin(lowest, db);
+        highest = juce::jmax(highest, db);
+    }
+    EXPECT_LT(highest - lowest, 1.0);
+}
+
+TEST(LimiterTest, OffWithoutLatencyPassesTheInputUntouched) {
+    LimiterNo6 limiter;
+    limiter.prepare(sampleRate);
+    const auto inputL = drums(24000, 5), inputR = drums(24000, 6);
+    auto left = inputL, right = inputR;
+    run(limiter, left, right, 0.0f, -1.0f, false);
+    EXPECT_EQ(left, inputL);
+    EXPECT_EQ(right, inputR);
+}
+
+// Fixed Latency keeps the lookahead in the path while the limiter is off.
+TEST(LimiterTest, OffWithLatencyIsAPureDelay) {
+    LimiterNo6 limiter;
+    limiter.prepare(sampleRate);
+    const int latency = limiter.getLatencySamples();
+    ASSERT_GT(latency, 0);
+    const auto inputL = drums(24000, 7), inputR = drums(24000, 8);
+    auto left = inputL, right = inputR;
+    run(limiter, left, right, 0.0f, -1.0f, true);
+    for (size_t i = 0; i < left.size(); ++i) {
+        const float expectedL = i >= (size_t) latency ? inputL[i - (size_t) latency] : 0.0f;
+        const float expectedR = i >= (size_t) latency ? inputR[i - (size_t) latency] : 0.0f;
+        ASSERT_EQ(left[i], expectedL) << "sample " << i;
+        ASSERT_EQ(right[i], expectedR) << "sample " << i;
+    }
+}
@@ -0,0 +1,282 @@
+/*
+  Box Tone Zone (BTZ) - DspBenchmark.cpp
+
+  Per-stage CPU benchmark:
+    btz_bench [--seconds S] [--rate Hz] [--block N] [--isa sse2|neon|avx2|avx512]
+
+  Times every tape hysteresis solver at each quality mode's processing rate and
+  prints ns/sample plus the share of one core needed to run it in real time,
+  then times each block kernel variant the CPU supports. --isa forces the
+  variant used by the rest of the run, like the BTZ_ISA environment variable.
+  Then bounces --seconds of noise offline at 8x in 8192-sample blocks with the
+  render pipeline on, once on one thread and once across cores, and prints both
+  times and whether the outputs are bit-identical. Runs a stereo 2 s impulse
+  response through the partitioned convolver in --block sample callbacks and
+  prints the mean and worst callback time against the block period. Finally
+  prints the heap one processor instance holds when prepared for --block
+  samples at --rate.
+*/
+#include "../Source/DspKernels.h"
+#include "../Source/PartitionedConvolver.h"
+#include "../Source/PluginProcessor.h"
+#include "../Source/TapeHysteresis.h"
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <thread>
+
+namespace {
+struct SolverCase {
+    const char* name;
+    TapeHysteresis::Solver solver;
+    int iterations;
+    bool table;
+};
+
+const SolverCase solverCases[] = {
+    { "rk2 + table", TapeHysteresis::rk2, 4, true },
+    { "rk2",         TapeHysteresis::rk2, 4, false },
+    { "rk4 + table", TapeHysteresis::rk4, 4, true },
+    { "rk4",         TapeHysteresis::rk4, 4, false },
+    { "newton x4",   TapeHysteresis::newtonRaphson, 4, false },
+    { "newton x8",   TapeHysteresis::newtonRaphson, 8, false },
+};
+
+// Mirrors BTZAudioProcessor::configureTapeSolver with Tape Solver = Auto.
+const char* autoChoice(int mode) {
+    switch (mode) {
+        case 0:  return "rk2 + table";
+        case 1:  return "rk2";
+        case 2:  return "rk4";
+        default: return "newton x8";
+    }
+}
+
+static double timeSolver(const SolverCase& sc, double processingRate, double seconds) {
+    TapeHysteresis tape;
+    tape.prepare(processingRate);
+    tape.setParameters(0.7f, 0.5f);
+    tape.setSolver(sc.solver, sc.iterations);
+    tape.setUseTable(sc.table);
+
+    constexpr int blockSize = 512;
+    std::vector<float> left((size_t) blockSize), right((size_t) blockSize);
+    const int totalSamples = juce::jmax(blockSize, (int) (processingRate * seconds));
+    const double w = juce::MathConstants<double>::twoPi * 110.0 / processingRate;
+
+    double elapsed = 0.0;
+    volatile float sink = 0.0f;
+    for (int start = 0; start < totalSamples; start += blockSize) {
+        // A loud 110 Hz tone keeps the loop in its non-linear region.
+        for (int n = 0; n < blockSize; ++n) {
+            const float x = 0.8f * (float) std::sin(w * (start + n));
+            left[(size_t) n] = x;
+            right[(size_t) n] = -x;
+        }
+        const auto t0 = std::chrono::steady_clock::now();
+        tape.processBlock(left.data(), right.data(), blockSize);
+        elapsed += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        sink = sink + left[0];
+    }
+    juce::ignoreUnused(sink);
+    return elapsed * 1.0e9 / (double) totalSamples;
+}
+
+// ns per sample of each kernel over a block the size of one FFT segment.
+static void timeKernels(DspKernels::Isa isa, double seconds) {
+    const DspKernels::Isa previous = DspKernels::getSelected();
+    DspKernels::select(isa);
+    const auto& k = DspKernels::get();
+
+    constexpr int n = 2048;
+    std::vector<float> a((size_t) n), b((size_t) n), c((size_t) n), d((size_t) n), e((size_t) n), f((size_t) n);
+    juce::Random random(1);
+    for (int i = 0; i < n; ++i) {
+        a[(size_t) i] = random.nextFloat() - 0.5f;
+        b[(size_t) i] = random.nextFloat() - 0.5f;
+        c[(size_t) i] = random.nextFloat() - 0.5f;
+        d[(size_t) i] = random.nextFloat() - 0.5f;
+        f[(size_t) i] = random.nextFloat();
+    }
+
+    const int reps = juce::jmax(1, (int) (seconds * 48000.0 * 8.0 / n));
+    volatile float sink = 0.0f;
+    auto time = [&](auto&& body) {
+        const auto t0 = std::chrono::steady_clock::now();
+        for (int r = 0; r < reps; ++r)
+            body();
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count() * 1.0e9 / ((double) reps * n);
+    };
+
+    const double cmac = time([&] { k.complexMultiplyAccumulate(e.data(), c.data(), a.data(), b.data(), d.data(), f.data(), n); });
+    const double dot = time([&] { sink = sink + k.dot(a.data(), b.data(), n); });
+    const double mix = time([&] { k.mixToDry(e.data(), a.data(), f.data(), n); });
+    const double energy = time([&] {
+        float peak = 0.0f, sq = 0.0f;
+        k.peakAndEnergy(a.data(), n, peak, sq);
+        sink = sink + peak + sq;
+    });
+    // All four meter streams in one pass; per frame, i.e. for four samples.
+    const double meter = time([&] {
+        MeterSums sums;
+        const float* streams[4] = { a.data(), b.data(), c.data(), d.data() };
+        k.meter(streams, n, 0.999f, sums);
+        sink = sink + sums.peak[0] + sums.cross + sums.clips[3];
+    });
+    juce::ignoreUnused(sink);
+
+    char line[192];
+    std::snprintf(line, sizeof(line), "  %-8s cmac %6.3f  dot %6.3f  mix %6.3f  peak+energy %6.3f  meter x4 %6.3f ns",
+                  DspKernels::getName(isa), cmac, dot, mix, energy, meter);
+    std::cout << line << std::endl;
+    DspKernels::select(previous);
+}
+
+// One offline bounce with the render pipeline on; returns seconds spent in processBlock.
+static double timeBounce(int workers, double hostRate, double seconds, std::vector<float>& out) {
+    constexpr int blockSize = 8192;
+    BTZAudioProcessor processor;
+    auto& apvts = processor.getAPVTS();
+    if (auto* param = apvts.getParameter(BTZParams::spec(BTZParams::renderPipeline).id))
+        param->setValueNotifyingHost(1.0f);
+    if (auto* param = apvts.getParameter(BTZParams::spec(BTZParams::renderQuality).id))
+        param->setValueNotifyingHost(0.5f);   // 8x
+    processor.setRenderPipelineWorkers(workers);
+    processor.setNonRealtime(true);
+    processor.setPlayConfigDetails(2, 2, hostRate, blockSize);
+    processor.prepareToPlay(hostRate, blockSize);
+
+    juce::Random random(1);
+    juce::AudioBuffer<float> buffer(2, blockSize);
+    juce::MidiBuffer midi;
+    const int numBlocks = juce::jmax(1, (int) (seconds * hostRate / blockSize));
+    out.clear();
+    double elapsed = 0.0;
+    for (int b = 0; b < numBlocks; ++b) {
+        for (int ch = 0; ch < 2; ++ch)
+            for (int i = 0; i < blockSize; ++i)
+                buffer.setSample(ch, i, (random.nextFloat() - 0.5f) * 0.5f);
+        const auto t0 = std::chrono::steady_clock::now();
+        processor.processBlock(buffer, midi);
+        elapsed += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        for (int ch = 0; ch < 2; ++ch)
+            out.insert(out.end(), buffer.getReadPointer(ch), buffer.getReadPointer(ch) + blockSize);
+    }
+    processor.releaseResources();
+    return elapsed;
+}
+
+// Mean and worst time of one convolver callback, in microseconds. The worst case is
+// what has to fit the block period; the large partitions used to land in one call.
+static void timeConvolver(double hostRate, int blockSize, double seconds, double& meanUs, double& worstUs) {
+    const int irLength = (int) (2.0 * hostRate);
+    juce::AudioBuffer<float> ir(2, irLength);
+    juce::Random random(2);
+    for (int ch = 0; ch < 2; ++ch)
+        for (int i = 0; i < irLength; ++i)
+            ir.setSample(ch, i, (random.nextFloat() - 0.5f) * std::exp(-3.0f * (float) i / (float) irLength));
+
+    PartitionedConvolver convolver(ConvolutionKernel::create(ir));
+    convolver.reset();
+
+    juce::AudioBuffer<float> buffer(2, blockSize);
+    const int numBlocks = juce::jmax(1, (int) (seconds * hostRate / blockSize));
+    double total = 0.0;
+    worstUs = 0.0;
+    for (int b = 0; b < numBlocks; ++b) {
+        for (int ch = 0; ch < 2; ++ch)
+            for (int i = 0; i < blockSize; ++i)
+                buffer.setSample(ch, i, (random.nextFloat() - 0.5f) * 0.5f);
+        const auto t0 = std::chrono::steady_clock::now();
+        convolver.process(buffer.getArrayOfWritePointers(), 2, blockSize);
+        const double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count();
+        total += us;
+        worstUs = juce::jmax(worstUs, us);
+    }
+    meanUs = total / numBlocks;
+}
+}
+
+int main(int argc, char* argv[]) {
+    double seconds = 2.0, hostRate = 48000.0;
+    int blockSize = 512;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const juce::String arg(argv[i]);
+        if (arg == "--seconds")   seconds = juce::jmax(0.1, juce::String(argv[i + 1]).getDoubleValue());
+        else if (arg == "--rate") hostRate = juce::jmax(8000.0, juce::String(argv[i + 1]).getDoubleValue());
+        else if (arg == "--block") blockSize = juce::jlimit(1, 65536, juce::String(argv[i + 1]).getIntValue());
+        else if (arg == "--isa") {
+            DspKernels::Isa isa;
+            if (! DspKernels::fromName(argv[i + 1], isa) || ! DspKernels::select(isa)) {
+                std::cerr << "Kernel variant not available on this build/CPU: " << argv[i + 1] << std::endl;
+                return 1;
+            }
+        } else {
+            std::cerr << "Usage: btz_bench [--seconds S] [--rate Hz] [--block N] [--isa sse2|neon|avx2|avx512]" << std::endl;
+            return 1;
+        }
+    }
+
+    const char* modeNames[] = { "Eco (1x)", "2x", "4x", "Render (8x)" };
+    const int osFactors[] = { 1, 2, 4, 8 };
+
+    std::cout << "Tape hysteresis, host rate " << hostRate << " Hz (ns per processed sample, % of one core)" << std::endl;
+    for (int mode = 0; mode < 4; ++mode) {
+        const double processingRate = hostRate * osFactors[mode];
+        std::cout << std::endl << modeNames[mode] << " @ " << processingRate << " Hz, auto = " << autoChoice(mode) << std::endl;
+        for (const auto& sc : solverCases) {
+            const double ns = timeSolver(sc, processingRate, seconds);
+            const double load = ns * processingRate * 1.0e-7;
+            char line[128];
+            std::snprintf(line, sizeof(line), "  %-12s %8.1f ns  %6.2f %%", sc.name, ns, load);
+            std::cout << line << std::endl;
+        }
+    }
+
+    std::cout << std::endl << "Block kernels (ns per sample, selected: "
+              << DspKernels::getName(DspKernels::getSelected()) << ")" << std::endl;
+    for (int i = 0; i < DspKernels::numIsas; ++i)
+        if (DspKernels::isAvailable((DspKernels::Isa) i))
+            timeKernels((DspKernels::Isa) i, juce::jmin(seconds, 0.5));
+
+    juce::ScopedJuceInitialiser_GUI juceInit;
+
+    const int workers = juce::jlimit(1, 4, (int) std::thread::hardware_concurrency() - 1);
+    std::vector<float> serialOut, pipelinedOut;
+    const double serial = timeBounce(0, hostRate, seconds, serialOut);
+    const double pipelined = timeBounce(workers, hostRate, seconds, pipelinedOut);
+    std::cout << std::endl << "Render pipeline, 8x offline bounce in 8192-sample blocks (s of processing)" << std::endl;
+    char pipelineLine[128];
+    std::snprintf(pipelineLine, sizeof(pipelineLine), "  serial      %8.3f", serial);
+    std::cout << pipelineLine << std::endl;
+    std::snprintf(pipelineLine, sizeof(pipelineLine), "  %d workers   %8.3f  (%.2fx, output %s)", workers, pipelined,
+                  serial / juce::jmax(1.0e-9, pipelined), serialOut == pipelinedOut ? "identical" : "DIFFERENT");
+    std::cout << pipelineLine << std::endl;
+
+    double convMean = 0.0, convWorst = 0.0;
+    timeConvolver(hostRate, blockSize, seconds, convMean, convWorst);
+    const double periodUs = blockSize * 1.0e6 / hostRate;
+    std::cout << std::endl << "Partitioned convolver, stereo 2 s IR in " << blockSize << "-sample callbacks (us)" << std::endl;
+    char convLine[128];
+    std::snprintf(convLine, sizeof(convLine), "  mean  %8.1f  (%5.1f %% of the %.0f us period)", convMean, 100.0 * convMean / periodUs, periodUs);
+    std::cout << convLine << std::endl;
+    std::snprintf(convLine, sizeof(convLine), "  worst %8.1f  (%5.1f %%)", convWorst, 100.0 * convWorst / periodUs);
+    std::cout << convLine << std::endl;
+
+    BTZAudioProcessor processor;
+    processor.setPlayConfigDetails(2, 2, hostRate, blockSize);
+    processor.prepareToPlay(hostRate, blockSize);
+    const auto report = processor.getMemoryReport();
+
+    std::cout << std::endl << "Memory, one instance prepared for " << blockSize << " samples (KiB)" << std::endl;
+    for (const auto& item : report.items) {
+        char line[96];
+        std::snprintf(line, sizeof(line), "  %-18s %10.1f", item.name, (double) item.bytes / 1024.0);
+        std::cout << line << std::endl;
+    }
+    char total[96];
+    std::snprintf(total, sizeof(total), "  %-18s %10.1f", "total", (double) report.getTotalBytes() / 1024.0);
+    std::cout << total << std::endl;
+    processor.releaseResources();
+    return 0;
+}
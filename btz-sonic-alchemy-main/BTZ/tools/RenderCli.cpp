@@ -0,0 +1,115 @@
+/*
+  Box Tone Zone (BTZ) - RenderCli.cpp
+
+  Headless offline renderer:
+    btz_render <in.wav> <out.wav> [--chunks N] [--preroll sec] [--verify sec]
+               [--tolerance dB] [--block N] [--reference preroll|serial]
+               [--state file] [--report file] [--param id=value ...]
+*/
+#include "../Source/ChunkedRenderer.h"
+#include "../Source/PluginProcessor.h"
+#include <iostream>
+
+namespace {
+struct CliOptions {
+    juce::File inputFile, outputFile, stateFile, reportFile;
+    ChunkedRenderer::Settings settings;
+    std::vector<std::pair<juce::String, float>> params;
+};
+
+static bool parseArgs(int argc, char* argv[], CliOptions& opts) {
+    if (argc < 3)
+        return false;
+
+    opts.inputFile = juce::File::getCurrentWorkingDirectory().getChildFile(argv[1]);
+    opts.outputFile = juce::File::getCurrentWorkingDirectory().getChildFile(argv[2]);
+
+    for (int i = 3; i < argc; ++i) {
+        const juce::String arg(argv[i]);
+        const bool hasValue = i + 1 < argc;
+        if (! hasValue)
+            return false;
+        const juce::String value(argv[++i]);
+
+        if (arg == "--chunks")          opts.settings.numChunks = value.getIntValue();
+        else if (arg == "--preroll")    opts.settings.prerollSeconds = value.getDoubleValue();
+        else if (arg == "--verify")     opts.settings.verifySeconds = value.getDoubleValue();
+        else if (arg == "--tolerance")  opts.settings.seamToleranceDb = value.getFloatValue();
+        else if (arg == "--block")      opts.settings.blockSize = value.getIntValue();
+        else if (arg == "--retries")    opts.settings.maxRetries = value.getIntValue();
+        else if (arg == "--reference")  opts.settings.serialReference = value == "serial";
+        else if (arg == "--state")      opts.stateFile = juce::File::getCurrentWorkingDirectory().getChildFile(value);
+        else if (arg == "--report")     opts.reportFile = juce::File::getCurrentWorkingDirectory().getChildFile(value);
+        else if (arg == "--param")
+            opts.params.emplace_back(value.upToFirstOccurrenceOf("=", false, false),
+                                     value.fromFirstOccurrenceOf("=", false, false).getFloatValue());
+        else
+            return false;
+    }
+    return true;
+}
+
+static void printUsage() {
+    std::cout << "usage: btz_render <in.wav> <out.wav> [--chunks N] [--preroll sec] [--verify sec]\n"
+                 "                  [--tolerance dB] [--block N] [--retries N] [--reference preroll|serial]\n"
+                 "                  [--state file] [--report file] [--param id=value ...]\n";
+}
+}
+
+int main(int argc, char* argv[]) {
+    juce::ScopedJuceInitialiser_GUI juceInit;
+
+    CliOptions opts;
+    if (! parseArgs(argc, argv, opts)) {
+        printUsage();
+        return 2;
+    }
+
+    juce::AudioFormatManager formats;
+    formats.registerBasicFormats();
+    std::unique_ptr<juce::AudioFormatReader> reader(formats.createReaderFor(opts.inputFile));
+    if (reader == nullptr) {
+        std::cerr << "cannot read " << opts.inputFile.getFullPathName().toStdString() << "\n";
+        return 1;
+    }
+
+    // BTZ is a stereo processor; mono sources are duplicated to both channels.
+    const int length = (int) reader->lengthInSamples;
+    juce::AudioBuffer<float> input(2, length);
+    reader->read(&input, 0, length, 0, true, true);
+    const double sampleRate = reader->sampleRate;
+
+    juce::MemoryBlock state;
+    if (opts.stateFile.existsAsFile())
+        opts.stateFile.loadFileAsData(state);
+
+    auto factory = [&opts, &state]() -> std::unique_ptr<juce::AudioProcessor> {
+        auto proc = std::make_unique<BTZAudioProcessor>();
+        if (state.getSize() > 0)
+            proc->setStateInformation(state.getData(), (int) state.getSize());
+        for (const auto& p : opts.params)
+            if (auto* param = proc->getAPVTS().getParameter(p.first))
+                param->setValueNotifyingHost(param->convertTo0to1(p.second));
+        return proc;
+    };
+
+    ChunkedRenderer renderer(factory, opts.settings);
+    juce::AudioBuffer<float> output;
+    const auto report = renderer.render(input, output, sampleRate);
+
+    opts.outputFile.deleteFile();
+    juce::WavAudioFormat wav;
+    std::unique_ptr<juce::AudioFormatWriter> writer(
+        wav.createWriterFor(new juce::FileOutputStream(opts.outputFile), sampleRate, 2, 24, {}, 0));
+    if (writer == nullptr || ! writer->writeFromAudioSampleBuffer(output, 0, output.getNumSamples())) {
+        std::cerr << "cannot write " << opts.outputFile.getFullPathName().toStdString() << "\n";
+        return 1;
+    }
+
+    const auto text = report.toText();
+    std::cout << text.toStdString();
+    if (opts.reportFile.getFullPathName().isNotEmpty())
+        opts.reportFile.replaceWithText(text);
+
+    return report.withinTolerance ? 0 : 3;
+}
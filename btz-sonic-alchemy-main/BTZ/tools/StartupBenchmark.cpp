@@ -0,0 +1,119 @@
+/*
+  Box Tone Zone (BTZ) - StartupBenchmark.cpp
+
+  Session-load benchmark:
+    btz_startup [--counts 1,50,500] [--rate Hz] [--block N]
+
+  For each count, creates that many processors and times every phase of a
+  session load across all of them: construction, prepareToPlay, loading a
+  saved non-default state, opening an editor (create, size, first paint) and
+  closing it, and destruction. Prints the total per phase and the cost per
+  instance.
+*/
+#include "../Source/PluginProcessor.h"
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+
+namespace {
+struct PhaseTimes {
+    double construct = 0.0, prepare = 0.0, loadState = 0.0, openEditor = 0.0, destroy = 0.0;
+};
+
+template <typename Body>
+static double timeMs(Body&& body) {
+    const auto t0 = std::chrono::steady_clock::now();
+    body();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+
+// A state with every parameter away from its default, as a real session would have.
+static juce::MemoryBlock makeSessionState() {
+    BTZAudioProcessor reference;
+    for (const auto& p : BTZParams::table)
+        if (auto* param = reference.getAPVTS().getParameter(p.id))
+            param->setValueNotifyingHost(p.index == BTZParams::bypass ? 0.0f : 0.37f);
+    juce::MemoryBlock state;
+    reference.getStateInformation(state);
+    return state;
+}
+
+static PhaseTimes runSession(int count, double rate, int blockSize, const juce::MemoryBlock& state) {
+    PhaseTimes t;
+    std::vector<std::unique_ptr<BTZAudioProcessor>> instances;
+    instances.reserve((size_t) count);
+
+    t.construct = timeMs([&] {
+        for (int i = 0; i < count; ++i)
+            instances.push_back(std::make_unique<BTZAudioProcessor>());
+    });
+    t.prepare = timeMs([&] {
+        for (auto& p : instances) {
+            p->setPlayConfigDetails(2, 2, rate, blockSize);
+            p->prepareToPlay(rate, blockSize);
+        }
+    });
+    t.loadState = timeMs([&] {
+        for (auto& p : instances)
+            p->setStateInformation(state.getData(), (int) state.getSize());
+    });
+    t.openEditor = timeMs([&] {
+        for (auto& p : instances) {
+            std::unique_ptr<juce::AudioProcessorEditor> editor(p->createEditorIfNeeded());
+            editor->createComponentSnapshot(editor->getLocalBounds());
+        }
+    });
+    t.destroy = timeMs([&] {
+        for (auto& p : instances)
+            p->releaseResources();
+        instances.clear();
+    });
+    return t;
+}
+
+static void printRow(const char* phase, double totalMs, int count) {
+    char line[128];
+    std::snprintf(line, sizeof(line), "  %-12s %10.2f ms  %10.1f us/instance", phase, totalMs, totalMs * 1000.0 / count);
+    std::cout << line << std::endl;
+}
+}
+
+int main(int argc, char* argv[]) {
+    juce::ScopedJuceInitialiser_GUI juceInit;
+
+    std::vector<int> counts { 1, 50, 500 };
+    double rate = 48000.0;
+    int blockSize = 512;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const juce::String arg(argv[i]);
+        if (arg == "--counts") {
+            counts.clear();
+            for (const auto& token : juce::StringArray::fromTokens(argv[i + 1], ",", ""))
+                if (token.getIntValue() > 0)
+                    counts.push_back(token.getIntValue());
+        }
+        else if (arg == "--rate")  rate = juce::jmax(8000.0, juce::String(argv[i + 1]).getDoubleValue());
+        else if (arg == "--block") blockSize = juce::jlimit(1, 65536, juce::String(argv[i + 1]).getIntValue());
+        else {
+            std::cerr << "Usage: btz_startup [--counts 1,50,500] [--rate Hz] [--block N]" << std::endl;
+            return 1;
+        }
+    }
+
+    const auto state = makeSessionState();
+    // Process-wide one-off work (kernel dispatch, shared tables, fonts) is paid here, not by the first count.
+    runSession(1, rate, blockSize, state);
+
+    for (int count : counts) {
+        const auto t = runSession(count, rate, blockSize, state);
+        std::cout << std::endl << count << (count == 1 ? " instance" : " instances")
+                  << " @ " << rate << " Hz, block " << blockSize << std::endl;
+        printRow("construct", t.construct, count);
+        printRow("prepare", t.prepare, count);
+        printRow("load state", t.loadState, count);
+        printRow("open editor", t.openEditor, count);
+        printRow("destroy", t.destroy, count);
+        printRow("total", t.construct + t.prepare + t.loadState + t.openEditor + t.destroy, count);
+    }
+    return 0;
+}
@@ -0,0 +1,384 @@
+/*
+  Box Tone Zone (BTZ) - StressHost.cpp
+
+  Multi-instance stress host:
+    btz_stress [--instances 200] [--threads 16] [--block 64] [--rate 48000]
+               [--seconds 10] [--automation 400] [--switches 2] [--loads 1]
+               [--seed 1] [--max-misses N] [--governor 0|1]
+
+  Simulates a DAW's multicore graph: every block period a driver thread wakes
+  the worker pool, the workers pull instances off a shared index and call
+  processBlock(), and the callback must finish within one block duration.
+  Random parameter automation (events per second, applied at callback start),
+  quality-mode switches and state loads (on the message thread, which runs in
+  main() so the processors' timers fire as in a host) keep every instance busy.
+
+  Prints p50/p99/max of the whole callback and of single processBlock calls,
+  the number of missed deadlines and, on Linux when perf events are permitted,
+  the workers' hardware cache misses. Exit code 3 when misses exceed --max-misses.
+  --governor 1 turns on every instance's CPU governor and reports how many
+  ended below their selected quality and how often they stepped down.
+*/
+#include "../Source/PluginProcessor.h"
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <thread>
+
+#if JUCE_LINUX
+ #include <linux/perf_event.h>
+ #include <sys/syscall.h>
+ #include <unistd.h>
+#endif
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+struct StressOptions {
+    int instances = 200, threads = 16, blockSize = 64;
+    double rate = 48000.0, seconds = 10.0;
+    double automationPerSecond = 400.0, switchesPerSecond = 2.0, loadsPerSecond = 1.0;
+    int seed = 1;
+    int maxMisses = -1;
+    bool governor = false;
+};
+
+// Hardware cache misses of the calling thread, where the OS allows it.
+class CacheMissCounter {
+public:
+    CacheMissCounter() {
+#if JUCE_LINUX
+        perf_event_attr attr {};
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd = (int) syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+#endif
+    }
+
+    ~CacheMissCounter() {
+#if JUCE_LINUX
+        if (fd >= 0)
+            close(fd);
+#endif
+    }
+
+    bool isAvailable() const noexcept { return fd >= 0; }
+
+    long long read() const noexcept {
+        long long value = 0;
+#if JUCE_LINUX
+        if (fd >= 0 && ::read(fd, &value, sizeof(value)) != (ssize_t) sizeof(value))
+            value = 0;
+#endif
+        return value;
+    }
+
+private:
+    int fd = -1;
+};
+
+// Microsecond buckets up to 50 ms; percentiles without allocating on the workers.
+class LatencyHistogram {
+public:
+    static constexpr int numBuckets = 50000;
+
+    LatencyHistogram() : counts((size_t) numBuckets + 1, 0) {}
+
+    void add(double us) noexcept {
+        counts[(size_t) juce::jlimit(0, numBuckets, (int) us)]++;
+        maxUs = juce::jmax(maxUs, us);
+        ++total;
+    }
+
+    void merge(const LatencyHistogram& other) {
+        for (size_t i = 0; i < counts.size(); ++i)
+            counts[i] += other.counts[i];
+        maxUs = juce::jmax(maxUs, other.maxUs);
+        total += other.total;
+    }
+
+    double percentile(double p) const {
+        const auto target = (long long) std::ceil(p * (double) total);
+        long long seen = 0;
+        for (size_t i = 0; i < counts.size(); ++i)
+            if ((seen += counts[i]) >= target && seen > 0)
+                return i == (size_t) numBuckets ? maxUs : (double) i + 0.5;
+        return 0.0;
+    }
+
+    double getMax() const noexcept { return maxUs; }
+    long long getCount() const noexcept { return total; }
+
+private:
+    std::vector<long long> counts;
+    double maxUs = 0.0;
+    long long total = 0;
+};
+
+struct Instance {
+    std::unique_ptr<BTZAudioProcessor> processor;
+    juce::AudioBuffer<float> input, buffer;
+};
+
+class StressHost {
+public:
+    explicit StressHost(const StressOptions& o) : opts(o), random((unsigned) o.seed) {}
+
+    // Message thread.
+    void prepare() {
+        instances.resize((size_t) opts.instances);
+        std::uniform_real_distribution<float> noise(-0.5f, 0.5f);
+        for (auto& inst : instances) {
+            inst.processor = std::make_unique<BTZAudioProcessor>();
+            inst.processor->setPlayConfigDetails(2, 2, opts.rate, opts.blockSize);
+            inst.processor->prepareToPlay(opts.rate, opts.blockSize);
+            if (auto* param = inst.processor->getAPVTS().getParameter(BTZParams::spec(BTZParams::qualityGovernor).id))
+                param->setValueNotifyingHost(opts.governor ? 1.0f : 0.0f);
+            inst.input.setSize(2, opts.blockSize);
+            inst.buffer.setSize(2, opts.blockSize);
+            for (int ch = 0; ch < 2; ++ch)
+                for (int i = 0; i < opts.blockSize; ++i)
+                    inst.input.setSample(ch, i, noise(random));
+        }
+
+        // A few distinct sessions to load while running.
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        BTZAudioProcessor source;
+        for (auto& state : states) {
+            for (const auto& p : BTZParams::table)
+                if (p.index != BTZParams::bypass && p.index != BTZParams::qualityGovernor)
+                    if (auto* param = source.getAPVTS().getParameter(p.id))
+                        param->setValueNotifyingHost(unit(random));
+            source.getStateInformation(state);
+        }
+    }
+
+    // Driver thread: runs the whole simulation, then stops the message loop.
+    void run() {
+        const double periodSeconds = opts.blockSize / opts.rate;
+        const auto period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(periodSeconds));
+        const int numCallbacks = juce::jmax(1, (int) (opts.seconds / periodSeconds));
+        callbackUs.reserve((size_t) numCallbacks);
+
+        std::vector<std::thread> workers;
+        workerHistograms.resize((size_t) opts.threads);
+        workerCacheMisses.assign((size_t) opts.threads, -1);
+        parkedWorkers.store(opts.threads);
+        // Taken before any worker starts, so a late-starting worker still sees the first cycle.
+        const unsigned firstGeneration = generation.load();
+        for (int w = 0; w < opts.threads; ++w)
+            workers.emplace_back([this, w, firstGeneration] { workerLoop(w, firstGeneration); });
+
+        const double automationPerCallback = opts.automationPerSecond * periodSeconds;
+        const double switchChance = opts.switchesPerSecond * periodSeconds;
+        const double loadChance = opts.loadsPerSecond * periodSeconds;
+        std::uniform_real_distribution<double> unit(0.0, 1.0);
+        std::uniform_int_distribution<int> pickInstance(0, opts.instances - 1);
+        std::uniform_int_distribution<int> pickParam(0, BTZParams::count - 1);
+        double automationDebt = 0.0;
+
+        auto deadline = Clock::now() + period;
+        for (int cycle = 0; cycle < numCallbacks; ++cycle) {
+            std::this_thread::sleep_until(deadline - period);
+            const auto start = Clock::now();
+
+            // Host automation lands at the start of the callback, before the graph runs.
+            for (automationDebt += automationPerCallback; automationDebt >= 1.0; automationDebt -= 1.0) {
+                const auto& spec = BTZParams::table[pickParam(random)];
+                if (spec.index == BTZParams::bypass || spec.index == BTZParams::qualityMode
+                    || spec.index == BTZParams::qualityGovernor)
+                    continue;
+                if (auto* param = instances[(size_t) pickInstance(random)].processor->getAPVTS().getParameter(spec.id))
+                    param->setValueNotifyingHost((float) unit(random));
+                ++automationEvents;
+            }
+            if (unit(random) < switchChance) {
+                auto& apvts = instances[(size_t) pickInstance(random)].processor->getAPVTS();
+                if (auto* param = apvts.getParameter(BTZParams::spec(BTZParams::qualityMode).id))
+                    param->setValueNotifyingHost((float) std::uniform_int_distribution<int>(0, 2)(random) * 0.5f);
+                ++qualitySwitches;
+            }
+            if (unit(random) < loadChance) {
+                auto* processor = instances[(size_t) pickInstance(random)].processor.get();
+                const auto& state = states[(size_t) std::uniform_int_distribution<int>(0, (int) states.size() - 1)(random)];
+                juce::MessageManager::callAsync([processor, &state] { processor->setStateInformation(state.getData(), (int) state.getSize()); });
+                ++stateLoads;
+            }
+
+            // Every worker has left the previous cycle's claim loop, so the counters can be rewound.
+            while (parkedWorkers.load(std::memory_order_acquire) < opts.threads)
+                std::this_thread::yield();
+            parkedWorkers.store(0, std::memory_order_relaxed);
+            nextInstance.store(0, std::memory_order_relaxed);
+            finished.store(0, std::memory_order_relaxed);
+            generation.fetch_add(1, std::memory_order_release);
+            while (finished.load(std::memory_order_acquire) < opts.instances)
+                std::this_thread::yield();
+
+            const auto end = Clock::now();
+            callbackUs.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+            if (end > deadline) {
+                ++deadlineMisses;
+                // Like a host after an xrun: the next period starts now.
+                deadline = end;
+            }
+            deadline += period;
+        }
+
+        while (parkedWorkers.load(std::memory_order_acquire) < opts.threads)
+            std::this_thread::yield();
+        stopping.store(true);
+        generation.fetch_add(1, std::memory_order_release);
+        for (auto& t : workers)
+            t.join();
+        juce::MessageManager::callAsync([] { juce::MessageManager::getInstance()->stopDispatchLoop(); });
+    }
+
+    // Message thread, after run().
+    int report() const {
+        LatencyHistogram callbacks, blocks;
+        for (double us : callbackUs)
+            callbacks.add(us);
+        for (const auto& h : workerHistograms)
+            blocks.merge(h);
+
+        const double deadlineUs = opts.blockSize / opts.rate * 1.0e6;
+        char line[160];
+        std::snprintf(line, sizeof(line), "%d instances, %d threads, %d samples @ %.0f Hz (deadline %.1f us), %lld callbacks",
+                      opts.instances, opts.threads, opts.blockSize, opts.rate, deadlineUs, callbacks.getCount());
+        std::cout << line << std::endl;
+        std::snprintf(line, sizeof(line), "  callback      p50 %9.1f us  p99 %9.1f us  max %9.1f us",
+                      callbacks.percentile(0.5), callbacks.percentile(0.99), callbacks.getMax());
+        std::cout << line << std::endl;
+        std::snprintf(line, sizeof(line), "  processBlock  p50 %9.1f us  p99 %9.1f us  max %9.1f us",
+                      blocks.percentile(0.5), blocks.percentile(0.99), blocks.getMax());
+        std::cout << line << std::endl;
+        std::snprintf(line, sizeof(line), "  deadline misses %lld (%.3f %%)", deadlineMisses,
+                      100.0 * (double) deadlineMisses / (double) juce::jmax(1LL, callbacks.getCount()));
+        std::cout << line << std::endl;
+        std::cout << "  automation events " << automationEvents << ", quality switches " << qualitySwitches
+                  << ", state loads " << stateLoads << std::endl;
+        if (opts.governor) {
+            int governed = 0;
+            long long stepDowns = 0;
+            for (const auto& inst : instances) {
+                auto& meters = inst.processor->getMeters();
+                governed += meters.qualityGoverned.load() ? 1 : 0;
+                stepDowns += meters.governorStepDowns.load();
+            }
+            std::cout << "  governor: " << governed << " instances below selected quality at the end, "
+                      << stepDowns << " step downs" << std::endl;
+        }
+
+        long long misses = 0;
+        bool available = true;
+        for (auto m : workerCacheMisses) {
+            available = available && m >= 0;
+            misses += juce::jmax(0LL, m);
+        }
+        if (available) {
+            std::snprintf(line, sizeof(line), "  cache misses %lld (%.0f per callback)", misses,
+                          (double) misses / (double) juce::jmax(1LL, callbacks.getCount()));
+            std::cout << line << std::endl;
+        } else {
+            std::cout << "  cache misses n/a (no perf event access)" << std::endl;
+        }
+
+        return opts.maxMisses >= 0 && deadlineMisses > opts.maxMisses ? 3 : 0;
+    }
+
+private:
+    void workerLoop(int index, unsigned seen) {
+        CacheMissCounter cacheMisses;
+        auto& histogram = workerHistograms[(size_t) index];
+        juce::MidiBuffer midi;
+        juce::ScopedNoDenormals noDenormals;
+
+        for (;;) {
+            unsigned current;
+            while ((current = generation.load(std::memory_order_acquire)) == seen)
+                std::this_thread::yield();
+            seen = current;
+            if (stopping.load())
+                break;
+
+            for (;;) {
+                const int i = nextInstance.fetch_add(1, std::memory_order_relaxed);
+                if (i >= opts.instances)
+                    break;
+                auto& inst = instances[(size_t) i];
+                for (int ch = 0; ch < 2; ++ch)
+                    inst.buffer.copyFrom(ch, 0, inst.input, ch, 0, opts.blockSize);
+                const auto t0 = Clock::now();
+                inst.processor->processBlock(inst.buffer, midi);
+                histogram.add(std::chrono::duration<double, std::micro>(Clock::now() - t0).count());
+                finished.fetch_add(1, std::memory_order_release);
+            }
+            parkedWorkers.fetch_add(1, std::memory_order_release);
+        }
+        workerCacheMisses[(size_t) index] = cacheMisses.isAvailable() ? cacheMisses.read() : -1;
+    }
+
+    StressOptions opts;
+    std::mt19937 random;
+    std::vector<Instance> instances;
+    std::array<juce::MemoryBlock, 4> states;
+
+    std::atomic<unsigned> generation { 0 };
+    std::atomic<int> nextInstance { 0 }, finished { 0 }, parkedWorkers { 0 };
+    std::atomic<bool> stopping { false };
+
+    std::vector<double> callbackUs;
+    std::vector<LatencyHistogram> workerHistograms;
+    std::vector<long long> workerCacheMisses;
+    long long deadlineMisses = 0, automationEvents = 0, qualitySwitches = 0, stateLoads = 0;
+};
+
+static bool parseArgs(int argc, char* argv[], StressOptions& opts) {
+    for (int i = 1; i < argc; i += 2) {
+        if (i + 1 >= argc)
+            return false;
+        const juce::String arg(argv[i]), value(argv[i + 1]);
+        if (arg == "--instances")       opts.instances = juce::jmax(1, value.getIntValue());
+        else if (arg == "--threads")    opts.threads = juce::jmax(1, value.getIntValue());
+        else if (arg == "--block")      opts.blockSize = juce::jlimit(1, 8192, value.getIntValue());
+        else if (arg == "--rate")       opts.rate = juce::jmax(8000.0, value.getDoubleValue());
+        else if (arg == "--seconds")    opts.seconds = juce::jmax(0.1, value.getDoubleValue());
+        else if (arg == "--automation") opts.automationPerSecond = juce::jmax(0.0, value.getDoubleValue());
+        else if (arg == "--switches")   opts.switchesPerSecond = juce::jmax(0.0, value.getDoubleValue());
+        else if (arg == "--loads")      opts.loadsPerSecond = juce::jmax(0.0, value.getDoubleValue());
+        else if (arg == "--seed")       opts.seed = value.getIntValue();
+        else if (arg == "--max-misses") opts.maxMisses = value.getIntValue();
+        else if (arg == "--governor")   opts.governor = value.getIntValue() != 0;
+        else
+            return false;
+    }
+    return true;
+}
+}
+
+int main(int argc, char* argv[]) {
+    juce::ScopedJuceInitialiser_GUI juceInit;
+
+    StressOptions opts;
+    if (! parseArgs(argc, argv, opts)) {
+        std::cerr << "usage: btz_stress [--instances N] [--threads N] [--block N] [--rate Hz] [--seconds S]\n"
+                     "                  [--automation events/s] [--switches per s] [--loads per s]\n"
+                     "                  [--seed N] [--max-misses N] [--governor 0|1]" << std::endl;
+        return 2;
+    }
+
+    StressHost host(opts);
+    host.prepare();
+
+    // This thread stays the message thread: engine builds and state loads run here.
+    std::thread driver([&host] { host.run(); });
+    juce::MessageManager::getInstance()->runDispatchLoop();
+    driver.join();
+
+    return host.report();
+}